@@ -0,0 +1,59 @@
+/**
+ * Measures string interning and dictionary throughput.
+ *
+ * Build once normally and once with -DBLADE_USE_FNV_HASH=ON to
+ * compare the seeded wyhash against FNV-1a.
+ */
+
+def intern(n) {
+  # short strings built at runtime are interned on creation
+  var count = 0
+  for i in 0..n {
+    var key = 'key-${i % 5000}'
+    count += key.length()
+  }
+  return count
+}
+
+def dict_short(n) {
+  var dict = {}
+  for i in 0..n {
+    dict['k${i}'] = i
+  }
+  var total = 0
+  for i in 0..n {
+    total += dict['k${i}']
+  }
+  return total
+}
+
+def dict_long(n) {
+  # keys longer than the intern limit are hashed lazily
+  var prefix = 'a somewhat long dictionary key prefix used to defeat interning '
+  var keys = []
+  for i in 0..n {
+    keys.append(prefix + i)
+  }
+
+  var dict = {}
+  for key in keys {
+    dict[key] = true
+  }
+  var found = 0
+  for key in keys {
+    if dict.contains(key) found++
+  }
+  return found
+}
+
+var start = time()
+echo intern(1000000)
+echo 'Intern time taken = ${time() - start}'
+
+start = time()
+echo dict_short(200000)
+echo 'Short key dictionary time taken = ${time() - start}'
+
+start = time()
+echo dict_long(200000)
+echo 'Long key dictionary time taken = ${time() - start}'
@@ -0,0 +1,74 @@
+/**
+ * Measures the string search, split, replace, case mapping and
+ * validation methods on a large log-like input.
+ *
+ * Build once normally and once with -DBLADE_USE_SIMD=OFF to compare
+ * the SSE2/AVX2 kernels against the scalar ones.
+ */
+
+def make_log() {
+  var lines = []
+  for i in 0..1000 {
+    lines.append('2021-06-0${i % 9 + 1} 12:00:${i % 60} INFO worker-${i % 16} handled request ${i} in ${i % 997}ms')
+  }
+
+  # doubling keeps building the input cheap
+  var log = '\n'.join(lines)
+  for i in 0..7 {
+    log += '\n' + log
+  }
+  return log + '\n2021-06-09 12:00:00 ERROR worker-3 request failed'
+}
+
+var log = make_log()
+echo 'Input size = ${log.length()}'
+
+var start = time()
+var found = 0
+for i in 0..100 {
+  found += log.index_of('ERROR')
+}
+echo found
+echo 'index_of() time taken = ${time() - start}'
+
+start = time()
+var count = 0
+for i in 0..20 {
+  count += log.count('worker-1')
+}
+echo count
+echo 'count() time taken = ${time() - start}'
+
+start = time()
+var lines = 0
+for i in 0..10 {
+  lines += log.split('\n').length()
+}
+echo lines
+echo 'split() time taken = ${time() - start}'
+
+start = time()
+var length = 0
+for i in 0..20 {
+  length += log.replace('INFO', 'information').length()
+}
+echo length
+echo 'replace() time taken = ${time() - start}'
+
+start = time()
+length = 0
+for i in 0..50 {
+  length += log.upper().length() + log.lower().length()
+}
+echo length
+echo 'upper()/lower() time taken = ${time() - start}'
+
+var letters = log.replace('\n', '').replace(' ', '').replace(':', '').replace('-', '').replace('.', '')
+start = time()
+var valid = 0
+for i in 0..100 {
+  if letters.is_alnum() valid++
+  if !log.is_space() valid++
+}
+echo valid
+echo 'is_alnum()/is_space() time taken = ${time() - start}'
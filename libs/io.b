@@ -234,12 +234,17 @@ def getc() {
  * @returns string
  */
 def readline() {
-  var result = ''
-  var input
-
-  while (input = stdin.read()) and input != '\n' and input != '\0'
-    result += input
+  var line = _io.readline()
+  return line == nil ? '' : line
+}
 
-  return result
+/**
+ * readlines()
+ *
+ * reads every remaining line from standard input
+ * @returns list
+ */
+def readlines() {
+  return _io.readlines()
 }
 
@@ -0,0 +1,45 @@
+#
+# @module profiler
+#
+# provides heap snapshots for finding out what is keeping memory alive
+# @copyright 2021, Ore Richard Muyiwa
+#
+
+import _profiler
+
+/**
+ * snapshot(path: string)
+ *
+ * writes every live object on the heap to the file at path.
+ *
+ * each object is listed with its type, size in bytes and class name
+ * followed by the roots and the references between objects so that
+ * retained sizes can be computed offline.
+ * @return bool
+ */
+def snapshot(path) {
+  return _profiler.snapshot(path)
+}
+
+/**
+ * summary([top: number = 10])
+ *
+ * prints the top classes and object types on the heap by
+ * count and bytes
+ * @return nil
+ */
+def summary(top) {
+  if !top top = 10
+  return _profiler.summary(top)
+}
+
+/**
+ * watch(path: string)
+ *
+ * writes a heap snapshot to path at the next garbage collection
+ * every time the process receives the SIGUSR2 signal.
+ * @return bool
+ */
+def watch(path) {
+  return _profiler.watch(path)
+}
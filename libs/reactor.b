@@ -0,0 +1,311 @@
+/**
+ * Reactor
+ *
+ * provides an event loop for serving many non-blocking sockets from one
+ * process. it is built on epoll where available and on poll elsewhere.
+ * @copyright 2021, Ore Richard Muyiwa
+ */
+
+import _reactor
+import socket
+
+/**
+ * readiness events
+ */
+var READ = _reactor.READ # data can be read or a connection accepted
+var WRITE = _reactor.WRITE # data can be written without blocking
+var ERROR = _reactor.ERROR # the descriptor has an error pending
+var HANGUP = _reactor.HANGUP # the other side closed the connection
+
+/**
+ * the name of the backend in use i.e. epoll or poll
+ */
+var backend = _reactor.backend
+
+/**
+ * class ReactorException
+ */
+class ReactorException < Exception {
+  ReactorException(message) {
+    self.message = message
+  }
+}
+
+# is_instance() raises an exception for values that are not instances.
+def _is_socket(value) {
+  var result = false
+  try {
+    result = is_instance(value, socket.Socket)
+  } catch Exception e {
+  }
+  return result
+}
+
+# returns the descriptor of a socket or file or the number given.
+def _descriptor(target) {
+  if is_int(target) return target
+  if is_file(target) return target.number()
+  if _is_socket(target) return target.id
+  die ReactorException('socket, file or descriptor expected, ${typeof(target)} given')
+}
+
+/**
+ * class Reactor
+ *
+ * watches sockets for readiness and runs timers.
+ * callbacks registered with watch() are called with the socket and the
+ * events that occurred, timer callbacks are called without arguments.
+ */
+class Reactor {
+
+  /**
+   * Reactor()
+   * @constructor
+   */
+  Reactor() {
+    self._handle = _reactor.create()
+    if self._handle == -1
+      die ReactorException('could not create event queue')
+
+    self._events = {}
+    self._targets = {}
+    self._callbacks = {}
+    self._timers = Heap()
+    self._active_timers = {}
+    self._next_timer = 0
+    self._running = false
+  }
+
+  /**
+   * watch(target: Socket | file | number, events: number, callback: function)
+   *
+   * calls callback(target, events) whenever target is ready for any of
+   * events. watching a target again replaces its events and callback.
+   */
+  watch(target, events, callback) {
+    if !is_int(events) or events < 1
+      die ReactorException('READ and/or WRITE expected for events')
+    if !is_callable(callback)
+      die ReactorException('function expected for callback, ${typeof(callback)} given')
+
+    var fd = _descriptor(target)
+    var result
+    if self._events.contains(fd) {
+      result = _reactor.modify(self._handle, fd, events)
+    } else {
+      result = _reactor.add(self._handle, fd, events)
+    }
+    if result == -1 die ReactorException('could not watch descriptor ${fd}')
+
+    self._events[fd] = events
+    self._targets[fd] = target
+    self._callbacks[fd] = callback
+  }
+
+  /**
+   * unwatch(target: Socket | file | number)
+   *
+   * stops watching target. targets must be unwatched before they are closed.
+   */
+  unwatch(target) {
+    var fd = _descriptor(target)
+    if self._events.contains(fd) {
+      _reactor.remove(self._handle, fd)
+      self._events.remove(fd)
+      self._targets.remove(fd)
+      self._callbacks.remove(fd)
+    }
+  }
+
+  /**
+   * set_timeout(callback: function, delay: number)
+   *
+   * calls callback once after delay milliseconds
+   * @return the id of the timer for cancel()
+   */
+  set_timeout(callback, delay) {
+    return self._add_timer(callback, delay, -1)
+  }
+
+  /**
+   * set_interval(callback: function, interval: number)
+   *
+   * calls callback every interval milliseconds until it is cancelled
+   * @return the id of the timer for cancel()
+   */
+  set_interval(callback, interval) {
+    if interval <= 0 die ReactorException('interval must be greater than 0')
+    return self._add_timer(callback, interval, interval)
+  }
+
+  /**
+   * cancel(id: number)
+   *
+   * stops a timer from running again
+   */
+  cancel(id) {
+    self._active_timers.remove(id)
+  }
+
+  _add_timer(callback, delay, interval) {
+    if !is_callable(callback)
+      die ReactorException('function expected for callback, ${typeof(callback)} given')
+    if !is_number(delay) or delay < 0
+      die ReactorException('non-negative number expected for delay')
+
+    var id = self._next_timer
+    self._next_timer += 1
+    self._active_timers[id] = true
+
+    var deadline = _reactor.now() + delay
+    self._timers.push([deadline, id, callback, interval], deadline)
+    return id
+  }
+
+  # runs every timer that is due and returns how long to wait for the next
+  # one in milliseconds or -1 if there is none.
+  _run_timers() {
+    while self._timers.length() > 0 {
+      var timer = self._timers.peek()
+      if !self._active_timers.contains(timer[1]) {
+        self._timers.pop()
+        continue
+      }
+
+      var wait = timer[0] - _reactor.now()
+      # rounded up so that the timer is due when the wait ends.
+      if wait > 0 return to_int(wait) + 1
+
+      self._timers.pop()
+      if timer[3] > 0 {
+        timer[0] += timer[3]
+        self._timers.push(timer, timer[0])
+      } else {
+        self._active_timers.remove(timer[1])
+      }
+      timer[2]()
+    }
+    return -1
+  }
+
+  /**
+   * poll([timeout: number [, max_events: number]])
+   *
+   * waits at most timeout milliseconds (forever if not given) for watched
+   * targets to become ready without calling their callbacks.
+   * @return a flat list of every ready target followed by its events
+   * i.e. [target, events, target, events, ...]
+   */
+  poll(timeout, max_events) {
+    if timeout == nil timeout = -1
+    if !max_events max_events = 1024
+
+    var ready = _reactor.wait(self._handle, self._events, timeout, max_events)
+    if ready == -1 die ReactorException('could not wait for events')
+
+    var i = 0
+    var length = ready.length()
+    while i < length {
+      ready[i] = self._targets.get(ready[i])
+      i += 2
+    }
+    return ready
+  }
+
+  /**
+   * run_once([timeout: number])
+   *
+   * runs due timers, waits at most timeout milliseconds for ready targets
+   * (or until the next timer is due) and calls their callbacks.
+   */
+  run_once(timeout) {
+    var next_timer = self._run_timers()
+    if timeout == nil or (next_timer != -1 and (timeout < 0 or next_timer < timeout))
+      timeout = next_timer
+
+    var ready = _reactor.wait(self._handle, self._events, timeout)
+    if ready == -1 die ReactorException('could not wait for events')
+
+    var i = 0
+    var length = ready.length()
+    while i < length {
+      # a previous callback in this batch may have unwatched it.
+      var callback = self._callbacks.get(ready[i])
+      if callback callback(self._targets[ready[i]], ready[i + 1])
+      i += 2
+    }
+
+    self._run_timers()
+  }
+
+  /**
+   * run()
+   *
+   * runs the loop until stop() is called or nothing is watched and no
+   * timer is pending.
+   */
+  run() {
+    self._running = true
+    while self._running and (self._events.length() > 0 or self._active_timers.length() > 0) {
+      self.run_once()
+    }
+    self._running = false
+  }
+
+  /**
+   * stop()
+   *
+   * makes run() return after the callbacks of the current batch
+   */
+  stop() {
+    self._running = false
+  }
+
+  /**
+   * listen(server: Socket, callback: function)
+   *
+   * makes server non-blocking and calls callback(client) with every
+   * connection accepted on it. clients are non-blocking sockets.
+   */
+  listen(server, callback) {
+    if !_is_socket(server)
+      die ReactorException('Socket expected, ${typeof(server)} given')
+
+    _reactor.set_blocking(server.id, false)
+    self.watch(server, READ, |server, events| {
+      var client
+      while client = self.accept(server) {
+        callback(client)
+      }
+    })
+  }
+
+  /**
+   * accept(server: Socket)
+   *
+   * accepts a connection on the non-blocking server without waiting
+   * @return a non-blocking Socket or nil if no connection is waiting or
+   * accepting it failed
+   */
+  accept(server) {
+    var result = _reactor.accept(server.id)
+    if result == nil or result == -1 return nil
+
+    var client = socket.Socket(server.family, server.type, server.flags, result[0])
+    client.host = result[1]
+    client.port = result[2]
+    client.is_client = true
+    client.is_connected = true
+    return client
+  }
+
+  /**
+   * close()
+   *
+   * releases the event queue. the reactor cannot be used afterwards.
+   */
+  close() {
+    self.stop()
+    _reactor.close(self._handle)
+  }
+}
@@ -254,6 +254,36 @@ class Socket {
     return self._check_error(_socket.send(self.id, message, flags))
   }
 
+  /**
+   * send_file(file: file [, offset: number [, count: number]])
+   *
+   * sends count bytes of file starting at offset without reading the file
+   * into memory. when count is not given, the rest of the file is sent.
+   * @return the number of bytes sent, which is less than count if the file
+   * ends first or the socket is non-blocking and would block
+   */
+  send_file(file, offset, count) {
+    if !offset offset = 0
+    if count == nil count = -1
+
+    if !is_file(file)
+      die SocketException('file expected, ${typeof(file)} given')
+    if !is_int(offset) or offset < 0
+      die SocketException('non-negative integer expected for offset')
+    if !is_int(count)
+      die SocketException('integer expected for count, ${typeof(count)} given')
+
+    if self.id == -1 or self.is_closed or (self.is_shutdown and 
+      (self.shutdown_reason == SHUT_WR or 
+        self.shutdown_reason == SHUT_RDWR)) 
+      die SocketException('socket is in an illegal state')
+
+    if !self.is_listening and !self.is_connected
+      die SocketException('socket not listening or connected')
+
+    return self._check_error(_socket.sendfile(self.id, file, offset, count))
+  }
+
   receive(length, flags) {
     if !length length = -1
     if !flags flags = 0
@@ -277,6 +307,74 @@ class Socket {
     return self._check_error(result)
   }
 
+  # receives into buffer with a single recv() or, when exact is true,
+  # until length bytes have arrived.
+  _receive_into(buffer, offset, length, flags, exact) {
+    if !is_bytes(buffer)
+      die SocketException('bytes expected for buffer, ${typeof(buffer)} given')
+    if !offset offset = 0
+    if length == nil length = buffer.length() - offset
+    if !flags flags = 0
+
+    if !is_int(offset) 
+      die SocketException('integer expected for offset, ${typeof(offset)} given')
+    if !is_int(length) 
+      die SocketException('integer expected for length, ${typeof(length)} given')
+    if !is_int(flags) 
+      die SocketException('integer expected for flags, ${typeof(flags)} given')
+
+    if self.id == -1 or self.is_closed or (self.is_shutdown and 
+      (self.shutdown_reason == SHUT_RD or 
+        self.shutdown_reason == SHUT_RDWR)) 
+      die SocketException('socket is in an illegal state')
+
+    if !self.is_listening and !self.is_connected
+      die SocketException('socket not listening or connected')
+
+    return self._check_error(_socket.recv_into(self.id, buffer, offset, length, flags, exact))
+  }
+
+  /**
+   * receive_into(buffer: bytes [, offset: number [, length: number [, flags: number]]])
+   *
+   * receives at most length bytes into buffer starting at offset without
+   * allocating. length defaults to the rest of the buffer.
+   * @return the number of bytes received, 0 if the connection was closed
+   * or -1 if a non-blocking socket has nothing to read
+   */
+  receive_into(buffer, offset, length, flags) {
+    return self._receive_into(buffer, offset, length, flags, false)
+  }
+
+  /**
+   * receive_exactly(buffer: bytes [, offset: number [, length: number [, flags: number]]])
+   *
+   * like receive_into() but waits until all length bytes have arrived.
+   * @return length or fewer if the connection was closed first
+   */
+  receive_exactly(buffer, offset, length, flags) {
+    return self._receive_into(buffer, offset, length, flags, true)
+  }
+
+  /**
+   * receive_bytes(length: number [, flags: number])
+   *
+   * receives at most length bytes and returns them as bytes so that binary
+   * data arrives unchanged.
+   * @return bytes or nil if the connection was closed or nothing could
+   * be read
+   */
+  receive_bytes(length, flags) {
+    if !is_int(length) or length < 1
+      die SocketException('positive integer expected for length')
+
+    var buffer = bytes(length)
+    var count = self._receive_into(buffer, 0, length, flags, false)
+    if count <= 0 return nil
+    if count < length return buffer[0, count]
+    return buffer
+  }
+
   listen(queue_length) {
     if !queue_length queue_length = SOMAXCONN # default to 128 simulataneous clients...
 
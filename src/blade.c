@@ -189,12 +189,33 @@ static void run_file(b_vm *vm, const char *file) {
     exit(EXIT_RUNTIME);
 }
 
+// gives stdout a buffer of size bytes. output to a terminal is written out
+// at every new line unless full buffering is forced; pipes and files are
+// only written to when the buffer is full, flushed or the process exits.
+static void buffer_stdout(int size, bool force_full) {
+  if (size == 0) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+    return;
+  }
+
+  int mode = isatty(fileno(stdout)) && !force_full ? _IOLBF : _IOFBF;
+
+  // stdout keeps using the buffer until the process exits.
+  char *buffer = malloc(size);
+  if (buffer != NULL) {
+    setvbuf(stdout, buffer, mode, size);
+  }
+}
+
 void show_usage(char *argv[], bool fail) {
-  fprintf(stderr, "Usage: %s [-[h | d | j | v | g]] [filename]\n", argv[0]);
+  fprintf(stderr, "Usage: %s [-[h | d | j | v | g | o | b]] [filename]\n", argv[0]);
   fprintf(stderr, "   -h    Show this help message.\n");
   fprintf(stderr, "   -v    Show version string.\n");
   fprintf(stderr, "   -b    Buffer terminal outputs.\n");
-  fprintf(stderr, "         [This will cause the output to be buffered with 1kb]\n");
+  fprintf(stderr, "         [Terminals are otherwise written to at every new line]\n");
+  fprintf(stderr, "   -o    Sets the size of the output buffer in kilobytes. 0 turns\n"
+                  "         buffering off. [Default = %d or $BLADE_OUTPUT_BUFFER]\n",
+                  DEFAULT_STDOUT_BUFFER / 1024);
   fprintf(stderr, "   -d    Show generated bytecode.\n");
   fprintf(stderr, "   -j    Show stack objects during execution.\n");
   fprintf(stderr, "   -g    Sets the minimum heap size in kilobytes before the GC\n"
@@ -209,10 +230,19 @@ int main(int argc, char *argv[]) {
   bool should_print_bytecode = false;
   bool should_buffer_stdout = false;
   int next_gc_start = DEFAULT_GC_START;
+  int stdout_buffer = DEFAULT_STDOUT_BUFFER;
+
+  char *output_buffer = getenv("BLADE_OUTPUT_BUFFER");
+  if (output_buffer != NULL && *output_buffer != '\0') {
+    int size = (int)strtol(output_buffer, NULL, 10);
+    if (size >= 0) {
+      stdout_buffer = size * 1024; // expected value is in kilobytes
+    }
+  }
 
   if(argc > 1) {
     int opt;
-    while ((opt = getopt(argc, argv, "hdbjvg:")) != -1) {
+    while ((opt = getopt(argc, argv, "hdbjvg:o:")) != -1) {
       switch (opt) {
         case 'h': {
           show_usage(argv, false);
@@ -232,6 +262,13 @@ int main(int argc, char *argv[]) {
           }
           break;
         }
+        case 'o': {
+          int size = (int)strtol(optarg, NULL, 10);
+          if(size >= 0) {
+            stdout_buffer = size * 1024; // expected value is in kilobytes
+          }
+          break;
+        }
         default: {
           show_usage(argv, true);
           return EXIT_FAILURE;
@@ -250,13 +287,7 @@ int main(int argc, char *argv[]) {
     vm->should_print_bytecode = should_print_bytecode;
     vm->next_gc = next_gc_start;
 
-    if(should_buffer_stdout) {
-      // forcing printf buffering for TTYs and terminals
-      if (isatty(fileno(stdout))) {
-        char buffer[1024];
-        setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
-      }
-    }
+    buffer_stdout(stdout_buffer, should_buffer_stdout);
 
     if (argc == 1 || argc <= optind) {
       repl(vm);
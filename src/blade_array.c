@@ -0,0 +1,430 @@
+#include "blade_array.h"
+#include "blade_list.h"
+
+#include <string.h>
+
+// the element loops below are written over plain typed pointers so that
+// the compiler can vectorize them.
+#define ARRAY_DATA(array, type) ((type *) (array)->data)
+
+static bool create_array(b_vm *vm, int arg_count, b_value *args,
+                         b_array_type type, const char *name) {
+  if (arg_count != 1) {
+    RETURN_ERROR("%s() expects 1 arguments, %d given", name, arg_count);
+  }
+
+  if (IS_NUMBER(args[0])) {
+    int length = (int) AS_NUMBER(args[0]);
+    if (length < 0) {
+      RETURN_ERROR("%s() length cannot be negative", name);
+    }
+    RETURN_OBJ(new_array(vm, type, length));
+  } else if (IS_LIST(args[0])) {
+    b_obj_list *list = AS_LIST(args[0]);
+    for (int i = 0; i < list->items.count; i++) {
+      if (!IS_NUMBER(list->items.values[i])) {
+        RETURN_ERROR("%s() expects a list of numbers", name);
+      }
+    }
+
+    b_obj_array *array = new_array(vm, type, list->items.count);
+    for (int i = 0; i < list->items.count; i++) {
+      array_set(array, i, AS_NUMBER(list->items.values[i]));
+    }
+    RETURN_OBJ(array);
+  }
+
+  RETURN_ERROR("%s() expects a length or list of numbers as argument", name);
+}
+
+DECLARE_NATIVE(Float64Array) {
+  return create_array(vm, arg_count, args, ARRAY_FLOAT64, "Float64Array");
+}
+
+DECLARE_NATIVE(Int32Array) {
+  return create_array(vm, arg_count, args, ARRAY_INT32, "Int32Array");
+}
+
+DECLARE_NATIVE(UInt8Array) {
+  return create_array(vm, arg_count, args, ARRAY_UINT8, "UInt8Array");
+}
+
+DECLARE_ARRAY_METHOD(length) {
+  ENFORCE_ARG_COUNT(length, 0);
+  RETURN_NUMBER(AS_ARRAY(METHOD_OBJECT)->length);
+}
+
+static double sum_float64(const double *data, int length) {
+  // independent accumulators break the dependency chain between additions
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int i = 0;
+  for (; i + 4 <= length; i += 4) {
+    s0 += data[i];
+    s1 += data[i + 1];
+    s2 += data[i + 2];
+    s3 += data[i + 3];
+  }
+  for (; i < length; i++) {
+    s0 += data[i];
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+DECLARE_ARRAY_METHOD(sum) {
+  ENFORCE_ARG_COUNT(sum, 0);
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+
+  switch (array->type) {
+    case ARRAY_FLOAT64:
+      RETURN_NUMBER(sum_float64(ARRAY_DATA(array, double), array->length));
+    case ARRAY_INT32: {
+      const int32_t *data = ARRAY_DATA(array, int32_t);
+      int64_t sum = 0;
+      for (int i = 0; i < array->length; i++) {
+        sum += data[i];
+      }
+      RETURN_NUMBER((double) sum);
+    }
+    default: {
+      const uint8_t *data = ARRAY_DATA(array, uint8_t);
+      int64_t sum = 0;
+      for (int i = 0; i < array->length; i++) {
+        sum += data[i];
+      }
+      RETURN_NUMBER((double) sum);
+    }
+  }
+}
+
+#define ARRAY_EXTREME(array, type, op, result)                                 \
+  do {                                                                         \
+    const type *data = ARRAY_DATA(array, type);                                \
+    type extreme = data[0];                                                    \
+    for (int i = 1; i < (array)->length; i++) {                                \
+      extreme = data[i] op extreme ? data[i] : extreme;                        \
+    }                                                                          \
+    result = (double) extreme;                                                 \
+  } while (false)
+
+DECLARE_ARRAY_METHOD(min) {
+  ENFORCE_ARG_COUNT(min, 0);
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+  if (array->length == 0) RETURN;
+
+  double result;
+  switch (array->type) {
+    case ARRAY_FLOAT64: ARRAY_EXTREME(array, double, <, result); break;
+    case ARRAY_INT32: ARRAY_EXTREME(array, int32_t, <, result); break;
+    default: ARRAY_EXTREME(array, uint8_t, <, result); break;
+  }
+  RETURN_NUMBER(result);
+}
+
+DECLARE_ARRAY_METHOD(max) {
+  ENFORCE_ARG_COUNT(max, 0);
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+  if (array->length == 0) RETURN;
+
+  double result;
+  switch (array->type) {
+    case ARRAY_FLOAT64: ARRAY_EXTREME(array, double, >, result); break;
+    case ARRAY_INT32: ARRAY_EXTREME(array, int32_t, >, result); break;
+    default: ARRAY_EXTREME(array, uint8_t, >, result); break;
+  }
+  RETURN_NUMBER(result);
+}
+
+#undef ARRAY_EXTREME
+
+DECLARE_ARRAY_METHOD(dot) {
+  ENFORCE_ARG_COUNT(dot, 1);
+  ENFORCE_ARG_TYPE(dot, 0, IS_ARRAY);
+
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+  b_obj_array *other = AS_ARRAY(args[0]);
+  if (array->length != other->length) {
+    RETURN_ERROR("dot() expects arrays of equal length, %d and %d given",
+                 array->length, other->length);
+  }
+
+  if (array->type == ARRAY_FLOAT64 && other->type == ARRAY_FLOAT64) {
+    const double *a = ARRAY_DATA(array, double);
+    const double *b = ARRAY_DATA(other, double);
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+    for (; i + 4 <= array->length; i += 4) {
+      s0 += a[i] * b[i];
+      s1 += a[i + 1] * b[i + 1];
+      s2 += a[i + 2] * b[i + 2];
+      s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < array->length; i++) {
+      s0 += a[i] * b[i];
+    }
+    RETURN_NUMBER((s0 + s1) + (s2 + s3));
+  }
+
+  double sum = 0;
+  for (int i = 0; i < array->length; i++) {
+    sum += array_get(array, i) * array_get(other, i);
+  }
+  RETURN_NUMBER(sum);
+}
+
+DECLARE_ARRAY_METHOD(scale) {
+  ENFORCE_ARG_COUNT(scale, 1);
+  ENFORCE_ARG_TYPE(scale, 0, IS_NUMBER);
+
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+  double factor = AS_NUMBER(args[0]);
+
+  if (array->type == ARRAY_FLOAT64) {
+    double *data = ARRAY_DATA(array, double);
+    for (int i = 0; i < array->length; i++) {
+      data[i] *= factor;
+    }
+  } else {
+    for (int i = 0; i < array->length; i++) {
+      array_set(array, i, array_get(array, i) * factor);
+    }
+  }
+  RETURN_OBJ(array);
+}
+
+DECLARE_ARRAY_METHOD(add) {
+  ENFORCE_ARG_COUNT(add, 1);
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+
+  if (IS_NUMBER(args[0])) {
+    double value = AS_NUMBER(args[0]);
+    if (array->type == ARRAY_FLOAT64) {
+      double *data = ARRAY_DATA(array, double);
+      for (int i = 0; i < array->length; i++) {
+        data[i] += value;
+      }
+    } else {
+      for (int i = 0; i < array->length; i++) {
+        array_set(array, i, array_get(array, i) + value);
+      }
+    }
+    RETURN_OBJ(array);
+  }
+
+  if (!IS_ARRAY(args[0])) {
+    RETURN_ERROR("add() expects argument 1 as number or array, %s given",
+                 value_type(args[0]));
+  }
+
+  b_obj_array *other = AS_ARRAY(args[0]);
+  if (array->length != other->length) {
+    RETURN_ERROR("add() expects arrays of equal length, %d and %d given",
+                 array->length, other->length);
+  }
+
+  if (array->type == ARRAY_FLOAT64 && other->type == ARRAY_FLOAT64) {
+    double *a = ARRAY_DATA(array, double);
+    const double *b = ARRAY_DATA(other, double);
+    for (int i = 0; i < array->length; i++) {
+      a[i] += b[i];
+    }
+  } else {
+    for (int i = 0; i < array->length; i++) {
+      array_set(array, i, array_get(array, i) + array_get(other, i));
+    }
+  }
+  RETURN_OBJ(array);
+}
+
+typedef enum {
+  MAP_ADD,
+  MAP_SUBTRACT,
+  MAP_MULTIPLY,
+  MAP_DIVIDE,
+  MAP_POW,
+  MAP_MIN,
+  MAP_MAX,
+  MAP_ABS,
+  MAP_NEGATE,
+  MAP_SQRT,
+  MAP_SQUARE,
+  MAP_FLOOR,
+  MAP_CEIL,
+  MAP_ROUND,
+  MAP_EXP,
+  MAP_LOG,
+  MAP_UNKNOWN,
+} b_map_op;
+
+static b_map_op find_map_op(const char *name) {
+  static const char *names[] = {
+      "+", "-", "*", "/", "pow", "min", "max", "abs", "neg",
+      "sqrt", "square", "floor", "ceil", "round", "exp", "log",
+  };
+  for (int i = 0; i < MAP_UNKNOWN; i++) {
+    if (strcmp(name, names[i]) == 0) return (b_map_op) i;
+  }
+  return MAP_UNKNOWN;
+}
+
+static void map_float64(b_map_op op, const double *in, double *out, int length,
+                        double operand) {
+  switch (op) {
+    case MAP_ADD: for (int i = 0; i < length; i++) out[i] = in[i] + operand; break;
+    case MAP_SUBTRACT: for (int i = 0; i < length; i++) out[i] = in[i] - operand; break;
+    case MAP_MULTIPLY: for (int i = 0; i < length; i++) out[i] = in[i] * operand; break;
+    case MAP_DIVIDE: for (int i = 0; i < length; i++) out[i] = in[i] / operand; break;
+    case MAP_POW: for (int i = 0; i < length; i++) out[i] = pow(in[i], operand); break;
+    case MAP_MIN: for (int i = 0; i < length; i++) out[i] = in[i] < operand ? in[i] : operand; break;
+    case MAP_MAX: for (int i = 0; i < length; i++) out[i] = in[i] > operand ? in[i] : operand; break;
+    case MAP_ABS: for (int i = 0; i < length; i++) out[i] = fabs(in[i]); break;
+    case MAP_NEGATE: for (int i = 0; i < length; i++) out[i] = -in[i]; break;
+    case MAP_SQRT: for (int i = 0; i < length; i++) out[i] = sqrt(in[i]); break;
+    case MAP_SQUARE: for (int i = 0; i < length; i++) out[i] = in[i] * in[i]; break;
+    case MAP_FLOOR: for (int i = 0; i < length; i++) out[i] = floor(in[i]); break;
+    case MAP_CEIL: for (int i = 0; i < length; i++) out[i] = ceil(in[i]); break;
+    case MAP_ROUND: for (int i = 0; i < length; i++) out[i] = round(in[i]); break;
+    case MAP_EXP: for (int i = 0; i < length; i++) out[i] = exp(in[i]); break;
+    case MAP_LOG: for (int i = 0; i < length; i++) out[i] = log(in[i]); break;
+    default: break;
+  }
+}
+
+static double map_value(b_map_op op, double value, double operand) {
+  double result;
+  map_float64(op, &value, &result, 1, operand);
+  return result;
+}
+
+DECLARE_ARRAY_METHOD(map) {
+  ENFORCE_ARG_RANGE(map, 1, 2);
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+
+  if (IS_STRING(args[0])) {
+    b_map_op op = find_map_op(AS_C_STRING(args[0]));
+    if (op == MAP_UNKNOWN) {
+      RETURN_ERROR("map() unknown operation '%s'", AS_C_STRING(args[0]));
+    }
+
+    double operand = 0;
+    if (op <= MAP_MAX) {
+      if (arg_count != 2 || !IS_NUMBER(args[1])) {
+        RETURN_ERROR("map() operation '%s' expects a number operand",
+                     AS_C_STRING(args[0]));
+      }
+      operand = AS_NUMBER(args[1]);
+    }
+
+    b_obj_array *result = new_array(vm, array->type, array->length);
+    if (array->type == ARRAY_FLOAT64) {
+      map_float64(op, ARRAY_DATA(array, double), ARRAY_DATA(result, double),
+                  array->length, operand);
+    } else {
+      for (int i = 0; i < array->length; i++) {
+        array_set(result, i, map_value(op, array_get(array, i), operand));
+      }
+    }
+    RETURN_OBJ(result);
+  }
+
+  if (!IS_CLOSURE(args[0]) && !IS_FUNCTION(args[0]) && !IS_BOUND(args[0]) &&
+      !IS_NATIVE(args[0])) {
+    RETURN_ERROR("map() expects argument 1 as string or function, %s given",
+                 value_type(args[0]));
+  }
+
+  b_value function = args[0];
+  b_obj_array *result = (b_obj_array *) GC(new_array(vm, array->type,
+                                                     array->length));
+  for (int i = 0; i < array->length; i++) {
+    b_value value = NUMBER_VAL(array_get(array, i)), mapped;
+    if (!call_blade_value(vm, function, 1, &value, &mapped)) {
+      args[-1] = FALSE_VAL;
+      return false;
+    }
+    if (!IS_NUMBER(mapped)) {
+      RETURN_ERROR("map() function must return a number, %s returned",
+                   value_type(mapped));
+    }
+    array_set(result, i, AS_NUMBER(mapped));
+  }
+  RETURN_OBJ(result);
+}
+
+DECLARE_ARRAY_METHOD(fill) {
+  ENFORCE_ARG_COUNT(fill, 1);
+  ENFORCE_ARG_TYPE(fill, 0, IS_NUMBER);
+
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+  double value = AS_NUMBER(args[0]);
+  if (array->type == ARRAY_FLOAT64) {
+    double *data = ARRAY_DATA(array, double);
+    for (int i = 0; i < array->length; i++) {
+      data[i] = value;
+    }
+  } else if (array->length > 0) {
+    array_set(array, 0, value);
+    size_t size = ARRAY_ELEMENT_SIZE(array->type);
+    for (int i = 1; i < array->length; i++) {
+      memcpy((char *) array->data + i * size, array->data, size);
+    }
+  }
+  RETURN_OBJ(array);
+}
+
+DECLARE_ARRAY_METHOD(clone) {
+  ENFORCE_ARG_COUNT(clone, 0);
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+  b_obj_array *copy = new_array(vm, array->type, array->length);
+  memcpy(copy->data, array->data,
+         ARRAY_ELEMENT_SIZE(array->type) * (size_t) array->length);
+  RETURN_OBJ(copy);
+}
+
+DECLARE_ARRAY_METHOD(to_list) {
+  ENFORCE_ARG_COUNT(to_list, 0);
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+
+  b_obj_list *list = (b_obj_list *) GC(new_list(vm));
+  for (int i = 0; i < array->length; i++) {
+    write_list(vm, list, NUMBER_VAL(array_get(array, i)));
+  }
+  RETURN_OBJ(list);
+}
+
+DECLARE_ARRAY_METHOD(__iter__) {
+  ENFORCE_ARG_COUNT(__iter__, 1);
+  ENFORCE_ARG_TYPE(__iter__, 0, IS_NUMBER);
+
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+  int index = AS_NUMBER(args[0]);
+
+  if (index > -1 && index < array->length) {
+    RETURN_NUMBER(array_get(array, index));
+  }
+
+  RETURN;
+}
+
+DECLARE_ARRAY_METHOD(__itern__) {
+  ENFORCE_ARG_COUNT(__itern__, 1);
+  b_obj_array *array = AS_ARRAY(METHOD_OBJECT);
+
+  if (IS_NIL(args[0])) {
+    if (array->length == 0)
+      RETURN_FALSE;
+    RETURN_NUMBER(0);
+  }
+
+  if (!IS_NUMBER(args[0])) {
+    RETURN_ERROR("arrays are numerically indexed");
+  }
+
+  int index = AS_NUMBER(args[0]);
+  if (index < array->length - 1) {
+    RETURN_NUMBER((double) index + 1);
+  }
+
+  RETURN;
+}
+
+#undef ARRAY_DATA
@@ -0,0 +1,166 @@
+#ifndef BLADE_ARRAY_H
+#define BLADE_ARRAY_H
+
+#include "common.h"
+#include "native.h"
+#include "vm.h"
+
+#include <math.h>
+
+#define DECLARE_ARRAY_METHOD(name) DECLARE_METHOD(array##name)
+
+static inline double array_get(b_obj_array *array, int index) {
+  switch (array->type) {
+    case ARRAY_FLOAT64: return ((double *) array->data)[index];
+    case ARRAY_INT32: return ((int32_t *) array->data)[index];
+    default: return ((uint8_t *) array->data)[index];
+  }
+}
+
+/**
+ * truncates value towards zero and wraps it around modulo 2^32. nan and
+ * infinities become 0. fmod() is exact so this is defined for any magnitude.
+ */
+static inline uint32_t array_wrap(double value) {
+  if (!isfinite(value)) {
+    return 0;
+  }
+  return (uint32_t) (int64_t) fmod(trunc(value), 4294967296.0);
+}
+
+/**
+ * stores value at index converting it to the element type of the array.
+ * integer arrays truncate towards zero and wrap around modulo 2^32 or 2^8,
+ * so e.g. 2^32 + 5 is stored as 5 and -1 as 255 in a UInt8Array.
+ */
+static inline void array_set(b_obj_array *array, int index, double value) {
+  switch (array->type) {
+    case ARRAY_FLOAT64:
+      ((double *) array->data)[index] = value;
+      break;
+    case ARRAY_INT32:
+      ((int32_t *) array->data)[index] = (int32_t) array_wrap(value);
+      break;
+    default:
+      ((uint8_t *) array->data)[index] = (uint8_t) array_wrap(value);
+      break;
+  }
+}
+
+/**
+ * Float64Array(value: number|list)
+ *
+ * creates a new array of 64-bit floating point numbers
+ * - if a number is given, creates a zeroed array of that length
+ * - if a list is given, copies the numbers in the list into the array
+ */
+DECLARE_NATIVE(Float64Array);
+
+/**
+ * Int32Array(value: number|list)
+ *
+ * creates a new array of 32-bit signed integers
+ * - if a number is given, creates a zeroed array of that length
+ * - if a list is given, copies the numbers in the list into the array
+ */
+DECLARE_NATIVE(Int32Array);
+
+/**
+ * UInt8Array(value: number|list)
+ *
+ * creates a new array of 8-bit unsigned integers
+ * - if a number is given, creates a zeroed array of that length
+ * - if a list is given, copies the numbers in the list into the array
+ */
+DECLARE_NATIVE(UInt8Array);
+
+/**
+ * array.length()
+ *
+ * returns the number of elements in the array
+ */
+DECLARE_ARRAY_METHOD(length);
+
+/**
+ * array.sum()
+ *
+ * returns the sum of all the elements in the array
+ */
+DECLARE_ARRAY_METHOD(sum);
+
+/**
+ * array.min()
+ *
+ * returns the smallest element in the array or nil if it is empty
+ */
+DECLARE_ARRAY_METHOD(min);
+
+/**
+ * array.max()
+ *
+ * returns the largest element in the array or nil if it is empty
+ */
+DECLARE_ARRAY_METHOD(max);
+
+/**
+ * array.dot(other: array)
+ *
+ * returns the dot product of the array and another array of the same length
+ */
+DECLARE_ARRAY_METHOD(dot);
+
+/**
+ * array.scale(factor: number)
+ *
+ * multiplies every element of the array by factor in place
+ * @return array
+ */
+DECLARE_ARRAY_METHOD(scale);
+
+/**
+ * array.add(value: number|array)
+ *
+ * adds a number to every element of the array or adds another array of
+ * the same length element by element in place
+ * @return array
+ */
+DECLARE_ARRAY_METHOD(add);
+
+/**
+ * array.map(op: string|function [, operand: number])
+ *
+ * returns a new array of the same type with op applied to every element.
+ * op is either a function called with each element or one of the numeric
+ * operations
+ *   '+', '-', '*', '/', 'pow', 'min', 'max' (which take an operand),
+ *   'abs', 'neg', 'sqrt', 'square', 'floor', 'ceil', 'round', 'exp', 'log'
+ */
+DECLARE_ARRAY_METHOD(map);
+
+/**
+ * array.fill(value: number)
+ *
+ * sets every element of the array to value
+ * @return array
+ */
+DECLARE_ARRAY_METHOD(fill);
+
+/**
+ * array.clone()
+ *
+ * returns a copy of the array
+ */
+DECLARE_ARRAY_METHOD(clone);
+
+/**
+ * array.to_list()
+ *
+ * returns the elements of the array as a list of numbers
+ */
+DECLARE_ARRAY_METHOD(to_list);
+
+DECLARE_ARRAY_METHOD(__iter__);
+
+DECLARE_ARRAY_METHOD(__itern__);
+
+#endif
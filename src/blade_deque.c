@@ -0,0 +1,201 @@
+#include "blade_deque.h"
+#include "blade_list.h"
+#include "memory.h"
+
+#include <string.h>
+
+// moves the items to a buffer twice as large, unwrapped from position 0.
+static void grow_deque(b_vm *vm, b_obj_deque *deque) {
+  int capacity = GROW_CAPACITY(deque->capacity);
+  b_value *values = ALLOCATE(b_value, capacity);
+
+  int head_count = deque->capacity - deque->head;
+  if (head_count > deque->count) head_count = deque->count;
+  if (deque->count > 0) {
+    memcpy(values, deque->values + deque->head, head_count * sizeof(b_value));
+    memcpy(values + head_count, deque->values,
+           (deque->count - head_count) * sizeof(b_value));
+  }
+
+  FREE_ARRAY(b_value, deque->values, deque->capacity);
+  deque->values = values;
+  deque->capacity = capacity;
+  deque->head = 0;
+}
+
+void deque_push(b_vm *vm, b_obj_deque *deque, b_value value) {
+  if (deque->count == deque->capacity) {
+    grow_deque(vm, deque);
+  }
+  DEQUE_AT(deque, deque->count) = value;
+  deque->count++;
+}
+
+static void deque_push_front(b_vm *vm, b_obj_deque *deque, b_value value) {
+  if (deque->count == deque->capacity) {
+    grow_deque(vm, deque);
+  }
+  deque->head = (deque->head - 1) & (deque->capacity - 1);
+  deque->values[deque->head] = value;
+  deque->count++;
+}
+
+// adds the items of a list or deque to the end of the deque.
+// returns false if items is neither.
+static bool push_items(b_vm *vm, b_obj_deque *deque, b_value items) {
+  if (IS_LIST(items)) {
+    b_value_arr *values = &AS_LIST(items)->items;
+    for (int i = 0; i < values->count; i++) {
+      deque_push(vm, deque, values->values[i]);
+    }
+  } else if (IS_DEQUE(items)) {
+    b_obj_deque *other = AS_DEQUE(items);
+    // other may be deque itself, so only copy the items it has now.
+    int count = other->count;
+    for (int i = 0; i < count; i++) {
+      deque_push(vm, deque, DEQUE_AT(other, i));
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+DECLARE_NATIVE(Deque) {
+  ENFORCE_ARG_RANGE(Deque, 0, 1);
+  b_obj_deque *deque = (b_obj_deque *) GC(new_deque(vm));
+
+  if (arg_count == 1 && !push_items(vm, deque, args[0])) {
+    RETURN_ERROR("Deque() expects a list or deque, %s given",
+                 value_type(args[0]));
+  }
+  RETURN_OBJ(deque);
+}
+
+DECLARE_DEQUE_METHOD(length) {
+  ENFORCE_ARG_COUNT(length, 0);
+  RETURN_NUMBER(AS_DEQUE(METHOD_OBJECT)->count);
+}
+
+DECLARE_DEQUE_METHOD(push) {
+  ENFORCE_ARG_COUNT(push, 1);
+  deque_push(vm, AS_DEQUE(METHOD_OBJECT), args[0]);
+  RETURN;
+}
+
+DECLARE_DEQUE_METHOD(push_front) {
+  ENFORCE_ARG_COUNT(push_front, 1);
+  deque_push_front(vm, AS_DEQUE(METHOD_OBJECT), args[0]);
+  RETURN;
+}
+
+DECLARE_DEQUE_METHOD(pop) {
+  ENFORCE_ARG_COUNT(pop, 0);
+  b_obj_deque *deque = AS_DEQUE(METHOD_OBJECT);
+  if (deque->count > 0) {
+    deque->count--;
+    RETURN_VALUE(DEQUE_AT(deque, deque->count));
+  }
+  RETURN;
+}
+
+DECLARE_DEQUE_METHOD(pop_front) {
+  ENFORCE_ARG_COUNT(pop_front, 0);
+  b_obj_deque *deque = AS_DEQUE(METHOD_OBJECT);
+  if (deque->count > 0) {
+    b_value value = deque->values[deque->head];
+    deque->head = (deque->head + 1) & (deque->capacity - 1);
+    deque->count--;
+    RETURN_VALUE(value);
+  }
+  RETURN;
+}
+
+DECLARE_DEQUE_METHOD(first) {
+  ENFORCE_ARG_COUNT(first, 0);
+  b_obj_deque *deque = AS_DEQUE(METHOD_OBJECT);
+  if (deque->count > 0) {
+    RETURN_VALUE(DEQUE_AT(deque, 0));
+  }
+  RETURN;
+}
+
+DECLARE_DEQUE_METHOD(last) {
+  ENFORCE_ARG_COUNT(last, 0);
+  b_obj_deque *deque = AS_DEQUE(METHOD_OBJECT);
+  if (deque->count > 0) {
+    RETURN_VALUE(DEQUE_AT(deque, deque->count - 1));
+  }
+  RETURN;
+}
+
+DECLARE_DEQUE_METHOD(extend) {
+  ENFORCE_ARG_COUNT(extend, 1);
+  if (!push_items(vm, AS_DEQUE(METHOD_OBJECT), args[0])) {
+    RETURN_ERROR("extend() expects a list or deque, %s given",
+                 value_type(args[0]));
+  }
+  RETURN;
+}
+
+DECLARE_DEQUE_METHOD(clear) {
+  ENFORCE_ARG_COUNT(clear, 0);
+  b_obj_deque *deque = AS_DEQUE(METHOD_OBJECT);
+  deque->head = 0;
+  deque->count = 0;
+  RETURN;
+}
+
+DECLARE_DEQUE_METHOD(clone) {
+  ENFORCE_ARG_COUNT(clone, 0);
+  b_obj_deque *copy = (b_obj_deque *) GC(new_deque(vm));
+  push_items(vm, copy, METHOD_OBJECT);
+  RETURN_OBJ(copy);
+}
+
+DECLARE_DEQUE_METHOD(to_list) {
+  ENFORCE_ARG_COUNT(to_list, 0);
+  b_obj_deque *deque = AS_DEQUE(METHOD_OBJECT);
+
+  b_obj_list *list = (b_obj_list *) GC(new_list(vm));
+  for (int i = 0; i < deque->count; i++) {
+    write_list(vm, list, DEQUE_AT(deque, i));
+  }
+  RETURN_OBJ(list);
+}
+
+DECLARE_DEQUE_METHOD(__iter__) {
+  ENFORCE_ARG_COUNT(__iter__, 1);
+  ENFORCE_ARG_TYPE(__iter__, 0, IS_NUMBER);
+
+  b_obj_deque *deque = AS_DEQUE(METHOD_OBJECT);
+  int index = AS_NUMBER(args[0]);
+
+  if (index > -1 && index < deque->count) {
+    RETURN_VALUE(DEQUE_AT(deque, index));
+  }
+
+  RETURN;
+}
+
+DECLARE_DEQUE_METHOD(__itern__) {
+  ENFORCE_ARG_COUNT(__itern__, 1);
+  b_obj_deque *deque = AS_DEQUE(METHOD_OBJECT);
+
+  if (IS_NIL(args[0])) {
+    if (deque->count == 0)
+      RETURN_FALSE;
+    RETURN_NUMBER(0);
+  }
+
+  if (!IS_NUMBER(args[0])) {
+    RETURN_ERROR("deques are numerically indexed");
+  }
+
+  int index = AS_NUMBER(args[0]);
+  if (index < deque->count - 1) {
+    RETURN_NUMBER((double) index + 1);
+  }
+
+  RETURN;
+}
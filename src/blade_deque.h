@@ -0,0 +1,107 @@
+#ifndef BLADE_DEQUE_H
+#define BLADE_DEQUE_H
+
+#include "common.h"
+#include "native.h"
+#include "vm.h"
+
+#define DECLARE_DEQUE_METHOD(name) DECLARE_METHOD(deque##name)
+
+/**
+ * adds value to the end of the deque
+ */
+void deque_push(b_vm *vm, b_obj_deque *deque, b_value value);
+
+/**
+ * Deque([items: list|deque])
+ *
+ * creates a new double-ended queue
+ * - if items is given, the deque starts with the items in it
+ *
+ * items can be added and removed at both ends in constant time and read
+ * or changed by index e.g. deque[0], deque[-1] = value
+ */
+DECLARE_NATIVE(Deque);
+
+/**
+ * deque.length()
+ *
+ * returns the number of items in the deque
+ */
+DECLARE_DEQUE_METHOD(length);
+
+/**
+ * deque.push(value: any)
+ *
+ * adds value to the end of the deque
+ */
+DECLARE_DEQUE_METHOD(push);
+
+/**
+ * deque.push_front(value: any)
+ *
+ * adds value to the beginning of the deque
+ */
+DECLARE_DEQUE_METHOD(push_front);
+
+/**
+ * deque.pop()
+ *
+ * removes and returns the last item in the deque or nil if it is empty
+ */
+DECLARE_DEQUE_METHOD(pop);
+
+/**
+ * deque.pop_front()
+ *
+ * removes and returns the first item in the deque or nil if it is empty
+ */
+DECLARE_DEQUE_METHOD(pop_front);
+
+/**
+ * deque.first()
+ *
+ * returns the first item in the deque or nil if it is empty
+ */
+DECLARE_DEQUE_METHOD(first);
+
+/**
+ * deque.last()
+ *
+ * returns the last item in the deque or nil if it is empty
+ */
+DECLARE_DEQUE_METHOD(last);
+
+/**
+ * deque.extend(items: list|deque)
+ *
+ * adds the items to the end of the deque
+ */
+DECLARE_DEQUE_METHOD(extend);
+
+/**
+ * deque.clear()
+ *
+ * removes every item from the deque
+ */
+DECLARE_DEQUE_METHOD(clear);
+
+/**
+ * deque.clone()
+ *
+ * returns a shallow copy of the deque
+ */
+DECLARE_DEQUE_METHOD(clone);
+
+/**
+ * deque.to_list()
+ *
+ * returns the items in the deque as a list
+ */
+DECLARE_DEQUE_METHOD(to_list);
+
+DECLARE_DEQUE_METHOD(__iter__);
+
+DECLARE_DEQUE_METHOD(__itern__);
+
+#endif
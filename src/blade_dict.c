@@ -9,7 +9,7 @@
 
 DECLARE_DICT_METHOD(length) {
   ENFORCE_ARG_COUNT(dictionary.length, 0);
-  RETURN_NUMBER(AS_DICT(METHOD_OBJECT)->names.count);
+  RETURN_NUMBER(DICT_LENGTH(AS_DICT(METHOD_OBJECT)));
 }
 
 DECLARE_DICT_METHOD(add) {
@@ -19,7 +19,7 @@ DECLARE_DICT_METHOD(add) {
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
 
   b_value temp_value;
-  if (table_get(&dict->items, args[0], &temp_value)) {
+  if (dict_get_entry(dict, args[0], &temp_value)) {
     RETURN_ERROR("duplicate key %s at add()", value_to_string(vm, args[0]));
   }
 
@@ -41,7 +41,8 @@ DECLARE_DICT_METHOD(clear) {
 
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
   free_value_arr(vm, &dict->names);
-  free_table(vm, &dict->items);
+  free_value_arr(vm, &dict->values);
+  free_table(vm, &dict->indices);
   RETURN;
 }
 
@@ -50,10 +51,10 @@ DECLARE_DICT_METHOD(clone) {
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
   b_obj_dict *n_dict = (b_obj_dict*)GC(new_dict(vm));
 
-  table_add_all(vm, &dict->items, &n_dict->items);
-
   for (int i = 0; i < dict->names.count; i++) {
-    write_value_arr(vm, &n_dict->names, dict->names.values[i]);
+    if (!IS_EMPTY(dict->names.values[i])) {
+      dict_add_entry(vm, n_dict, dict->names.values[i], dict->values.values[i]);
+    }
   }
 
   RETURN_OBJ(n_dict);
@@ -65,10 +66,8 @@ DECLARE_DICT_METHOD(compact) {
   b_obj_dict *n_dict = (b_obj_dict *)GC(new_dict(vm));
 
   for (int i = 0; i < dict->names.count; i++) {
-    b_value tmp_value;
-    table_get(&dict->items, dict->names.values[i], &tmp_value);
-    if (!values_equal(tmp_value, NIL_VAL)) {
-      dict_add_entry(vm, n_dict, dict->names.values[i], tmp_value);
+    if (!IS_EMPTY(dict->names.values[i]) && !IS_NIL(dict->values.values[i])) {
+      dict_add_entry(vm, n_dict, dict->names.values[i], dict->values.values[i]);
     }
   }
 
@@ -81,7 +80,7 @@ DECLARE_DICT_METHOD(contains) {
 
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
   b_value value;
-  RETURN_BOOL(table_get(&dict->items, args[0], &value));
+  RETURN_BOOL(dict_get_entry(dict, args[0], &value));
 }
 
 DECLARE_DICT_METHOD(extend) {
@@ -92,9 +91,11 @@ DECLARE_DICT_METHOD(extend) {
   b_obj_dict *dict_cpy = AS_DICT(args[0]);
 
   for (int i = 0; i < dict_cpy->names.count; i++) {
-    write_value_arr(vm, &dict->names, dict_cpy->names.values[i]);
+    if (!IS_EMPTY(dict_cpy->names.values[i])) {
+      dict_set_entry(vm, dict, dict_cpy->names.values[i],
+                     dict_cpy->values.values[i]);
+    }
   }
-  table_add_all(vm, &dict_cpy->items, &dict->items);
   RETURN;
 }
 
@@ -120,7 +121,9 @@ DECLARE_DICT_METHOD(keys) {
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
   b_obj_list *list = (b_obj_list *)GC(new_list(vm));
   for (int i = 0; i < dict->names.count; i++) {
-    write_list(vm, list, dict->names.values[i]);
+    if (!IS_EMPTY(dict->names.values[i])) {
+      write_list(vm, list, dict->names.values[i]);
+    }
   }
   RETURN_OBJ(list);
 }
@@ -130,9 +133,9 @@ DECLARE_DICT_METHOD(values) {
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
   b_obj_list *list = (b_obj_list *)GC(new_list(vm));
   for (int i = 0; i < dict->names.count; i++) {
-    b_value tmp_value;
-    dict_get_entry(dict, dict->names.values[i], &tmp_value);
-    write_list(vm, list, tmp_value);
+    if (!IS_EMPTY(dict->names.values[i])) {
+      write_list(vm, list, dict->values.values[i]);
+    }
   }
   RETURN_OBJ(list);
 }
@@ -143,20 +146,7 @@ DECLARE_DICT_METHOD(remove) {
 
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
   b_value value;
-  if (table_get(&dict->items, args[0], &value)) {
-    table_delete(&dict->items, args[0]);
-    int index = -1;
-    for (int i = 0; i < dict->names.count; i++) {
-      if (values_equal(dict->names.values[i], args[0])) {
-        index = i;
-        break;
-      }
-    }
-
-    for (int i = index; i < dict->names.count; i++) {
-      dict->names.values[i] = dict->names.values[i + 1];
-    }
-    dict->names.count--;
+  if (dict_remove_entry(vm, dict, args[0], &value)) {
     RETURN_VALUE(value);
   }
   RETURN;
@@ -167,23 +157,25 @@ DECLARE_DICT_METHOD(assign) {
   ENFORCE_VALID_DICT_KEY(assign, 0);
 
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
-  b_value value;
-  if (!table_get(&dict->items, args[0], &value)) {
-    dict_add_entry(vm, dict, args[0], args[1]);
-  } else {
-    dict_set_entry(vm, dict, args[0], args[1]);
-  }
+  dict_set_entry(vm, dict, args[0], args[1]);
   RETURN;
 }
 
 DECLARE_DICT_METHOD(is_empty) {
   ENFORCE_ARG_COUNT(is_empty, 0);
-  RETURN_BOOL(AS_DICT(METHOD_OBJECT)->names.count == 0);
+  RETURN_BOOL(DICT_LENGTH(AS_DICT(METHOD_OBJECT)) == 0);
 }
 
 DECLARE_DICT_METHOD(find_key) {
   ENFORCE_ARG_COUNT(find_key, 1);
-  RETURN_VALUE(table_find_key(&AS_DICT(METHOD_OBJECT)->items, args[0]));
+  b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
+  for (int i = 0; i < dict->names.count; i++) {
+    if (!IS_EMPTY(dict->names.values[i]) &&
+        values_equal(dict->values.values[i], args[0])) {
+      RETURN_VALUE(dict->names.values[i]);
+    }
+  }
+  RETURN;
 }
 
 DECLARE_DICT_METHOD(to_list) {
@@ -193,12 +185,9 @@ DECLARE_DICT_METHOD(to_list) {
   b_obj_list *name_list = (b_obj_list*)GC(new_list(vm));
   b_obj_list *value_list = (b_obj_list *)GC(new_list(vm));
   for (int i = 0; i < dict->names.count; i++) {
-    write_list(vm, name_list, dict->names.values[i]);
-    b_value value;
-    if (table_get(&dict->items, dict->names.values[i], &value)) {
-      write_list(vm, value_list, value);
-    } else { // theoretically impossible
-      write_list(vm, value_list, NIL_VAL);
+    if (!IS_EMPTY(dict->names.values[i])) {
+      write_list(vm, name_list, dict->names.values[i]);
+      write_list(vm, value_list, dict->values.values[i]);
     }
   }
 
@@ -211,21 +200,179 @@ DECLARE_DICT_METHOD(to_list) {
 
 DECLARE_DICT_METHOD(has_attr) {
   ENFORCE_ARG_COUNT(has_attr, 1);
+  b_value value;
+  RETURN_BOOL(dict_get_entry(AS_DICT(METHOD_OBJECT), args[0], &value));
+}
+
+// calls function with the value at index and, when it declares a second
+// parameter, its key.
+static bool call_with_key(b_vm *vm, b_value function, int arity,
+                          b_obj_dict *dict, int index, b_value *result) {
+  b_value args[2] = {dict->values.values[index], dict->names.values[index]};
+  return call_blade_value(vm, function, arity > 1 ? 2 : 1, args, result);
+}
+
+// adds an entry whose value may not be referenced from anywhere else e.g.
+// one returned by a function, keeping both on the stack in case adding the
+// entry triggers a collection.
+static void add_unreferenced(b_vm *vm, b_obj_dict *dict, b_value key,
+                             b_value value) {
+  push(vm, key);
+  push(vm, value);
+  dict_add_entry(vm, dict, key, value);
+  pop_n(vm, 2);
+}
+
+// the function may change the dict, so every loop below checks the count
+// again after each call and skips removed entries.
+#define DICT_CALLBACK_FAILED()                                                 \
+  {                                                                            \
+    args[-1] = FALSE_VAL;                                                      \
+    return false;                                                              \
+  }
+
+DECLARE_DICT_METHOD(each) {
+  ENFORCE_ARG_COUNT(each, 1);
+  ENFORCE_ARG_TYPE(each, 0, IS_CALLABLE);
+
+  b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+
+  for (int i = 0; i < dict->names.count; i++) {
+    if (IS_EMPTY(dict->names.values[i])) continue;
+
+    b_value result;
+    if (!call_with_key(vm, args[0], arity, dict, i, &result)) {
+      DICT_CALLBACK_FAILED();
+    }
+  }
+  RETURN;
+}
+
+DECLARE_DICT_METHOD(map) {
+  ENFORCE_ARG_COUNT(map, 1);
+  ENFORCE_ARG_TYPE(map, 0, IS_CALLABLE);
+
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+  b_obj_dict *result = (b_obj_dict *) GC(new_dict(vm));
+
   for (int i = 0; i < dict->names.count; i++) {
-    if (values_equal(dict->names.values[i], args[0])) {
+    if (IS_EMPTY(dict->names.values[i])) continue;
+
+    b_value key = dict->names.values[i], value;
+    if (!call_with_key(vm, args[0], arity, dict, i, &value)) {
+      DICT_CALLBACK_FAILED();
+    }
+    add_unreferenced(vm, result, key, value);
+  }
+  RETURN_OBJ(result);
+}
+
+DECLARE_DICT_METHOD(filter) {
+  ENFORCE_ARG_COUNT(filter, 1);
+  ENFORCE_ARG_TYPE(filter, 0, IS_CALLABLE);
+
+  b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+  b_obj_dict *result = (b_obj_dict *) GC(new_dict(vm));
+
+  for (int i = 0; i < dict->names.count; i++) {
+    if (IS_EMPTY(dict->names.values[i])) continue;
+
+    b_value key = dict->names.values[i], value = dict->values.values[i], keep;
+    if (!call_with_key(vm, args[0], arity, dict, i, &keep)) {
+      DICT_CALLBACK_FAILED();
+    }
+    if (!is_false(keep)) {
+      add_unreferenced(vm, result, key, value);
+    }
+  }
+  RETURN_OBJ(result);
+}
+
+DECLARE_DICT_METHOD(reduce) {
+  ENFORCE_ARG_RANGE(reduce, 1, 2);
+  ENFORCE_ARG_TYPE(reduce, 0, IS_CALLABLE);
+
+  b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+
+  b_value accumulator = NIL_VAL;
+  bool started = arg_count == 2;
+  if (started) {
+    accumulator = args[1];
+  }
+
+  for (int i = 0; i < dict->names.count; i++) {
+    if (IS_EMPTY(dict->names.values[i])) continue;
+
+    if (!started) {
+      accumulator = dict->values.values[i];
+      started = true;
+      continue;
+    }
+
+    b_value call_args[3] = {accumulator, dict->values.values[i],
+                            dict->names.values[i]};
+    if (!call_blade_value(vm, args[0], arity > 2 ? 3 : 2, call_args,
+                          &accumulator)) {
+      DICT_CALLBACK_FAILED();
+    }
+  }
+  RETURN_VALUE(accumulator);
+}
+
+DECLARE_DICT_METHOD(any) {
+  ENFORCE_ARG_COUNT(any, 1);
+  ENFORCE_ARG_TYPE(any, 0, IS_CALLABLE);
+
+  b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+
+  for (int i = 0; i < dict->names.count; i++) {
+    if (IS_EMPTY(dict->names.values[i])) continue;
+
+    b_value result;
+    if (!call_with_key(vm, args[0], arity, dict, i, &result)) {
+      DICT_CALLBACK_FAILED();
+    }
+    if (!is_false(result)) {
       RETURN_TRUE;
     }
   }
   RETURN_FALSE;
 }
 
+DECLARE_DICT_METHOD(all) {
+  ENFORCE_ARG_COUNT(all, 1);
+  ENFORCE_ARG_TYPE(all, 0, IS_CALLABLE);
+
+  b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+
+  for (int i = 0; i < dict->names.count; i++) {
+    if (IS_EMPTY(dict->names.values[i])) continue;
+
+    b_value result;
+    if (!call_with_key(vm, args[0], arity, dict, i, &result)) {
+      DICT_CALLBACK_FAILED();
+    }
+    if (is_false(result)) {
+      RETURN_FALSE;
+    }
+  }
+  RETURN_TRUE;
+}
+
+#undef DICT_CALLBACK_FAILED
+
 DECLARE_DICT_METHOD(__iter__) {
   ENFORCE_ARG_COUNT(__iter__, 1);
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
 
   b_value result;
-  if (table_get(&dict->items, args[0], &result)) {
+  if (dict_get_entry(dict, args[0], &result)) {
     RETURN_VALUE(result);
   }
 
@@ -236,15 +383,21 @@ DECLARE_DICT_METHOD(__itern__) {
   ENFORCE_ARG_COUNT(__itern__, 1);
   b_obj_dict *dict = AS_DICT(METHOD_OBJECT);
 
+  int start = 0;
   if (IS_NIL(args[0])) {
-    if (dict->names.count == 0)
+    if (DICT_LENGTH(dict) == 0)
       RETURN_FALSE;
-    RETURN_VALUE(dict->names.values[0]);
+  } else {
+    b_value index;
+    if (!table_get(&dict->indices, args[0], &index))
+      RETURN;
+    start = (int) AS_NUMBER(index) + 1;
   }
-  for (int i = 0; i < dict->names.count; i++) {
-    if (values_equal(args[0], dict->names.values[i]) &&
-        (i + 1) < dict->names.count) {
-      RETURN_VALUE(dict->names.values[i + 1]);
+
+  // walk the dense keys, skipping removed entries
+  for (int i = start; i < dict->names.count; i++) {
+    if (!IS_EMPTY(dict->names.values[i])) {
+      RETURN_VALUE(dict->names.values[i]);
     }
   }
 
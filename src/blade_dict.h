@@ -136,6 +136,59 @@ DECLARE_DICT_METHOD(to_list);
  */
 DECLARE_DICT_METHOD(has_attr);
 
+/**
+ * dict.each(function: function)
+ *
+ * calls function with every value in the dict
+ * - when function takes two arguments, the key of the value is passed as
+ *   the second argument. the same applies to map(), filter(), any() and all()
+ */
+DECLARE_DICT_METHOD(each);
+
+/**
+ * dict.map(function: function)
+ *
+ * returns a new dict with the same keys as the dict and the values function
+ * returns for each of them
+ */
+DECLARE_DICT_METHOD(map);
+
+/**
+ * dict.filter(function: function)
+ *
+ * returns a new dict of the entries in the dict for which function returns
+ * a value that is not false
+ */
+DECLARE_DICT_METHOD(filter);
+
+/**
+ * dict.reduce(function: function [, initial: any])
+ *
+ * calls function with the value it returned for the previous entry (or
+ * initial) and every value in the dict, and returns its last return value.
+ * - without initial, the first value is used instead and the reduction
+ *   starts from the second entry
+ * - when function takes three arguments, the key of the value is passed
+ *   as the third argument
+ */
+DECLARE_DICT_METHOD(reduce);
+
+/**
+ * dict.any(function: function)
+ *
+ * returns true if function returns a value that is not false for any value
+ * in the dict or false otherwise
+ */
+DECLARE_DICT_METHOD(any);
+
+/**
+ * dict.all(function: function)
+ *
+ * returns true if function returns a value that is not false for every
+ * value in the dict or false otherwise
+ */
+DECLARE_DICT_METHOD(all);
+
 /**
  * dict.@iter()
  *
@@ -4,9 +4,12 @@
 #include "pathinfo.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <time.h>
 
@@ -14,8 +17,14 @@
 #include "win32.h"
 #else
 
+#include <sys/mman.h>
+#include <sys/uio.h>
 #include <utime.h>
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
 #endif // _WIN32
 
 #define FILE_ERROR(type, message)                                              \
@@ -36,17 +45,86 @@
 #define SET_DICT_STRING(d, n, l, v)                                            \
   dict_add_entry(vm, d, GC_L_STRING(n, l), v)
 
+// raises the errors read() raises for files that cannot be read. files the
+// buffered readers are already reading from are not checked again.
+#define ENFORCE_READABLE(file)                                                 \
+  if (!(file)->buffered) {                                                     \
+    if (!is_std_file(file)) {                                                  \
+      if (strstr((file)->mode->chars, "r") != NULL &&                          \
+          !file_exists((file)->path->chars)) {                                 \
+        FILE_ERROR(NotFound, "no such file or directory");                     \
+      } else if (strstr((file)->mode->chars, "w") != NULL &&                   \
+                 strstr((file)->mode->chars, "+") == NULL) {                   \
+        FILE_ERROR(Unsupported, "cannot read file in write mode");             \
+      }                                                                        \
+      if (!(file)->is_open) {                                                  \
+        file_open(file);                                                       \
+      }                                                                        \
+      if ((file)->file == NULL) {                                              \
+        FILE_ERROR(Read, "could not read file");                               \
+      }                                                                        \
+    } else if (fileno(stdout) == fileno((file)->file) ||                       \
+               fileno(stderr) == fileno((file)->file)) {                       \
+      FILE_ERROR(Unsupported, "cannot read from output file");                 \
+    }                                                                          \
+  }
+
+// raises the errors write() raises for files that cannot be written to and
+// opens the file again if it has been closed.
+#define ENFORCE_WRITABLE(file)                                                 \
+  if (!is_std_file(file)) {                                                    \
+    if (strstr((file)->mode->chars, "r") != NULL &&                            \
+        strstr((file)->mode->chars, "+") == NULL) {                            \
+      FILE_ERROR(Unsupported, "cannot read file in write mode");               \
+    }                                                                          \
+    if (!(file)->is_open) {                                                    \
+      file_open(file);                                                         \
+    }                                                                          \
+    if ((file)->file == NULL) {                                                \
+      FILE_ERROR(Write, "could not write to file");                            \
+    }                                                                          \
+  } else if (fileno(stdin) == fileno((file)->file)) {                          \
+    FILE_ERROR(Unsupported, "cannot write to input file");                     \
+  }
+
 bool is_std_file(b_obj_file *file) { return file->mode->length == 0; }
 
+// hands the position of the buffered readers back to stdio so that read(),
+// write(), seek() and tell() continue from the first byte they did not
+// return. unread data cannot be given back to pipes and terminals.
+static void file_sync_buffer(b_obj_file *file) {
+  if (file->buffered && file->file != NULL && !is_std_file(file)) {
+    off_t position = lseek(fileno(file->file), 0, SEEK_CUR);
+    if (position != -1) {
+      fseek(file->file, position - (file->buffer_end - file->buffer_start),
+            SEEK_SET);
+    }
+  }
+  file->buffered = false;
+  file->buffer_start = file->buffer_end = 0;
+}
+
 static void file_close(b_obj_file *file) {
+  file->buffered = false;
+  file->buffer_start = file->buffer_end = 0;
+
   if (file->file != NULL && !is_std_file(file)) {
     fflush(file->file);
     fclose(file->file);
     file->file = NULL;
     file->is_open = false;
+
+    // stdio uses the buffer until the stream is closed.
+    free(file->write_buffer);
+    file->write_buffer = NULL;
   }
 }
 
+static bool is_writable_mode(b_obj_string *mode) {
+  return strstr(mode->chars, "w") != NULL || strstr(mode->chars, "a") != NULL ||
+         strstr(mode->chars, "+") != NULL;
+}
+
 static void file_open(b_obj_file *file) {
   if ((file->file == NULL || !file->is_open) && !is_std_file(file)) {
     char *mode = file->mode->chars;
@@ -56,11 +134,155 @@ static void file_open(b_obj_file *file) {
     }
     file->file = fopen(file->path->chars, mode);
     file->is_open = true;
+
+    // writes are collected in a buffer of the size the file was created
+    // with rather than the few kilobytes stdio picks.
+    if (file->file != NULL && is_writable_mode(file->mode)) {
+      file->write_buffer = malloc(file->write_buffer_size);
+      if (file->write_buffer != NULL) {
+        setvbuf(file->file, file->write_buffer, _IOFBF,
+                file->write_buffer_size);
+      }
+    }
+  }
+}
+
+// reads more of the file into the read buffer after the bytes that have not
+// been returned yet, moving them to the front of the buffer first.
+// returns the number of bytes read, 0 at the end of the file or -1 on error.
+static ssize_t file_fill_buffer(b_vm *vm, b_obj_file *file) {
+  int fd = fileno(file->file);
+
+  if (!file->buffered) {
+    // flushing moves the descriptor to the position of the stream and drops
+    // whatever stdio has read ahead. then let the os read ahead instead.
+    if (!is_std_file(file)) {
+      fflush(file->file);
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    file->buffered = true;
+  }
+
+  if (file->buffer == NULL) {
+    file->buffer = ALLOCATE(unsigned char, FILE_READ_BUFFER_SIZE);
+  }
+
+  int unread = file->buffer_end - file->buffer_start;
+  if (file->buffer_start > 0) {
+    memmove(file->buffer, file->buffer + file->buffer_start, unread);
+    file->buffer_start = 0;
+    file->buffer_end = unread;
+  }
+
+  ssize_t count;
+  do {
+    count = read(fd, file->buffer + unread, FILE_READ_BUFFER_SIZE - unread);
+  } while (count == -1 && errno == EINTR);
+
+  if (count > 0) {
+    file->buffer_end += (int) count;
+  }
+  return count;
+}
+
+static b_value make_file_data(b_vm *vm, b_obj_file *file,
+                              const unsigned char *data, int length) {
+  if (strstr(file->mode->chars, "b") != NULL) {
+    return OBJ_VAL(copy_bytes(vm, (unsigned char *) data, length));
+  }
+  return OBJ_VAL(copy_string(vm, (const char *) data, length));
+}
+
+// makes a line from the part of it collected in long_line, if any, and the
+// length bytes at data.
+static b_value take_line(b_vm *vm, b_obj_file *file, unsigned char *long_line,
+                         size_t long_length, unsigned char *data, int length) {
+  if (long_line == NULL) {
+    return make_file_data(vm, file, data, length);
+  }
+
+  long_line = realloc(long_line, long_length + length);
+  memcpy(long_line + long_length, data, length);
+  b_value line = make_file_data(vm, file, long_line, (int) (long_length + length));
+  free(long_line);
+  return line;
+}
+
+// the standard streams are shared with io.getc(), file.read() and others that
+// read through stdio, so their lines are read with getline() from the stream
+// rather than ahead into the read buffer. the line buffer is reused.
+static char *std_line = NULL;
+static size_t std_line_capacity = 0;
+
+static int std_read_line(b_vm *vm, b_obj_file *file, b_value *line) {
+  ssize_t length = getline(&std_line, &std_line_capacity, file->file);
+  if (length == -1) {
+    if (ferror(file->file)) {
+      clearerr(file->file);
+      return -1;
+    }
+    return 0;
+  }
+
+  if (length > 0 && std_line[length - 1] == '\n') {
+    length--;
+  }
+  *line = make_file_data(vm, file, (unsigned char *) std_line, (int) length);
+  return 1;
+}
+
+int file_read_line(b_vm *vm, b_obj_file *file, b_value *line) {
+  if (is_std_file(file)) {
+    return std_read_line(vm, file, line);
+  }
+
+  // lines longer than the buffer are collected here.
+  unsigned char *long_line = NULL;
+  size_t long_length = 0;
+
+  // the number of unread bytes already known not to contain a line feed.
+  int scanned = 0;
+
+  for (;;) {
+    unsigned char *start = file->buffer + file->buffer_start;
+    int available = file->buffer_end - file->buffer_start;
+
+    unsigned char *newline = available > scanned
+        ? memchr(start + scanned, '\n', available - scanned) : NULL;
+    if (newline != NULL) {
+      int length = (int) (newline - start);
+      file->buffer_start += length + 1;
+      *line = take_line(vm, file, long_line, long_length, start, length);
+      return 1;
+    }
+
+    if (available == FILE_READ_BUFFER_SIZE) {
+      long_line = realloc(long_line, long_length + available);
+      memcpy(long_line + long_length, start, available);
+      long_length += available;
+      file->buffer_start = file->buffer_end = 0;
+      available = 0;
+    }
+    scanned = available;
+
+    ssize_t count = file_fill_buffer(vm, file);
+    if (count == 0 && (available > 0 || long_line != NULL)) {
+      // the last line of the file does not end with a line feed.
+      start = file->buffer + file->buffer_start;
+      file->buffer_start = file->buffer_end;
+      *line = take_line(vm, file, long_line, long_length, start, available);
+      return 1;
+    } else if (count <= 0) {
+      free(long_line);
+      return (int) count;
+    }
   }
 }
 
 DECLARE_NATIVE(file) {
-  ENFORCE_ARG_RANGE(file, 1, 2);
+  ENFORCE_ARG_RANGE(file, 1, 3);
   ENFORCE_ARG_TYPE(file, 0, IS_STRING);
   b_obj_string *path = AS_STRING(args[0]);
 
@@ -70,14 +292,24 @@ DECLARE_NATIVE(file) {
 
   b_obj_string *mode = NULL;
 
-  if (arg_count == 2) {
+  if (arg_count >= 2) {
     ENFORCE_ARG_TYPE(file, 1, IS_STRING);
     mode = AS_STRING(args[1]);
   } else {
     mode = (b_obj_string *)GC(copy_string(vm, "r", 1));
   }
 
+  int buffer_size = FILE_WRITE_BUFFER_SIZE;
+  if (arg_count == 3) {
+    ENFORCE_ARG_TYPE(file, 2, IS_NUMBER);
+    buffer_size = AS_NUMBER(args[2]);
+    if (buffer_size < 1) {
+      RETURN_ERROR("file buffer size must be greater than 0");
+    }
+  }
+
   b_obj_file *file = new_file(vm, path, mode);
+  file->write_buffer_size = buffer_size;
   file_open(file);
 
   RETURN_OBJ(file);
@@ -122,6 +354,7 @@ DECLARE_FILE_METHOD(read) {
   }
 
   b_obj_file *file = AS_FILE(METHOD_OBJECT);
+  file_sync_buffer(file);
 
   bool in_binary_mode = strstr(file->mode->chars, "b") != NULL;
 
@@ -156,6 +389,12 @@ DECLARE_FILE_METHOD(read) {
       rewind(file->file);
     }
 
+    // only the rest of a file that has been partly read is left.
+    long position = ftell(file->file);
+    if (position > 0 && (size_t) position <= file_size_real) {
+      file_size_real -= (size_t) position;
+    }
+
     if (file_size == (size_t) -1 || file_size > file_size_real) {
       file_size = file_size_real;
     }
@@ -207,6 +446,7 @@ DECLARE_FILE_METHOD(write) {
   b_obj_file *file = AS_FILE(METHOD_OBJECT);
   b_obj_string *string = NULL;
   b_obj_bytes *bytes = NULL;
+  file_sync_buffer(file);
 
   bool in_binary_mode = strstr(file->mode->chars, "b") != NULL;
 
@@ -218,29 +458,10 @@ DECLARE_FILE_METHOD(write) {
     bytes = AS_BYTES(args[0]);
   }
 
-  // file is in read only mode
-  if (!is_std_file(file)) {
-    if (strstr(file->mode->chars, "r") != NULL &&
-        strstr(file->mode->chars, "+") == NULL) {
-      FILE_ERROR(Unsupported, "cannot read file in write mode");
-    }
-
-    if ((!in_binary_mode ? string->length : bytes->bytes.count) == 0) {
-      FILE_ERROR(Write, "cannot write empty buffer to file");
-    }
-
-    if (!file->is_open) { // open the file if it isn't open
-      file_open(file);
-    }
-
-    if (file->file == NULL) {
-      FILE_ERROR(Write, "could not write to file");
-    }
-  } else {
-    // stdin should not write
-    if (fileno(stdin) == fileno(file->file)) {
-      FILE_ERROR(Unsupported, "cannot write to input file");
-    }
+  ENFORCE_WRITABLE(file);
+  if (!is_std_file(file) &&
+      (!in_binary_mode ? string->length : bytes->bytes.count) == 0) {
+    FILE_ERROR(Write, "cannot write empty buffer to file");
   }
 
   size_t count;
@@ -252,17 +473,114 @@ DECLARE_FILE_METHOD(write) {
                    bytes->bytes.count, file->file);
   }
 
-  // close file
-  if (count == (size_t) (in_binary_mode ? bytes->bytes.count : string->length)) {
-    file_close(file);
-  }
-
   if (count > (size_t) 0) {
     RETURN_TRUE;
   }
   RETURN_FALSE;
 }
 
+#ifndef _WIN32
+// writes every buffer in vectors to fd in as few calls as possible, going
+// on from where a partial write stopped.
+static bool write_vectors(int fd, struct iovec *vectors, int count) {
+  while (count > 0) {
+    ssize_t written = writev(fd, vectors, count < IOV_MAX ? count : IOV_MAX);
+    if (written == -1) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+
+    // skip the buffers that were written completely.
+    while (count > 0 && (size_t) written >= vectors->iov_len) {
+      written -= (ssize_t) vectors->iov_len;
+      vectors++;
+      count--;
+    }
+    if (count > 0) {
+      vectors->iov_base = (char *) vectors->iov_base + written;
+      vectors->iov_len -= (size_t) written;
+    }
+  }
+  return true;
+}
+#endif
+
+DECLARE_FILE_METHOD(write_all) {
+  ENFORCE_ARG_COUNT(write_all, 1);
+  ENFORCE_ARG_TYPE(write_all, 0, IS_LIST);
+
+  b_obj_file *file = AS_FILE(METHOD_OBJECT);
+  b_value_arr *items = &AS_LIST(args[0])->items;
+  file_sync_buffer(file);
+
+  bool in_binary_mode = strstr(file->mode->chars, "b") != NULL;
+
+  size_t total = 0;
+  for (int i = 0; i < items->count; i++) {
+    b_value item = items->values[i];
+    if (!in_binary_mode && IS_STRING(item)) {
+      total += AS_STRING(item)->length;
+    } else if (in_binary_mode && IS_BYTES(item)) {
+      total += AS_BYTES(item)->bytes.count;
+    } else {
+      RETURN_ERROR("write_all() expects a list of %s, %s given",
+                   in_binary_mode ? "bytes" : "strings", value_type(item));
+    }
+  }
+
+  ENFORCE_WRITABLE(file);
+
+#ifndef _WIN32
+  // batches larger than the buffer go to the file in one call and skip
+  // copying through the buffer.
+  if (total >= (size_t) file->write_buffer_size) {
+    fflush(file->file);
+
+    struct iovec *vectors = ALLOCATE(struct iovec, items->count);
+    for (int i = 0; i < items->count; i++) {
+      if (in_binary_mode) {
+        vectors[i].iov_base = AS_BYTES(items->values[i])->bytes.bytes;
+        vectors[i].iov_len = AS_BYTES(items->values[i])->bytes.count;
+      } else {
+        vectors[i].iov_base = AS_STRING(items->values[i])->chars;
+        vectors[i].iov_len = AS_STRING(items->values[i])->length;
+      }
+    }
+
+    bool written = write_vectors(fileno(file->file), vectors, items->count);
+    int error = errno;
+    FREE_ARRAY(struct iovec, vectors, items->count);
+
+    if (!written) {
+      FILE_ERROR(Write, strerror(error));
+    }
+
+    // stdio has to learn the position the file was moved to.
+    if (!is_std_file(file)) {
+      fseek(file->file, 0L, SEEK_CUR);
+    }
+    RETURN_TRUE;
+  }
+#endif
+
+  for (int i = 0; i < items->count; i++) {
+    b_value item = items->values[i];
+    size_t length, count;
+    if (in_binary_mode) {
+      length = AS_BYTES(item)->bytes.count;
+      count = fwrite(AS_BYTES(item)->bytes.bytes, 1, length, file->file);
+    } else {
+      length = AS_STRING(item)->length;
+      count = fwrite(AS_STRING(item)->chars, 1, length, file->file);
+    }
+
+    if (count < length) {
+      FILE_ERROR(Write, "could not write to file");
+    }
+  }
+  RETURN_TRUE;
+}
+
 DECLARE_FILE_METHOD(number) {
   ENFORCE_ARG_COUNT(number, 0);
   b_obj_file *file = AS_FILE(METHOD_OBJECT);
@@ -489,6 +807,7 @@ DECLARE_FILE_METHOD(copy) {
   ENFORCE_ARG_TYPE(copy, 0, IS_STRING);
   b_obj_file *file = AS_FILE(METHOD_OBJECT);
   DENY_STD();
+  file_sync_buffer(file);
 
   if (file_exists(file->path->chars)) {
     b_obj_string *name = AS_STRING(args[0]);
@@ -637,6 +956,7 @@ DECLARE_FILE_METHOD(seek) {
 
   long position = (long) AS_NUMBER(args[0]);
   int seek_type = AS_NUMBER(args[1]);
+  file_sync_buffer(file);
   RETURN_STATUS(fseek(file->file, position, seek_type));
 }
 
@@ -644,10 +964,204 @@ DECLARE_FILE_METHOD(tell) {
   ENFORCE_ARG_COUNT(tell, 0);
   b_obj_file *file = AS_FILE(METHOD_OBJECT);
   DENY_STD();
+  file_sync_buffer(file);
   RETURN_NUMBER(ftell(file->file));
 }
 
+DECLARE_FILE_METHOD(read_line) {
+  ENFORCE_ARG_COUNT(read_line, 0);
+  b_obj_file *file = AS_FILE(METHOD_OBJECT);
+  ENFORCE_READABLE(file);
+
+  b_value line;
+  int status = file_read_line(vm, file, &line);
+  if (status < 0) {
+    FILE_ERROR(Read, strerror(errno));
+  } else if (status == 0) {
+    RETURN;
+  }
+  RETURN_VALUE(line);
+}
+
+DECLARE_FILE_METHOD(lines) {
+  ENFORCE_ARG_COUNT(lines, 0);
+  b_obj_file *file = AS_FILE(METHOD_OBJECT);
+  ENFORCE_READABLE(file);
+
+  b_obj_list *list = (b_obj_list *) GC(new_list(vm));
+  b_value line;
+  int status;
+  while ((status = file_read_line(vm, file, &line)) > 0) {
+    // keep the line reachable in case growing the list collects garbage.
+    push(vm, line);
+    write_list(vm, list, line);
+    pop(vm);
+  }
+
+  if (status < 0) {
+    FILE_ERROR(Read, strerror(errno));
+  }
+  RETURN_OBJ(list);
+}
+
+DECLARE_FILE_METHOD(read_chunk) {
+  ENFORCE_ARG_COUNT(read_chunk, 1);
+  ENFORCE_ARG_TYPE(read_chunk, 0, IS_NUMBER);
+
+  int size = (int) AS_NUMBER(args[0]);
+  if (size <= 0) {
+    RETURN_ERROR("read_chunk() expects a size greater than 0");
+  }
+
+  b_obj_file *file = AS_FILE(METHOD_OBJECT);
+  ENFORCE_READABLE(file);
+
+  if (size <= FILE_READ_BUFFER_SIZE && !is_std_file(file)) {
+    ssize_t count = 1;
+    while (file->buffer_end - file->buffer_start < size && count > 0) {
+      count = file_fill_buffer(vm, file);
+    }
+    if (count < 0) {
+      FILE_ERROR(Read, strerror(errno));
+    }
+
+    int length = file->buffer_end - file->buffer_start;
+    if (length == 0) {
+      RETURN;
+    } else if (length > size) {
+      length = size;
+    }
+
+    unsigned char *start = file->buffer + file->buffer_start;
+    file->buffer_start += length;
+    RETURN_VALUE(make_file_data(vm, file, start, length));
+  }
+
+  // larger chunks, and chunks of the standard streams, are read straight
+  // into their own buffer after whatever the read buffer still holds.
+  unsigned char *chunk = malloc(size);
+  if (chunk == NULL) {
+    FILE_ERROR(Buffer, "not enough memory to read file");
+  }
+
+  int length = 0;
+  if (is_std_file(file)) {
+    // read through stdio like the other readers of the standard streams.
+    length = (int) fread(chunk, 1, size, file->file);
+    if (ferror(file->file)) {
+      clearerr(file->file);
+      free(chunk);
+      FILE_ERROR(Read, strerror(errno));
+    }
+  } else if (file->buffered) {
+    length = file->buffer_end - file->buffer_start;
+    memcpy(chunk, file->buffer + file->buffer_start, length);
+    file->buffer_start = file->buffer_end = 0;
+  } else if (file_fill_buffer(vm, file) >= 0) {
+    // starts buffered reading on the file.
+    length = file->buffer_end;
+    memcpy(chunk, file->buffer, length);
+    file->buffer_start = file->buffer_end = 0;
+  }
+
+  while (length < size && !is_std_file(file)) {
+    ssize_t count = read(fileno(file->file), chunk + length, size - length);
+    if (count == -1 && errno == EINTR) {
+      continue;
+    } else if (count < 0) {
+      free(chunk);
+      FILE_ERROR(Read, strerror(errno));
+    } else if (count == 0) {
+      break;
+    }
+    length += (int) count;
+  }
+
+  if (length == 0) {
+    free(chunk);
+    RETURN;
+  }
+
+  b_value value = make_file_data(vm, file, chunk, length);
+  free(chunk);
+  RETURN_VALUE(value);
+}
+
+DECLARE_FILE_METHOD(mmap) {
+  ENFORCE_ARG_COUNT(mmap, 0);
+  b_obj_file *file = AS_FILE(METHOD_OBJECT);
+  DENY_STD();
+
+#ifdef _WIN32
+  RETURN_ERROR("mmap() not supported in windows");
+#else
+  if (strstr(file->mode->chars, "r") == NULL ||
+      strstr(file->mode->chars, "+") != NULL) {
+    FILE_ERROR(Unsupported, "mmap() requires a file opened in read only mode");
+  }
+
+  int fd = open(file->path->chars, O_RDONLY);
+  if (fd == -1) {
+    FILE_ERROR(Access, strerror(errno));
+  }
+
+  struct stat stats;
+  if (fstat(fd, &stats) == -1) {
+    close(fd);
+    FILE_ERROR(Access, strerror(errno));
+  } else if (stats.st_size > INT_MAX) {
+    close(fd);
+    FILE_ERROR(Buffer, "file too large to map");
+  } else if (stats.st_size == 0) {
+    // empty mappings are not allowed.
+    close(fd);
+    RETURN_OBJ(new_bytes(vm, 0));
+  }
+
+  void *mapping = mmap(NULL, (size_t) stats.st_size, PROT_READ, MAP_PRIVATE,
+                       fd, 0);
+  // the mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    FILE_ERROR(Map, strerror(errno));
+  }
+
+  RETURN_OBJ(new_mapped_bytes(vm, mapping, (int) stats.st_size));
+#endif
+}
+
+// files are iterated line by line. the line read by @itern() is kept on the
+// file until @iter() returns it.
+DECLARE_FILE_METHOD(__iter__) {
+  ENFORCE_ARG_COUNT(__iter__, 1);
+  RETURN_VALUE(AS_FILE(METHOD_OBJECT)->line);
+}
+
+DECLARE_FILE_METHOD(__itern__) {
+  ENFORCE_ARG_COUNT(__itern__, 1);
+  b_obj_file *file = AS_FILE(METHOD_OBJECT);
+
+  if (!IS_NIL(args[0]) && !IS_NUMBER(args[0])) {
+    RETURN_ERROR("files are iterated by line number");
+  }
+  ENFORCE_READABLE(file);
+
+  int status = file_read_line(vm, file, &file->line);
+  if (status < 0) {
+    FILE_ERROR(Read, strerror(errno));
+  } else if (status == 0) {
+    file->line = NIL_VAL;
+    if (IS_NIL(args[0])) {
+      RETURN_FALSE;
+    }
+    RETURN;
+  }
+
+  RETURN_NUMBER(IS_NIL(args[0]) ? 0 : AS_NUMBER(args[0]) + 1);
+}
+
 #undef FILE_ERROR
+#undef ENFORCE_READABLE
 #undef RETURN_STATUS
 #undef SET_DICT_STRING
 #undef DENY_STD
\ No newline at end of file
@@ -7,13 +7,15 @@
 #define DECLARE_FILE_METHOD(name) DECLARE_METHOD(file##name)
 
 /**
- * file(path: string [, mode: string])
+ * file(path: string [, mode: string [, buffer_size: number]])
  *
  * opens a new file handle to the file specified
  * available modes are as exists in C, with the following exception
  * - w+ does not truncate the file, but will still create it
  *   if it does not exist
  * - default mode is 'r' i.e. read only
+ * - buffer_size is the size of the buffer writes are collected in
+ *   (default 64KB)
  */
 DECLARE_NATIVE(file);
 
@@ -27,10 +29,8 @@ DECLARE_FILE_METHOD(exists);
 /**
  * file.close()
  *
- * closes the stream to a file.
- * you will rarely ever need to call this method.
- * it's provided as a just-in-case mechanism
- * - we've had our own share of stubborn files :)
+ * closes the stream to a file and writes out whatever is still buffered.
+ * files are also closed when they are garbage collected.
  */
 DECLARE_FILE_METHOD(close);
 
@@ -39,8 +39,8 @@ DECLARE_FILE_METHOD(close);
  *
  * opens the stream to a file for the operation specified in the file
  * constructor.
- * you will need to call this method after a call to read or write if you wish
- * to read or write again as the file will already be closed.
+ * you will need to call this method after a call to read if you wish to
+ * read again as the file will already be closed.
  */
 DECLARE_FILE_METHOD(open);
 
@@ -76,10 +76,20 @@ DECLARE_FILE_METHOD(read);
  *
  * writes a string or bytes to an opened file.
  * - this requires mode 'w', 'a' or 'r+'
- * - when writing binary (mode 'b'), you will have to close it yourself if you
+ * - the file stays open and the data is buffered until the buffer is full
+ *   or the file is flushed, closed or garbage collected
  */
 DECLARE_FILE_METHOD(write);
 
+/**
+ * file.write_all(items: list)
+ *
+ * writes every string (or bytes in binary mode) in items to the file in
+ * order. batches larger than the buffer are written with a single
+ * vectored write.
+ */
+DECLARE_FILE_METHOD(write_all);
+
 /**
  * file.number()
  *
@@ -220,6 +230,67 @@ DECLARE_FILE_METHOD(seek);
  */
 DECLARE_FILE_METHOD(tell);
 
+/**
+ * file.read_line()
+ *
+ * reads the next line of the file without its line feed and returns it as
+ * string or bytes when opened in binary mode, or nil at the end of the file.
+ * - lines, chunks and for-in loops read the file through a shared buffer,
+ *   so they can be mixed freely. read(), write(), seek() and tell() continue
+ *   from the first byte they have not returned.
+ */
+DECLARE_FILE_METHOD(read_line);
+
+/**
+ * file.lines()
+ *
+ * returns a list of the remaining lines of the file without their line feeds.
+ * use a for-in loop over the file to process a large file a line at a time.
+ */
+DECLARE_FILE_METHOD(lines);
+
+/**
+ * file.read_chunk(size: number)
+ *
+ * reads the next size bytes of the file and returns them as string or bytes
+ * when opened in binary mode, or nil at the end of the file.
+ * fewer bytes are only returned at the end of the file.
+ */
+DECLARE_FILE_METHOD(read_chunk);
+
+/**
+ * file.mmap()
+ *
+ * maps the file into memory and returns its contents as bytes without
+ * reading or copying them. the pages are loaded on first access and the
+ * mapping is removed once the bytes and every slice of them are collected.
+ * - this requires mode 'r' or 'rb'
+ * - changing the bytes copies them first and never changes the file
+ */
+DECLARE_FILE_METHOD(mmap);
+
+/**
+ * file.@iter()
+ *
+ * implementing the iterable interface
+ */
+DECLARE_FILE_METHOD(__iter__);
+
+/**
+ * file.@itern()
+ *
+ * implementing the iterable interface
+ */
+DECLARE_FILE_METHOD(__itern__);
+
 bool is_std_file(b_obj_file *file);
 
+/**
+ * reads the next line of file without its line feed into line through the
+ * buffer read_line(), lines() and for-in share. the standard streams are
+ * read with getline() from their stdio stream instead.
+ * returns 1 if a line was read, 0 at the end of the file or -1 on error.
+ */
+int file_read_line(b_vm *vm, b_obj_file *file, b_value *line);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "blade_heap.h"
+#include "blade_list.h"
+
+#define HEAP_KEY(heap, i)                                                      \
+  (IS_NIL((heap)->comparator) ? (heap)->keys.values[i] : NIL_VAL)
+
+// sets before to whether the first value comes before the second one.
+static bool heap_before(b_vm *vm, b_obj_heap *heap, b_value a, b_value a_key,
+                        b_value b, b_value b_key, bool *before) {
+  if (IS_NIL(heap->comparator)) {
+    if (IS_NUMBER(a_key) && IS_NUMBER(b_key)) {
+      *before = AS_NUMBER(a_key) < AS_NUMBER(b_key);
+    } else {
+      *before = compare_values(a_key, b_key) < 0;
+    }
+    return true;
+  }
+
+  b_value args[2] = {a, b}, value;
+  if (!call_blade_value(vm, heap->comparator, 2, args, &value)) {
+    return false;
+  }
+
+  if (!IS_NUMBER(value)) {
+    throw_exception(vm, "heap comparator must return a number, %s returned",
+                    value_type(value));
+    return false;
+  }
+
+  *before = AS_NUMBER(value) < 0;
+  return true;
+}
+
+static inline void heap_swap(b_obj_heap *heap, int i, int j) {
+  b_value value = heap->values.values[i];
+  heap->values.values[i] = heap->values.values[j];
+  heap->values.values[j] = value;
+
+  if (IS_NIL(heap->comparator)) {
+    b_value key = heap->keys.values[i];
+    heap->keys.values[i] = heap->keys.values[j];
+    heap->keys.values[j] = key;
+  }
+}
+
+static bool sift_up(b_vm *vm, b_obj_heap *heap, int index) {
+  while (index > 0) {
+    int parent = (index - 1) / 2;
+    bool before;
+    if (!heap_before(vm, heap, heap->values.values[index],
+                     HEAP_KEY(heap, index), heap->values.values[parent],
+                     HEAP_KEY(heap, parent), &before)) {
+      return false;
+    }
+    if (!before) break;
+
+    heap_swap(heap, index, parent);
+    index = parent;
+  }
+  return true;
+}
+
+static bool sift_down(b_vm *vm, b_obj_heap *heap, int index) {
+  int count = heap->values.count;
+  for (;;) {
+    int smallest = index;
+    int left = 2 * index + 1, right = left + 1;
+    bool before;
+
+    if (left < count) {
+      if (!heap_before(vm, heap, heap->values.values[left],
+                       HEAP_KEY(heap, left), heap->values.values[smallest],
+                       HEAP_KEY(heap, smallest), &before)) {
+        return false;
+      }
+      if (before) smallest = left;
+    }
+
+    if (right < count) {
+      if (!heap_before(vm, heap, heap->values.values[right],
+                       HEAP_KEY(heap, right), heap->values.values[smallest],
+                       HEAP_KEY(heap, smallest), &before)) {
+        return false;
+      }
+      if (before) smallest = right;
+    }
+
+    if (smallest == index) break;
+    heap_swap(heap, index, smallest);
+    index = smallest;
+  }
+  return true;
+}
+
+static bool heap_push(b_vm *vm, b_obj_heap *heap, b_value value, b_value key) {
+  write_value_arr(vm, &heap->values, value);
+  if (IS_NIL(heap->comparator)) {
+    write_value_arr(vm, &heap->keys, key);
+  }
+  return sift_up(vm, heap, heap->values.count - 1);
+}
+
+// moves the last value to the top and sifts it down.
+static bool heap_remove_top(b_vm *vm, b_obj_heap *heap) {
+  int last = heap->values.count - 1;
+  heap->values.values[0] = heap->values.values[last];
+  heap->values.count--;
+  if (IS_NIL(heap->comparator)) {
+    heap->keys.values[0] = heap->keys.values[last];
+    heap->keys.count--;
+  }
+  return sift_down(vm, heap, 0);
+}
+
+// replaces the top of the heap with value and sifts it down.
+static bool heap_replace_top(b_vm *vm, b_obj_heap *heap, b_value value,
+                             b_value key) {
+  heap->values.values[0] = value;
+  if (IS_NIL(heap->comparator)) {
+    heap->keys.values[0] = key;
+  }
+  return sift_down(vm, heap, 0);
+}
+
+static bool heapify(b_vm *vm, b_obj_heap *heap) {
+  for (int i = heap->values.count / 2 - 1; i >= 0; i--) {
+    if (!sift_down(vm, heap, i)) return false;
+  }
+  return true;
+}
+
+static bool is_callable(b_value value) {
+  return IS_CLOSURE(value) || IS_FUNCTION(value) || IS_BOUND(value) ||
+         IS_NATIVE(value);
+}
+
+// reads the optional priority argument of push() and push_pop().
+#define HEAP_KEY_ARG(name, heap, key)                                          \
+  b_value key = args[0];                                                       \
+  if (arg_count == 2) {                                                        \
+    if (!IS_NIL((heap)->comparator)) {                                         \
+      RETURN_ERROR(#name "() priorities cannot be used with a comparator");   \
+    }                                                                          \
+    ENFORCE_ARG_TYPE(name, 1, IS_NUMBER);                                      \
+    key = args[1];                                                             \
+  }
+
+#define ENFORCE_NOT_BUSY(name, heap)                                           \
+  if ((heap)->busy) {                                                          \
+    RETURN_ERROR(#name "() cannot change a heap while comparing its values"); \
+  }
+
+// the comparator may raise an exception, which is already on its way.
+#define HEAP_FAILED(heap)                                                      \
+  {                                                                            \
+    (heap)->busy = false;                                                      \
+    args[-1] = FALSE_VAL;                                                      \
+    return false;                                                              \
+  }
+
+DECLARE_NATIVE(Heap) {
+  ENFORCE_ARG_RANGE(Heap, 0, 2);
+
+  b_value items = NIL_VAL, comparator = NIL_VAL;
+  if (arg_count == 2) {
+    ENFORCE_ARG_TYPE(Heap, 0, IS_LIST);
+    items = args[0];
+    comparator = args[1];
+  } else if (arg_count == 1) {
+    if (IS_LIST(args[0])) {
+      items = args[0];
+    } else {
+      comparator = args[0];
+    }
+  }
+
+  if (!IS_NIL(comparator) && !is_callable(comparator)) {
+    RETURN_ERROR("Heap() expects a list and/or comparator function, %s given",
+                 value_type(comparator));
+  }
+
+  b_obj_heap *heap = (b_obj_heap *) GC(new_heap(vm, comparator));
+  if (IS_NIL(items)) {
+    RETURN_OBJ(heap);
+  }
+
+  b_value_arr *values = &AS_LIST(items)->items;
+  for (int i = 0; i < values->count; i++) {
+    write_value_arr(vm, &heap->values, values->values[i]);
+    if (IS_NIL(comparator)) {
+      write_value_arr(vm, &heap->keys, values->values[i]);
+    }
+  }
+
+  heap->busy = true;
+  if (!heapify(vm, heap)) HEAP_FAILED(heap);
+  heap->busy = false;
+  RETURN_OBJ(heap);
+}
+
+DECLARE_HEAP_METHOD(length) {
+  ENFORCE_ARG_COUNT(length, 0);
+  RETURN_NUMBER(AS_HEAP(METHOD_OBJECT)->values.count);
+}
+
+DECLARE_HEAP_METHOD(push) {
+  ENFORCE_ARG_RANGE(push, 1, 2);
+  b_obj_heap *heap = AS_HEAP(METHOD_OBJECT);
+  ENFORCE_NOT_BUSY(push, heap);
+  HEAP_KEY_ARG(push, heap, key);
+
+  heap->busy = true;
+  if (!heap_push(vm, heap, args[0], key)) HEAP_FAILED(heap);
+  heap->busy = false;
+  RETURN;
+}
+
+DECLARE_HEAP_METHOD(pop) {
+  ENFORCE_ARG_COUNT(pop, 0);
+  b_obj_heap *heap = AS_HEAP(METHOD_OBJECT);
+  ENFORCE_NOT_BUSY(pop, heap);
+
+  if (heap->values.count == 0) {
+    RETURN;
+  }
+
+  b_value top = heap->values.values[0];
+  heap->busy = true;
+  if (!heap_remove_top(vm, heap)) HEAP_FAILED(heap);
+  heap->busy = false;
+  RETURN_VALUE(top);
+}
+
+DECLARE_HEAP_METHOD(peek) {
+  ENFORCE_ARG_COUNT(peek, 0);
+  b_obj_heap *heap = AS_HEAP(METHOD_OBJECT);
+  if (heap->values.count == 0) {
+    RETURN;
+  }
+  RETURN_VALUE(heap->values.values[0]);
+}
+
+DECLARE_HEAP_METHOD(push_pop) {
+  ENFORCE_ARG_RANGE(push_pop, 1, 2);
+  b_obj_heap *heap = AS_HEAP(METHOD_OBJECT);
+  ENFORCE_NOT_BUSY(push_pop, heap);
+  HEAP_KEY_ARG(push_pop, heap, key);
+
+  if (heap->values.count == 0) {
+    RETURN_VALUE(args[0]);
+  }
+
+  // the new value is returned right away unless the top comes before it.
+  heap->busy = true;
+  bool before;
+  if (!heap_before(vm, heap, heap->values.values[0], HEAP_KEY(heap, 0),
+                   args[0], key, &before)) {
+    HEAP_FAILED(heap);
+  }
+  if (!before) {
+    heap->busy = false;
+    RETURN_VALUE(args[0]);
+  }
+
+  b_value top = heap->values.values[0];
+  if (!heap_replace_top(vm, heap, args[0], key)) HEAP_FAILED(heap);
+  heap->busy = false;
+  RETURN_VALUE(top);
+}
+
+DECLARE_HEAP_METHOD(clear) {
+  ENFORCE_ARG_COUNT(clear, 0);
+  b_obj_heap *heap = AS_HEAP(METHOD_OBJECT);
+  ENFORCE_NOT_BUSY(clear, heap);
+  heap->values.count = 0;
+  heap->keys.count = 0;
+  RETURN;
+}
+
+DECLARE_HEAP_METHOD(nsmallest) {
+  ENFORCE_ARG_COUNT(nsmallest, 1);
+  ENFORCE_ARG_TYPE(nsmallest, 0, IS_NUMBER);
+  b_obj_heap *heap = AS_HEAP(METHOD_OBJECT);
+  int n = AS_NUMBER(args[0]);
+  if (n > heap->values.count) n = heap->values.count;
+
+  b_obj_list *list = (b_obj_list *) GC(new_list(vm));
+  if (n <= 0) {
+    RETURN_OBJ(list);
+  }
+
+  // pop from a copy so that the heap itself is left as it is.
+  b_obj_heap *copy = (b_obj_heap *) GC(new_heap(vm, heap->comparator));
+  for (int i = 0; i < heap->values.count; i++) {
+    write_value_arr(vm, &copy->values, heap->values.values[i]);
+    if (IS_NIL(heap->comparator)) {
+      write_value_arr(vm, &copy->keys, heap->keys.values[i]);
+    }
+  }
+
+  for (int i = 0; i < n; i++) {
+    write_list(vm, list, copy->values.values[0]);
+    if (!heap_remove_top(vm, copy)) HEAP_FAILED(heap);
+  }
+  RETURN_OBJ(list);
+}
+
+DECLARE_HEAP_METHOD(nlargest) {
+  ENFORCE_ARG_COUNT(nlargest, 1);
+  ENFORCE_ARG_TYPE(nlargest, 0, IS_NUMBER);
+  b_obj_heap *heap = AS_HEAP(METHOD_OBJECT);
+  int n = AS_NUMBER(args[0]);
+  if (n > heap->values.count) n = heap->values.count;
+
+  b_obj_list *list = (b_obj_list *) GC(new_list(vm));
+  if (n <= 0) {
+    RETURN_OBJ(list);
+  }
+
+  // keep the n largest values seen so far in a second heap whose top is
+  // the smallest of them.
+  b_obj_heap *largest = (b_obj_heap *) GC(new_heap(vm, heap->comparator));
+  heap->busy = true;
+  for (int i = 0; i < heap->values.count; i++) {
+    b_value value = heap->values.values[i], key = HEAP_KEY(heap, i);
+    if (largest->values.count < n) {
+      if (!heap_push(vm, largest, value, key)) HEAP_FAILED(heap);
+      continue;
+    }
+
+    bool before;
+    if (!heap_before(vm, largest, largest->values.values[0],
+                     HEAP_KEY(largest, 0), value, key, &before)) {
+      HEAP_FAILED(heap);
+    }
+    if (before && !heap_replace_top(vm, largest, value, key)) {
+      HEAP_FAILED(heap);
+    }
+  }
+
+  for (int i = 0; i < n; i++) {
+    write_list(vm, list, largest->values.values[0]);
+    if (!heap_remove_top(vm, largest)) HEAP_FAILED(heap);
+  }
+  heap->busy = false;
+
+  // the values came out from the smallest.
+  for (int i = 0, j = n - 1; i < j; i++, j--) {
+    b_value value = list->items.values[i];
+    list->items.values[i] = list->items.values[j];
+    list->items.values[j] = value;
+  }
+  RETURN_OBJ(list);
+}
+
+#undef HEAP_KEY
+#undef HEAP_KEY_ARG
+#undef ENFORCE_NOT_BUSY
+#undef HEAP_FAILED
@@ -0,0 +1,82 @@
+#ifndef BLADE_HEAP_H
+#define BLADE_HEAP_H
+
+#include "common.h"
+#include "native.h"
+#include "vm.h"
+
+#define DECLARE_HEAP_METHOD(name) DECLARE_METHOD(heap##name)
+
+/**
+ * Heap([items: list] [, comparator: function])
+ *
+ * creates a new min-heap i.e. a priority queue that returns its smallest
+ * value first
+ * - if items is given, the heap starts with the values in the list
+ * - if comparator is given, it is called with two values and must return
+ *   a negative number if the first comes before the second like for
+ *   list.sort(). otherwise values are ordered by their priority or, when
+ *   they were pushed without one, by the values themselves
+ */
+DECLARE_NATIVE(Heap);
+
+/**
+ * heap.length()
+ *
+ * returns the number of values in the heap
+ */
+DECLARE_HEAP_METHOD(length);
+
+/**
+ * heap.push(value: any [, priority: number])
+ *
+ * adds value to the heap. priorities cannot be used with a comparator
+ */
+DECLARE_HEAP_METHOD(push);
+
+/**
+ * heap.pop()
+ *
+ * removes and returns the smallest value in the heap or nil if it is empty
+ */
+DECLARE_HEAP_METHOD(pop);
+
+/**
+ * heap.peek()
+ *
+ * returns the smallest value in the heap or nil if it is empty
+ */
+DECLARE_HEAP_METHOD(peek);
+
+/**
+ * heap.push_pop(value: any [, priority: number])
+ *
+ * adds value to the heap and then removes and returns the smallest value.
+ * faster than calling push() and pop() one after the other
+ */
+DECLARE_HEAP_METHOD(push_pop);
+
+/**
+ * heap.clear()
+ *
+ * removes every value from the heap
+ */
+DECLARE_HEAP_METHOD(clear);
+
+/**
+ * heap.nsmallest(n: number)
+ *
+ * returns a list of the n smallest values in the heap from the smallest
+ * without removing them
+ */
+DECLARE_HEAP_METHOD(nsmallest);
+
+/**
+ * heap.nlargest(n: number)
+ *
+ * returns a list of the n largest values in the heap from the largest
+ * without removing them
+ */
+DECLARE_HEAP_METHOD(nlargest);
+
+#endif
@@ -1,11 +1,21 @@
 #include "blade_list.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 void write_list(b_vm *vm, b_obj_list *list, b_value value) {
   write_value_arr(vm, &list->items, value);
 }
 
+// appends a value that may not be referenced from anywhere else e.g. one
+// returned by a function. it stays on the stack in case growing the list
+// triggers a collection.
+static void write_unreferenced(b_vm *vm, b_obj_list *list, b_value value) {
+  push(vm, value);
+  write_list(vm, list, value);
+  pop(vm);
+}
+
 b_obj_list *copy_list(b_vm *vm, b_obj_list *list, int start, int length) {
   b_obj_list *_list = new_list(vm);
 
@@ -114,26 +124,32 @@ DECLARE_LIST_METHOD(shift) {
   }
 
   b_obj_list *list = AS_LIST(METHOD_OBJECT);
-  if (count >= list->items.count || list->items.count == 1) {
-    list->items.count = 0;
+  bool as_list = count > 1;
+  if (count > list->items.count) {
+    count = list->items.count;
+  }
+  if (count <= 0) {
     RETURN;
-  } else if (count > 0) {
-    b_obj_list *n_list = (b_obj_list *)GC(new_list(vm));
+  }
+
+  b_value value = list->items.values[0];
+  b_obj_list *n_list = NULL;
+  if (as_list) {
+    n_list = (b_obj_list *)GC(new_list(vm));
     for (int i = 0; i < count; i++) {
-      write_list(vm, n_list, list->items.values[0]);
-      for (int j = 0; j < list->items.count; j++) {
-        list->items.values[j] = list->items.values[j + 1];
-      }
-      list->items.count -= 1;
+      write_list(vm, n_list, list->items.values[i]);
     }
+  }
 
-    if (count == 1) {
-      RETURN_VALUE(n_list->items.values[0]);
-    } else {
-      RETURN_OBJ(n_list);
-    }
+  // move the rest of the list down in one go.
+  list->items.count -= count;
+  memmove(list->items.values, list->items.values + count,
+          list->items.count * sizeof(b_value));
+
+  if (n_list == NULL) {
+    RETURN_VALUE(value);
   }
-  RETURN;
+  RETURN_OBJ(n_list);
 }
 
 DECLARE_LIST_METHOD(remove_at) {
@@ -192,11 +208,106 @@ DECLARE_LIST_METHOD(reverse) {
   RETURN;
 }
 
+typedef struct {
+  b_vm *vm;
+  b_value function;
+} b_sort_callback;
+
+static bool compare_with_function(void *context, b_value a, b_value b,
+                                  int *result) {
+  b_sort_callback *callback = (b_sort_callback *) context;
+  b_vm *vm = callback->vm;
+
+  b_value args[2] = {a, b}, value;
+  if (!call_blade_value(vm, callback->function, 2, args, &value)) {
+    return false;
+  }
+
+  if (!IS_NUMBER(value)) {
+    throw_exception(vm, "sort() comparator must return a number, %s returned",
+                    value_type(value));
+    return false;
+  }
+
+  double order = AS_NUMBER(value);
+  *result = order < 0 ? -1 : (order > 0 ? 1 : 0);
+  return true;
+}
+
 DECLARE_LIST_METHOD(sort) {
-  ENFORCE_ARG_COUNT(sort, 0);
+  ENFORCE_ARG_RANGE(sort, 0, 2);
 
   b_obj_list *list = AS_LIST(METHOD_OBJECT);
-  sort_values(list->items.values, list->items.count);
+  b_value function = NIL_VAL;
+  bool reverse = false;
+
+  if (arg_count == 1 && IS_BOOL(args[0])) {
+    reverse = AS_BOOL(args[0]);
+  } else if (arg_count > 0) {
+    if (!IS_NIL(args[0]) && !IS_CLOSURE(args[0]) && !IS_FUNCTION(args[0]) &&
+        !IS_BOUND(args[0]) &&
+        !IS_NATIVE(args[0])) {
+      RETURN_ERROR("sort() expects argument 1 as function, %s given",
+                   value_type(args[0]));
+    }
+    function = args[0];
+
+    if (arg_count == 2) {
+      ENFORCE_ARG_TYPE(sort, 1, IS_BOOL);
+      reverse = AS_BOOL(args[1]);
+    }
+  }
+
+  int count = list->items.count;
+
+  if (IS_NIL(function)) {
+    if (!sort_values(vm, list->items.values, NULL, count, NULL, NULL,
+                     reverse)) {
+      args[-1] = FALSE_VAL;
+      return false;
+    }
+    RETURN;
+  }
+
+  // the function may run arbitrary code (including changing the list)
+  // so we sort a copy and write it back afterwards.
+  b_obj_list *values = (b_obj_list *) GC(new_list(vm));
+  for (int i = 0; i < count; i++) {
+    write_list(vm, values, list->items.values[i]);
+  }
+
+  b_sort_callback callback = {vm, function};
+  bool sorted;
+
+  if (function_arity(function) == 2) {
+    // a comparator that takes two values
+    sorted = sort_values(vm, values->items.values, NULL, count,
+                         compare_with_function, &callback, reverse);
+  } else {
+    // a key function that returns the value to sort by
+    b_obj_list *keys = (b_obj_list *) GC(new_list(vm));
+    sorted = true;
+    for (int i = 0; i < count && sorted; i++) {
+      b_value key;
+      sorted = call_blade_value(vm, function, 1, &values->items.values[i], &key);
+      if (sorted) write_unreferenced(vm, keys, key);
+    }
+
+    if (sorted) {
+      sorted = sort_values(vm, values->items.values, keys->items.values, count,
+                           NULL, NULL, reverse);
+    }
+  }
+
+  if (!sorted) {
+    args[-1] = FALSE_VAL;
+    return false;
+  }
+
+  if (list->items.count != count) {
+    RETURN_ERROR("list modified during sort()");
+  }
+  memcpy(list->items.values, values->items.values, sizeof(b_value) * count);
   RETURN;
 }
 
@@ -372,6 +483,145 @@ DECLARE_LIST_METHOD(to_dict) {
   RETURN_OBJ(dict);
 }
 
+// calls function with the item at index and, when it declares a second
+// parameter, the index itself.
+static bool call_with_index(b_vm *vm, b_value function, int arity,
+                            b_value item, int index, b_value *result) {
+  b_value args[2] = {item, NUMBER_VAL(index)};
+  return call_blade_value(vm, function, arity > 1 ? 2 : 1, args, result);
+}
+
+// the function may change the list, so every loop below checks the count
+// again after each call.
+#define LIST_CALLBACK_FAILED()                                                 \
+  {                                                                            \
+    args[-1] = FALSE_VAL;                                                      \
+    return false;                                                              \
+  }
+
+DECLARE_LIST_METHOD(each) {
+  ENFORCE_ARG_COUNT(each, 1);
+  ENFORCE_ARG_TYPE(each, 0, IS_CALLABLE);
+
+  b_obj_list *list = AS_LIST(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+
+  for (int i = 0; i < list->items.count; i++) {
+    b_value result;
+    if (!call_with_index(vm, args[0], arity, list->items.values[i], i,
+                         &result)) {
+      LIST_CALLBACK_FAILED();
+    }
+  }
+  RETURN;
+}
+
+DECLARE_LIST_METHOD(map) {
+  ENFORCE_ARG_COUNT(map, 1);
+  ENFORCE_ARG_TYPE(map, 0, IS_CALLABLE);
+
+  b_obj_list *list = AS_LIST(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+  b_obj_list *result = (b_obj_list *) GC(new_list(vm));
+
+  for (int i = 0; i < list->items.count; i++) {
+    b_value value;
+    if (!call_with_index(vm, args[0], arity, list->items.values[i], i,
+                         &value)) {
+      LIST_CALLBACK_FAILED();
+    }
+    write_unreferenced(vm, result, value);
+  }
+  RETURN_OBJ(result);
+}
+
+DECLARE_LIST_METHOD(filter) {
+  ENFORCE_ARG_COUNT(filter, 1);
+  ENFORCE_ARG_TYPE(filter, 0, IS_CALLABLE);
+
+  b_obj_list *list = AS_LIST(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+  b_obj_list *result = (b_obj_list *) GC(new_list(vm));
+
+  for (int i = 0; i < list->items.count; i++) {
+    b_value item = list->items.values[i], keep;
+    if (!call_with_index(vm, args[0], arity, item, i, &keep)) {
+      LIST_CALLBACK_FAILED();
+    }
+    if (!is_false(keep)) {
+      write_unreferenced(vm, result, item);
+    }
+  }
+  RETURN_OBJ(result);
+}
+
+DECLARE_LIST_METHOD(reduce) {
+  ENFORCE_ARG_RANGE(reduce, 1, 2);
+  ENFORCE_ARG_TYPE(reduce, 0, IS_CALLABLE);
+
+  b_obj_list *list = AS_LIST(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+
+  int start = 0;
+  b_value accumulator = NIL_VAL;
+  if (arg_count == 2) {
+    accumulator = args[1];
+  } else if (list->items.count > 0) {
+    accumulator = list->items.values[start++];
+  }
+
+  for (int i = start; i < list->items.count; i++) {
+    b_value call_args[3] = {accumulator, list->items.values[i], NUMBER_VAL(i)};
+    if (!call_blade_value(vm, args[0], arity > 2 ? 3 : 2, call_args,
+                          &accumulator)) {
+      LIST_CALLBACK_FAILED();
+    }
+  }
+  RETURN_VALUE(accumulator);
+}
+
+DECLARE_LIST_METHOD(any) {
+  ENFORCE_ARG_COUNT(any, 1);
+  ENFORCE_ARG_TYPE(any, 0, IS_CALLABLE);
+
+  b_obj_list *list = AS_LIST(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+
+  for (int i = 0; i < list->items.count; i++) {
+    b_value result;
+    if (!call_with_index(vm, args[0], arity, list->items.values[i], i,
+                         &result)) {
+      LIST_CALLBACK_FAILED();
+    }
+    if (!is_false(result)) {
+      RETURN_TRUE;
+    }
+  }
+  RETURN_FALSE;
+}
+
+DECLARE_LIST_METHOD(all) {
+  ENFORCE_ARG_COUNT(all, 1);
+  ENFORCE_ARG_TYPE(all, 0, IS_CALLABLE);
+
+  b_obj_list *list = AS_LIST(METHOD_OBJECT);
+  int arity = function_arity(args[0]);
+
+  for (int i = 0; i < list->items.count; i++) {
+    b_value result;
+    if (!call_with_index(vm, args[0], arity, list->items.values[i], i,
+                         &result)) {
+      LIST_CALLBACK_FAILED();
+    }
+    if (is_false(result)) {
+      RETURN_FALSE;
+    }
+  }
+  RETURN_TRUE;
+}
+
+#undef LIST_CALLBACK_FAILED
+
 DECLARE_LIST_METHOD(__iter__) {
   ENFORCE_ARG_COUNT(__iter__, 1);
   ENFORCE_ARG_TYPE(__iter__, 0, IS_NUMBER);
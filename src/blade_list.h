@@ -106,9 +106,13 @@ DECLARE_LIST_METHOD(remove);
 DECLARE_LIST_METHOD(reverse);
 
 /**
- * list.sort()
+ * list.sort([function: function [, reverse: bool]])
+ * list.sort(reverse: bool)
  *
- * sorts the entries in a list
+ * sorts the entries in a list using a stable sort.
+ * - when function takes two arguments, it is used as a comparator that
+ *   returns a negative number, zero or a positive number.
+ * - any other function is used as a key function whose results are sorted.
  */
 DECLARE_LIST_METHOD(sort);
 
@@ -199,6 +203,59 @@ DECLARE_LIST_METHOD(zip);
  */
 DECLARE_LIST_METHOD(to_dict);
 
+/**
+ * list.each(function: function)
+ *
+ * calls function with every item in the list
+ * - when function takes two arguments, the index of the item is passed as
+ *   the second argument. the same applies to map(), filter(), any() and all()
+ */
+DECLARE_LIST_METHOD(each);
+
+/**
+ * list.map(function: function)
+ *
+ * returns a new list of the values function returns for every item in the
+ * list
+ */
+DECLARE_LIST_METHOD(map);
+
+/**
+ * list.filter(function: function)
+ *
+ * returns a new list of the items in the list for which function returns a
+ * value that is not false
+ */
+DECLARE_LIST_METHOD(filter);
+
+/**
+ * list.reduce(function: function [, initial: any])
+ *
+ * calls function with the value it returned for the previous item (or
+ * initial) and every item in the list, and returns its last return value.
+ * - without initial, the first item is used instead and the reduction
+ *   starts from the second item
+ * - when function takes three arguments, the index of the item is passed
+ *   as the third argument
+ */
+DECLARE_LIST_METHOD(reduce);
+
+/**
+ * list.any(function: function)
+ *
+ * returns true if function returns a value that is not false for any item
+ * in the list or false otherwise
+ */
+DECLARE_LIST_METHOD(any);
+
+/**
+ * list.all(function: function)
+ *
+ * returns true if function returns a value that is not false for every
+ * item in the list or false otherwise
+ */
+DECLARE_LIST_METHOD(all);
+
 /**
  * list.@iter()
  *
@@ -0,0 +1,118 @@
+#include "blade_regex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void free_regex(b_regex *regex) {
+  if (regex->code != NULL) {
+    pcre2_match_data_free(regex->match_data);
+    pcre2_code_free(regex->code);
+    free(regex->source);
+  }
+  memset(regex, 0, sizeof(b_regex));
+}
+
+static b_regex *find_regex(b_regex_cache *cache, b_obj_string *pattern,
+                           uint32_t options, bool delimited, uint32_t hash) {
+  for (int i = 0; i < REGEX_CACHE_SIZE; i++) {
+    b_regex *regex = &cache->entries[i];
+    if (regex->code != NULL && regex->hash == hash &&
+        regex->options == options && regex->delimited == delimited &&
+        regex->length == pattern->length &&
+        memcmp(regex->source, pattern->chars, pattern->length) == 0) {
+      return regex;
+    }
+  }
+  return NULL;
+}
+
+// returns an empty slot or the least recently used entry after freeing it.
+static b_regex *claim_regex(b_regex_cache *cache) {
+  b_regex *oldest = &cache->entries[0];
+  for (int i = 0; i < REGEX_CACHE_SIZE; i++) {
+    b_regex *regex = &cache->entries[i];
+    if (regex->code == NULL)
+      return regex;
+    if (regex->last_used < oldest->last_used)
+      oldest = regex;
+  }
+
+  free_regex(oldest);
+  return oldest;
+}
+
+b_regex *get_regex(b_vm *vm, b_obj_string *pattern, uint32_t options,
+                   bool delimited, int *error_number, PCRE2_SIZE *error_offset) {
+  if (vm->regex_cache == NULL) {
+    vm->regex_cache = calloc(1, sizeof(b_regex_cache));
+    if (vm->regex_cache == NULL) {
+      *error_number = PCRE2_ERROR_NOMEMORY;
+      *error_offset = 0;
+      return NULL;
+    }
+  }
+
+  b_regex_cache *cache = vm->regex_cache;
+  uint32_t hash = string_hash(pattern) ^ options;
+
+  b_regex *regex = find_regex(cache, pattern, options, delimited, hash);
+  if (regex != NULL) {
+    regex->last_used = ++cache->clock;
+    return regex;
+  }
+
+  // the pattern of a delimited regex lies between its first character and
+  // the last occurrence of that character.
+  const char *source = pattern->chars;
+  int length = pattern->length;
+  if (delimited) {
+    int end = length - 1;
+    while (end > 0 && pattern->chars[end] != pattern->chars[0])
+      end--;
+    source = pattern->chars + 1;
+    length = end > 0 ? end - 1 : 0;
+  }
+
+  pcre2_code *code = pcre2_compile((PCRE2_SPTR) source, (PCRE2_SIZE) length,
+                                   options, error_number, error_offset, NULL);
+  if (code == NULL)
+    return NULL;
+
+  // patterns still match through the interpreter when jit is unavailable.
+  pcre2_jit_compile(code, PCRE2_JIT_COMPLETE);
+
+  pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(code, NULL);
+  char *copy = malloc((size_t) pattern->length + 1);
+  if (match_data == NULL || copy == NULL) {
+    pcre2_match_data_free(match_data);
+    pcre2_code_free(code);
+    free(copy);
+    *error_number = PCRE2_ERROR_NOMEMORY;
+    *error_offset = 0;
+    return NULL;
+  }
+  memcpy(copy, pattern->chars, pattern->length);
+  copy[pattern->length] = '\0';
+
+  regex = claim_regex(cache);
+  regex->source = copy;
+  regex->length = pattern->length;
+  regex->options = options;
+  regex->delimited = delimited;
+  regex->hash = hash;
+  regex->code = code;
+  regex->match_data = match_data;
+  regex->last_used = ++cache->clock;
+  return regex;
+}
+
+void free_regex_cache(b_vm *vm) {
+  if (vm->regex_cache == NULL)
+    return;
+
+  for (int i = 0; i < REGEX_CACHE_SIZE; i++) {
+    free_regex(&vm->regex_cache->entries[i]);
+  }
+  free(vm->regex_cache);
+  vm->regex_cache = NULL;
+}
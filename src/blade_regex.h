@@ -0,0 +1,42 @@
+#ifndef BLADE_REGEX_H
+#define BLADE_REGEX_H
+
+#include "common.h"
+#include "vm.h"
+
+#include "pcre2.h"
+
+typedef struct {
+  char *source; // the pattern as written, including any delimiters
+  int length;
+  uint32_t options;
+  bool delimited;
+  uint32_t hash;
+  uint64_t last_used;
+  pcre2_code *code;
+  pcre2_match_data *match_data;
+} b_regex;
+
+struct s_regex_cache {
+  b_regex entries[REGEX_CACHE_SIZE];
+  uint64_t clock;
+};
+
+/**
+ * returns the compiled form of pattern with the given compile options.
+ *
+ * compiled patterns are kept in a least recently used cache on the vm and
+ * jit compiled when pcre2 supports it, so matching the same pattern again
+ * costs a lookup. each entry owns a match data block that callers reuse.
+ * delimited tells whether pattern is a /.../ regex whose delimiters should
+ * be stripped before compiling.
+ *
+ * returns NULL and sets error_number and error_offset if the pattern does
+ * not compile.
+ */
+b_regex *get_regex(b_vm *vm, b_obj_string *pattern, uint32_t options,
+                   bool delimited, int *error_number, PCRE2_SIZE *error_offset);
+
+void free_regex_cache(b_vm *vm);
+
+#endif
@@ -0,0 +1,249 @@
+#include "blade_set.h"
+#include "blade_array.h"
+#include "blade_list.h"
+
+#define SET_HAS(set, v) table_get(&(set)->items, (v), &(b_value){0})
+
+// adds every value of a list, set, dictionary or typed array to the set.
+// returns false if items is none of them.
+static bool add_items(b_vm *vm, b_obj_set *set, b_value items) {
+  if (IS_LIST(items)) {
+    b_value_arr *values = &AS_LIST(items)->items;
+    for (int i = 0; i < values->count; i++) {
+      table_set(vm, &set->items, values->values[i], TRUE_VAL);
+    }
+  } else if (IS_SET(items)) {
+    table_add_all(vm, &AS_SET(items)->items, &set->items);
+  } else if (IS_DICT(items)) {
+    b_value_arr *names = &AS_DICT(items)->names;
+    for (int i = 0; i < names->count; i++) {
+      if (!IS_EMPTY(names->values[i])) {
+        table_set(vm, &set->items, names->values[i], TRUE_VAL);
+      }
+    }
+  } else if (IS_ARRAY(items)) {
+    b_obj_array *array = AS_ARRAY(items);
+    for (int i = 0; i < array->length; i++) {
+      table_set(vm, &set->items, NUMBER_VAL(array_get(array, i)), TRUE_VAL);
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static b_obj_set *copy_set(b_vm *vm, b_obj_set *set) {
+  b_obj_set *copy = (b_obj_set *) GC(new_set(vm));
+  table_add_all(vm, &set->items, &copy->items);
+  return copy;
+}
+
+DECLARE_NATIVE(Set) {
+  ENFORCE_ARG_RANGE(Set, 0, 1);
+  b_obj_set *set = (b_obj_set *) GC(new_set(vm));
+
+  if (arg_count == 1 && !add_items(vm, set, args[0])) {
+    RETURN_ERROR("Set() expects a list, set, dictionary or array, %s given",
+                 value_type(args[0]));
+  }
+  RETURN_OBJ(set);
+}
+
+DECLARE_SET_METHOD(length) {
+  ENFORCE_ARG_COUNT(length, 0);
+  RETURN_NUMBER(AS_SET(METHOD_OBJECT)->items.count);
+}
+
+DECLARE_SET_METHOD(add) {
+  ENFORCE_ARG_COUNT(add, 1);
+  RETURN_BOOL(table_set(vm, &AS_SET(METHOD_OBJECT)->items, args[0], TRUE_VAL));
+}
+
+DECLARE_SET_METHOD(extend) {
+  ENFORCE_ARG_COUNT(extend, 1);
+  if (!add_items(vm, AS_SET(METHOD_OBJECT), args[0])) {
+    RETURN_ERROR("extend() expects a list, set, dictionary or array, %s given",
+                 value_type(args[0]));
+  }
+  RETURN;
+}
+
+DECLARE_SET_METHOD(remove) {
+  ENFORCE_ARG_COUNT(remove, 1);
+  RETURN_BOOL(table_delete(&AS_SET(METHOD_OBJECT)->items, args[0]));
+}
+
+DECLARE_SET_METHOD(contains) {
+  ENFORCE_ARG_COUNT(contains, 1);
+  RETURN_BOOL(SET_HAS(AS_SET(METHOD_OBJECT), args[0]));
+}
+
+DECLARE_SET_METHOD(clear) {
+  ENFORCE_ARG_COUNT(clear, 0);
+  b_obj_set *set = AS_SET(METHOD_OBJECT);
+  free_table(vm, &set->items);
+  init_table(&set->items);
+  RETURN;
+}
+
+DECLARE_SET_METHOD(clone) {
+  ENFORCE_ARG_COUNT(clone, 0);
+  RETURN_OBJ(copy_set(vm, AS_SET(METHOD_OBJECT)));
+}
+
+DECLARE_SET_METHOD(union) {
+  ENFORCE_ARG_COUNT(union, 1);
+  if (!IS_SET(args[0]) && !IS_LIST(args[0])) {
+    RETURN_ERROR("union() expects argument 1 as set or list, %s given",
+                 value_type(args[0]));
+  }
+
+  b_obj_set *set = AS_SET(METHOD_OBJECT);
+  // start from the larger set so that fewer values need to be inserted.
+  if (IS_SET(args[0]) && AS_SET(args[0])->items.count > set->items.count) {
+    b_obj_set *result = copy_set(vm, AS_SET(args[0]));
+    table_add_all(vm, &set->items, &result->items);
+    RETURN_OBJ(result);
+  }
+
+  b_obj_set *result = copy_set(vm, set);
+  add_items(vm, result, args[0]);
+  RETURN_OBJ(result);
+}
+
+DECLARE_SET_METHOD(intersection) {
+  ENFORCE_ARG_COUNT(intersection, 1);
+  b_obj_set *set = AS_SET(METHOD_OBJECT);
+  b_obj_set *result = (b_obj_set *) GC(new_set(vm));
+
+  if (IS_SET(args[0])) {
+    // probe the larger set with the values of the smaller one.
+    b_obj_set *small = set, *large = AS_SET(args[0]);
+    if (small->items.count > large->items.count) {
+      small = AS_SET(args[0]);
+      large = set;
+    }
+
+    for (int i = 0; i < small->items.capacity; i++) {
+      b_value key = small->items.entries[i].key;
+      if (!IS_EMPTY(key) && SET_HAS(large, key)) {
+        table_set(vm, &result->items, key, TRUE_VAL);
+      }
+    }
+  } else if (IS_LIST(args[0])) {
+    b_value_arr *values = &AS_LIST(args[0])->items;
+    for (int i = 0; i < values->count; i++) {
+      if (SET_HAS(set, values->values[i])) {
+        table_set(vm, &result->items, values->values[i], TRUE_VAL);
+      }
+    }
+  } else {
+    RETURN_ERROR("intersection() expects argument 1 as set or list, %s given",
+                 value_type(args[0]));
+  }
+
+  RETURN_OBJ(result);
+}
+
+DECLARE_SET_METHOD(difference) {
+  ENFORCE_ARG_COUNT(difference, 1);
+  b_obj_set *set = AS_SET(METHOD_OBJECT);
+
+  if (IS_SET(args[0])) {
+    b_obj_set *other = AS_SET(args[0]);
+    b_obj_set *result = (b_obj_set *) GC(new_set(vm));
+
+    for (int i = 0; i < set->items.capacity; i++) {
+      b_value key = set->items.entries[i].key;
+      if (!IS_EMPTY(key) && !SET_HAS(other, key)) {
+        table_set(vm, &result->items, key, TRUE_VAL);
+      }
+    }
+    RETURN_OBJ(result);
+  } else if (IS_LIST(args[0])) {
+    b_obj_set *result = copy_set(vm, set);
+    b_value_arr *values = &AS_LIST(args[0])->items;
+    for (int i = 0; i < values->count && result->items.count > 0; i++) {
+      table_delete(&result->items, values->values[i]);
+    }
+    RETURN_OBJ(result);
+  }
+
+  RETURN_ERROR("difference() expects argument 1 as set or list, %s given",
+               value_type(args[0]));
+}
+
+DECLARE_SET_METHOD(is_subset) {
+  ENFORCE_ARG_COUNT(is_subset, 1);
+  ENFORCE_ARG_TYPE(is_subset, 0, IS_SET);
+
+  b_obj_set *set = AS_SET(METHOD_OBJECT), *other = AS_SET(args[0]);
+  if (set->items.count > other->items.count) {
+    RETURN_FALSE;
+  }
+
+  for (int i = 0; i < set->items.capacity; i++) {
+    b_value key = set->items.entries[i].key;
+    if (!IS_EMPTY(key) && !SET_HAS(other, key)) {
+      RETURN_FALSE;
+    }
+  }
+  RETURN_TRUE;
+}
+
+DECLARE_SET_METHOD(to_list) {
+  ENFORCE_ARG_COUNT(to_list, 0);
+  b_obj_set *set = AS_SET(METHOD_OBJECT);
+
+  b_obj_list *list = (b_obj_list *) GC(new_list(vm));
+  for (int i = 0; i < set->items.capacity; i++) {
+    if (!IS_EMPTY(set->items.entries[i].key)) {
+      write_list(vm, list, set->items.entries[i].key);
+    }
+  }
+  RETURN_OBJ(list);
+}
+
+// sets are iterated by the index of their slots in the table.
+DECLARE_SET_METHOD(__iter__) {
+  ENFORCE_ARG_COUNT(__iter__, 1);
+  ENFORCE_ARG_TYPE(__iter__, 0, IS_NUMBER);
+
+  b_obj_set *set = AS_SET(METHOD_OBJECT);
+  int index = AS_NUMBER(args[0]);
+
+  if (index > -1 && index < set->items.capacity &&
+      !IS_EMPTY(set->items.entries[index].key)) {
+    args[-1] = set->items.entries[index].key;
+    return true;
+  }
+
+  RETURN;
+}
+
+DECLARE_SET_METHOD(__itern__) {
+  ENFORCE_ARG_COUNT(__itern__, 1);
+  b_obj_set *set = AS_SET(METHOD_OBJECT);
+
+  int index;
+  if (IS_NIL(args[0])) {
+    index = 0;
+  } else if (IS_NUMBER(args[0])) {
+    index = (int) AS_NUMBER(args[0]) + 1;
+  } else {
+    RETURN_ERROR("sets are numerically indexed");
+  }
+
+  for (; index < set->items.capacity; index++) {
+    if (!IS_EMPTY(set->items.entries[index].key)) {
+      RETURN_NUMBER(index);
+    }
+  }
+
+  if (IS_NIL(args[0])) {
+    RETURN_FALSE;
+  }
+  RETURN;
+}
+
+#undef SET_HAS
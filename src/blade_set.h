@@ -0,0 +1,112 @@
+#ifndef BLADE_SET_H
+#define BLADE_SET_H
+
+#include "common.h"
+#include "native.h"
+#include "vm.h"
+
+#define DECLARE_SET_METHOD(name) DECLARE_METHOD(set##name)
+
+/**
+ * Set([items: list|set|dict|array])
+ *
+ * creates a new set
+ * - if items is given, the set starts with every distinct value in it.
+ *   for dictionaries, the keys are used
+ *
+ * membership follows ==, so strings and numbers are compared by value and
+ * every other object by identity. the iteration order is unspecified.
+ */
+DECLARE_NATIVE(Set);
+
+/**
+ * set.length()
+ *
+ * returns the number of values in the set
+ */
+DECLARE_SET_METHOD(length);
+
+/**
+ * set.add(value: any)
+ *
+ * adds value to the set
+ * @return true if value was not already in the set or false otherwise
+ */
+DECLARE_SET_METHOD(add);
+
+/**
+ * set.extend(items: list|set|dict|array)
+ *
+ * adds every value in items to the set
+ */
+DECLARE_SET_METHOD(extend);
+
+/**
+ * set.remove(value: any)
+ *
+ * removes value from the set
+ * @return true if value was in the set or false otherwise
+ */
+DECLARE_SET_METHOD(remove);
+
+/**
+ * set.contains(value: any)
+ *
+ * returns true if value is in the set or false otherwise
+ */
+DECLARE_SET_METHOD(contains);
+
+/**
+ * set.clear()
+ *
+ * removes every value from the set
+ */
+DECLARE_SET_METHOD(clear);
+
+/**
+ * set.clone()
+ *
+ * returns a shallow copy of the set
+ */
+DECLARE_SET_METHOD(clone);
+
+/**
+ * set.union(other: set|list)
+ *
+ * returns a new set with the values in either the set or other
+ */
+DECLARE_SET_METHOD(union);
+
+/**
+ * set.intersection(other: set|list)
+ *
+ * returns a new set with the values in both the set and other
+ */
+DECLARE_SET_METHOD(intersection);
+
+/**
+ * set.difference(other: set|list)
+ *
+ * returns a new set with the values in the set that are not in other
+ */
+DECLARE_SET_METHOD(difference);
+
+/**
+ * set.is_subset(other: set)
+ *
+ * returns true if every value in the set is also in other
+ */
+DECLARE_SET_METHOD(is_subset);
+
+/**
+ * set.to_list()
+ *
+ * returns the values in the set as a list
+ */
+DECLARE_SET_METHOD(to_list);
+
+DECLARE_SET_METHOD(__iter__);
+
+DECLARE_SET_METHOD(__itern__);
+
+#endif
@@ -1,6 +1,9 @@
 #include "blade_string.h"
-#include "util.h"
+#include "blade_regex.h"
 #include "native.h"
+#include "number.h"
+#include "simd.h"
+#include "util.h"
 
 #include <ctype.h>
 #include <stdio.h>
@@ -9,22 +12,6 @@
 
 #ifdef _WIN32
 #include "win32.h"
-
-char *strsep(char **stringp, const char *delim) {
-  char *start = *stringp;
-  char *p;
-
-  p = (start != NULL) ? strpbrk(start, delim) : NULL;
-
-  if (p == NULL) {
-    *stringp = NULL;
-  } else {
-    *p = '\0';
-    *stringp = p + 1;
-  }
-
-  return start;
-}
 #endif
 
 /**
@@ -120,109 +107,67 @@ int is_regex(b_obj_string *string) {
     return c_options;
 }
 
-char *remove_regex_delimiter(b_vm *vm, b_obj_string *string) {
-  if (string->length == 0)
-    return string->chars;
-
-  char start = string->chars[0];
-  int i = string->length - 1;
-  for (; i > 0; i--) {
-    if (string->chars[i] == start)
-      break;
-  }
-
-  char *str = ALLOCATE(char, i);
-  memcpy(str, string->chars + 1, (size_t)i - 1);
-  str[i - 1] = '\0';
-
-  return str;
-}
-
 DECLARE_STRING_METHOD(length) {
   ENFORCE_ARG_COUNT(length, 0);
-  RETURN_NUMBER(AS_STRING(METHOD_OBJECT)->utf8_length);
+  RETURN_NUMBER(string_utf8_length(AS_STRING(METHOD_OBJECT)));
 }
 
 DECLARE_STRING_METHOD(upper) {
   ENFORCE_ARG_COUNT(upper, 0);
-  char *string = (char *)AS_C_STRING(METHOD_OBJECT);
-  for (char *p = string; *p; p++)
-    *p = toupper(*p);
-  RETURN_L_STRING(string, AS_STRING(METHOD_OBJECT)->length);
+  b_obj_string *string = AS_STRING(METHOD_OBJECT);
+
+  // strings are shared (interned or viewed) so never convert in place.
+  char *result = ALLOCATE(char, (size_t)string->length + 1);
+  ascii_to_upper(result, string->chars, string->length);
+  result[string->length] = '\0';
+  RETURN_T_STRING(result, string->length);
 }
 
 DECLARE_STRING_METHOD(lower) {
   ENFORCE_ARG_COUNT(lower, 0);
-  char *string = (char *)AS_C_STRING(METHOD_OBJECT);
-  for (char *p = string; *p; p++)
-    *p = tolower(*p);
-  RETURN_L_STRING(string, AS_STRING(METHOD_OBJECT)->length);
+  b_obj_string *string = AS_STRING(METHOD_OBJECT);
+
+  // strings are shared (interned or viewed) so never convert in place.
+  char *result = ALLOCATE(char, (size_t)string->length + 1);
+  ascii_to_lower(result, string->chars, string->length);
+  result[string->length] = '\0';
+  RETURN_T_STRING(result, string->length);
 }
 
 DECLARE_STRING_METHOD(is_alpha) {
   ENFORCE_ARG_COUNT(is_alpha, 0);
   b_obj_string *string = AS_STRING(METHOD_OBJECT);
-  for (int i = 0; i < string->length; i++) {
-    if (!isalpha((unsigned char)string->chars[i])) {
-      RETURN_FALSE;
-    }
-  }
-  RETURN_TRUE;
+  RETURN_BOOL(ascii_all_of(string->chars, string->length, ASCII_ALPHA));
 }
 
 DECLARE_STRING_METHOD(is_alnum) {
   ENFORCE_ARG_COUNT(is_alnum, 0);
   b_obj_string *string = AS_STRING(METHOD_OBJECT);
-  for (int i = 0; i < string->length; i++) {
-    if (!isalnum((unsigned char)string->chars[i])) {
-      RETURN_FALSE;
-    }
-  }
-  RETURN_TRUE;
+  RETURN_BOOL(ascii_all_of(string->chars, string->length, ASCII_ALNUM));
 }
 
 DECLARE_STRING_METHOD(is_number) {
   ENFORCE_ARG_COUNT(is_number, 0);
   b_obj_string *string = AS_STRING(METHOD_OBJECT);
-  for (int i = 0; i < string->length; i++) {
-    if (!isdigit((unsigned char)string->chars[i])){
-      RETURN_FALSE;
-    }
-  }
-  RETURN_TRUE;
+  RETURN_BOOL(ascii_all_of(string->chars, string->length, ASCII_DIGIT));
 }
 
 DECLARE_STRING_METHOD(is_lower) {
   ENFORCE_ARG_COUNT(is_lower, 0);
   b_obj_string *string = AS_STRING(METHOD_OBJECT);
-  for (int i = 0; i < string->length; i++) {
-    if (!islower((unsigned char)string->chars[i])) {
-      RETURN_FALSE;
-    }
-  }
-  RETURN_TRUE;
+  RETURN_BOOL(ascii_all_of(string->chars, string->length, ASCII_LOWER));
 }
 
 DECLARE_STRING_METHOD(is_upper) {
   ENFORCE_ARG_COUNT(is_upper, 0);
   b_obj_string *string = AS_STRING(METHOD_OBJECT);
-  for (int i = 0; i < string->length; i++) {
-    if (!isupper((unsigned char)string->chars[i])) {
-      RETURN_FALSE;
-    }
-  }
-  RETURN_TRUE;
+  RETURN_BOOL(ascii_all_of(string->chars, string->length, ASCII_UPPER));
 }
 
 DECLARE_STRING_METHOD(is_space) {
   ENFORCE_ARG_COUNT(is_space, 0);
   b_obj_string *string = AS_STRING(METHOD_OBJECT);
-  for (int i = 0; i < string->length; i++) {
-    if (!isspace((unsigned char)string->chars[i])) {
-      RETURN_FALSE;
-    }
-  }
-  RETURN_TRUE;
+  RETURN_BOOL(ascii_all_of(string->chars, string->length, ASCII_SPACE));
 }
 
 DECLARE_STRING_METHOD(trim) {
@@ -262,10 +207,7 @@ DECLARE_STRING_METHOD(trim) {
       end--;
   }
 
-  // Write new null terminator character
-  end[1] = '\0';
-
-  RETURN_STRING(string);
+  RETURN_L_STRING(string, (int)(end - string) + 1);
 }
 
 DECLARE_STRING_METHOD(ltrim) {
@@ -297,10 +239,7 @@ DECLARE_STRING_METHOD(ltrim) {
 
   end = string + strlen(string) - 1;
 
-  // Write new null terminator character
-  end[1] = '\0';
-
-  RETURN_STRING(string);
+  RETURN_L_STRING(string, (int)(end - string) + 1);
 }
 
 DECLARE_STRING_METHOD(rtrim) {
@@ -330,10 +269,7 @@ DECLARE_STRING_METHOD(rtrim) {
       end--;
   }
 
-  // Write new null terminator character
-  end[1] = '\0';
-
-  RETURN_STRING(string);
+  RETURN_L_STRING(string, (int)(end - string) + 1);
 }
 
 DECLARE_STRING_METHOD(join) {
@@ -386,15 +322,28 @@ DECLARE_STRING_METHOD(join) {
       RETURN_STRING("");
     }
 
-    char *result = value_to_string(vm, list[0]);
+    char *result = NULL;
+
+    for (int i = 0; i < count; i++) {
+      // skip the keys of removed dictionary entries
+      if (IS_EMPTY(list[i]))
+        continue;
 
-    for (int i = 1; i < count; i++) {
-      result = append_strings(result, method_obj->chars);
       char *str = value_to_string(vm, list[i]);
+      if (result == NULL) {
+        result = str;
+        continue;
+      }
+
+      result = append_strings(result, method_obj->chars);
       result = append_strings(result, str);
       free(str);
     }
 
+    if (result == NULL) {
+      RETURN_STRING("");
+    }
+
     RETURN_TT_STRING(result);
   }
 
@@ -416,29 +365,24 @@ DECLARE_STRING_METHOD(split) {
 
   // main work here...
   if (delimeter->length > 0) {
-    /* char *token = (char*)malloc(sizeof(char));
-    char *string = strdup(object->chars);
-
-    while((token = strtok_r(string, delimeter->chars, &string))) {
-      if (token != NULL) {
-        if (strlen(token) != 0)
-          write_list(vm, list, STRING_VAL(token));
+    // every byte of the delimiter separates tokens.
+    const char *start = object->chars, *end = object->chars + object->length;
+    for (;;) {
+      const char *found = find_any_byte(start, (int)(end - start),
+                                        delimeter->chars, delimeter->length);
+      if (found == NULL) {
+        write_list(vm, list, GC_L_STRING(start, (int)(end - start)));
+        break;
       }
+      write_list(vm, list, GC_L_STRING(start, (int)(found - start)));
+      start = found + 1;
     }
-    free(string); */
-
-    char *token, *str, *tofree;
-    tofree = str = strdup(object->chars); // We own str's memory now.
-    while ((token = strsep(&str, delimeter->chars)))
-      write_list(vm, list, GC_STRING(token));
-    free(tofree);
   } else {
-    for (int i = 0; i < object->utf8_length; i++) {
-
-      int start = i, end = i + 1;
-      utf8slice(object->chars, &start, &end);
-
-      write_list(vm, list, STRING_L_VAL(object->chars + start, (int)(end - start)));
+    for (int i = 0, start = string_utf8_offset(vm, object, 0);
+         i < string_utf8_length(object); i++) {
+      int end = string_utf8_offset(vm, object, i + 1);
+      write_list(vm, list, STRING_L_VAL(object->chars + start, end - start));
+      start = end;
     }
   }
 
@@ -449,10 +393,12 @@ DECLARE_STRING_METHOD(index_of) {
   ENFORCE_ARG_COUNT(index_of, 1);
   ENFORCE_ARG_TYPE(index_of, 0, IS_STRING);
 
-  char *str = AS_C_STRING(METHOD_OBJECT);
-  char *result = strstr(str, AS_C_STRING(args[0]));
+  b_obj_string *string = AS_STRING(METHOD_OBJECT);
+  b_obj_string *substr = AS_STRING(args[0]);
+  const char *result = find_bytes(string->chars, string->length,
+                                  substr->chars, substr->length);
 
-  if(result != NULL) RETURN_NUMBER((int)(result - str));
+  if(result != NULL) RETURN_NUMBER((int)(result - string->chars));
   RETURN_NUMBER(-1);
 }
 
@@ -497,8 +443,9 @@ DECLARE_STRING_METHOD(count) {
     RETURN_NUMBER(0);
 
   int count = 0;
-  const char *tmp = string->chars;
-  while ((tmp = strstr(tmp, substr->chars))) {
+  const char *tmp = string->chars, *end = string->chars + string->length;
+  while ((tmp = find_bytes(tmp, (int)(end - tmp), substr->chars,
+                           substr->length))) {
     count++;
     tmp++;
   }
@@ -508,7 +455,7 @@ DECLARE_STRING_METHOD(count) {
 
 DECLARE_STRING_METHOD(to_number) {
   ENFORCE_ARG_COUNT(to_number, 0);
-  RETURN_NUMBER(strtod(AS_C_STRING(METHOD_OBJECT), NULL));
+  RETURN_NUMBER(parse_number(AS_C_STRING(METHOD_OBJECT), NULL));
 }
 
 DECLARE_STRING_METHOD(to_list) {
@@ -516,12 +463,13 @@ DECLARE_STRING_METHOD(to_list) {
   b_obj_string *string = AS_STRING(METHOD_OBJECT);
   b_obj_list *list = (b_obj_list *)GC(new_list(vm));
 
-  if (string->utf8_length > 0) {
+  if (string_utf8_length(string) > 0) {
 
-    for (int i = 0; i < string->utf8_length; i++) {
-      int start = i, end = i + 1;
-      utf8slice(string->chars, &start, &end);
-      write_list(vm, list, GC_L_STRING(string->chars + start, (int)(end - start)));
+    for (int i = 0, start = string_utf8_offset(vm, string, 0);
+         i < string_utf8_length(string); i++) {
+      int end = string_utf8_offset(vm, string, i + 1);
+      write_list(vm, list, GC_L_STRING(string->chars + start, end - start));
+      start = end;
     }
   }
 
@@ -541,14 +489,14 @@ DECLARE_STRING_METHOD(lpad) {
     fill_char = AS_C_STRING(args[1])[0];
   }
 
-  if (width <= string->utf8_length)
+  if (width <= string_utf8_length(string))
     RETURN_VALUE(METHOD_OBJECT);
 
-  int fill_size = width - string->utf8_length;
+  int fill_size = width - string_utf8_length(string);
   char *fill = ALLOCATE(char, (size_t)fill_size + 1);
 
   int final_size = string->length + fill_size;
-  int final_utf8_size = string->utf8_length + fill_size;
+  int final_utf8_size = string_utf8_length(string) + fill_size;
 
   for (int i = 0; i < fill_size; i++)
     fill[i] = fill_char;
@@ -577,14 +525,14 @@ DECLARE_STRING_METHOD(rpad) {
     fill_char = AS_C_STRING(args[1])[0];
   }
 
-  if (width <= string->utf8_length)
+  if (width <= string_utf8_length(string))
     RETURN_VALUE(METHOD_OBJECT);
 
-  int fill_size = width - string->utf8_length;
+  int fill_size = width - string_utf8_length(string);
   char *fill = ALLOCATE(char, (size_t)fill_size + 1);
 
   int final_size = string->length + fill_size;
-  int final_utf8_size = string->utf8_length + fill_size;
+  int final_utf8_size = string_utf8_length(string) + fill_size;
 
   for (int i = 0; i < fill_size; i++)
     fill[i] = fill_char;
@@ -600,6 +548,59 @@ DECLARE_STRING_METHOD(rpad) {
   RETURN_OBJ(result);
 }
 
+// appends the groups captured by the last match to result. when the pattern
+// has named groups, a list of the groups followed by a dictionary of the
+// named ones is appended instead.
+static void write_match(b_vm *vm, b_obj_list *result, b_regex *regex,
+                        PCRE2_SPTR subject, PCRE2_SIZE *o_vector, int rc,
+                        uint32_t name_count) {
+  if (name_count == 0) {
+    for (int i = 0; i < rc; i++) {
+      PCRE2_SIZE substring_length = o_vector[2 * i + 1] - o_vector[2 * i];
+      if (substring_length > 0) {
+        PCRE2_SPTR substring_start = subject + o_vector[2 * i];
+        write_list(vm, result, GC_L_STRING((char *)substring_start, (int)substring_length));
+      }
+    }
+    return;
+  }
+
+  b_obj_list *match_list = (b_obj_list *)GC(new_list(vm));
+  b_obj_dict *match_dict = (b_obj_dict *)GC(new_dict(vm));
+
+  for (int i = 0; i < rc; i++) {
+    PCRE2_SIZE substring_length = o_vector[2 * i + 1] - o_vector[2 * i];
+    if (substring_length > 0) {
+      PCRE2_SPTR substring_start = subject + o_vector[2 * i];
+      write_value_arr(vm, &match_list->items,
+                      GC_L_STRING((char *)substring_start, (int)substring_length));
+    }
+  }
+
+  uint32_t name_entry_size;
+  PCRE2_SPTR name_table;
+  (void)pcre2_pattern_info(regex->code, PCRE2_INFO_NAMETABLE, &name_table);
+  (void)pcre2_pattern_info(regex->code, PCRE2_INFO_NAMEENTRYSIZE, &name_entry_size);
+
+  PCRE2_SPTR tab_ptr = name_table;
+  for (int i = 0; i < (int)name_count; i++) {
+    int n = (tab_ptr[0] << 8) | tab_ptr[1];
+    char *name = (char *)tab_ptr + 2;
+
+    // groups that took no part in the match are unset.
+    PCRE2_SIZE start = o_vector[2 * n];
+    int length = start == PCRE2_UNSET ? 0 : (int)(o_vector[2 * n + 1] - start);
+
+    dict_add_entry(vm, match_dict, GC_L_STRING(name, (int)strlen(name)),
+                   GC_L_STRING(length > 0 ? (char *)subject + start : "", length));
+
+    tab_ptr += name_entry_size;
+  }
+
+  write_value_arr(vm, &match_list->items, OBJ_VAL(match_dict));
+  write_list(vm, result, OBJ_VAL(match_list));
+}
+
 DECLARE_STRING_METHOD(match) {
   ENFORCE_ARG_COUNT(match, 1);
   ENFORCE_ARG_TYPE(match, 0, IS_STRING);
@@ -616,27 +617,23 @@ DECLARE_STRING_METHOD(match) {
   GET_REGEX_COMPILE_OPTIONS(match, substr, false);
 
   if ((int)compile_options < 0) {
-    RETURN_BOOL(strstr(string->chars, substr->chars) - string->chars > -1);
+    RETURN_BOOL(find_bytes(string->chars, string->length, substr->chars,
+                           substr->length) != NULL);
   }
 
-  char *real_regex = remove_regex_delimiter(vm, substr);
-
   int error_number;
   PCRE2_SIZE error_offset;
 
-  PCRE2_SPTR pattern = (PCRE2_SPTR)real_regex;
   PCRE2_SPTR subject = (PCRE2_SPTR)string->chars;
   PCRE2_SIZE subject_length = (PCRE2_SIZE)string->length;
 
-  pcre2_code *re =
-      pcre2_compile(pattern, PCRE2_ZERO_TERMINATED, compile_options,
-                    &error_number, &error_offset, NULL);
+  b_regex *regex = get_regex(vm, substr, compile_options, true, &error_number,
+                             &error_offset);
 
-  REGEX_COMPILATION_ERROR(re, error_number, error_offset);
+  REGEX_COMPILATION_ERROR(regex, error_number, error_offset);
 
-  pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, NULL);
-
-  int rc = pcre2_match(re, subject, subject_length, 0, 0, match_data, NULL);
+  int rc = pcre2_match(regex->code, subject, subject_length, 0, 0,
+                       regex->match_data, NULL);
 
   if (rc < 0) {
     switch (rc) {
@@ -648,70 +645,13 @@ DECLARE_STRING_METHOD(match) {
     }
   }
 
-  PCRE2_SIZE *o_vector = pcre2_get_ovector_pointer(match_data);
+  PCRE2_SIZE *o_vector = pcre2_get_ovector_pointer(regex->match_data);
   uint32_t name_count;
-  uint32_t name_entry_size;
-  PCRE2_SPTR name_table;
 
   b_obj_list *result = (b_obj_list *)GC(new_list(vm));
-  (void)pcre2_pattern_info(re, PCRE2_INFO_NAMECOUNT, &name_count);
+  (void)pcre2_pattern_info(regex->code, PCRE2_INFO_NAMECOUNT, &name_count);
 
-  if (name_count == 0) {
-    for (int i = 0; i < rc; i++) {
-      PCRE2_SIZE substring_length = o_vector[2 * i + 1] - o_vector[2 * i];
-      if (substring_length > 0) {
-        PCRE2_SPTR substring_start = subject + o_vector[2 * i];
-        write_list(vm, result, GC_L_STRING((char *)substring_start, (int)substring_length));
-      }
-    }
-  } else {
-
-    b_obj_list *match_list = (b_obj_list *)GC(new_list(vm));
-    b_obj_dict *match_dict = (b_obj_dict *)GC(new_dict(vm));
-
-    for (int i = 0; i < rc; i++) {
-      PCRE2_SIZE substring_length = o_vector[2 * i + 1] - o_vector[2 * i];
-      if (substring_length > 0) {
-        PCRE2_SPTR substring_start = subject + o_vector[2 * i];
-        write_value_arr(vm, &match_list->items,
-                        GC_L_STRING((char *)substring_start, (int)substring_length));
-      }
-    }
-
-    PCRE2_SPTR tab_ptr;
-
-    (void)pcre2_pattern_info(re, PCRE2_INFO_NAMETABLE, &name_table);
-    (void)pcre2_pattern_info(re, PCRE2_INFO_NAMEENTRYSIZE, &name_entry_size);
-
-    tab_ptr = name_table;
-
-    for (int i = 0; i < (int)name_count; i++) {
-      int n = (tab_ptr[0] << 8) | tab_ptr[1];
-
-      char *_key = malloc(0);
-      char *_val = malloc(0);
-
-      sprintf(_key, "%*s", name_entry_size - 3, tab_ptr + 2);
-      sprintf(_val, "%*s", (int)(o_vector[2 * n + 1] - o_vector[2 * n]),
-              subject + o_vector[2 * n]);
-
-      while (isspace((unsigned char)*_key))
-        _key++;
-
-      dict_add_entry(
-          vm, match_dict, OBJ_VAL(GC(take_string(vm, _key, name_entry_size - 3))),
-          OBJ_VAL(GC(take_string(vm, _val,
-                              (int)(o_vector[2 * n + 1] - o_vector[2 * n])))));
-
-      tab_ptr += name_entry_size;
-    }
-
-    write_value_arr(vm, &match_list->items, OBJ_VAL(match_dict));
-    write_list(vm, result, OBJ_VAL(match_list));
-  }
-
-  pcre2_match_data_free(match_data);
-  pcre2_code_free(re);
+  write_match(vm, result, regex, subject, o_vector, rc, name_count);
 
   RETURN_OBJ(result);
 }
@@ -731,26 +671,21 @@ DECLARE_STRING_METHOD(matches) {
 
   GET_REGEX_COMPILE_OPTIONS(matches, substr, true);
 
-  char *real_regex = remove_regex_delimiter(vm, substr);
-
   int error_number;
   PCRE2_SIZE error_offset;
   uint32_t option_bits;
   uint32_t newline;
   uint32_t name_count;
-  uint32_t name_entry_size;
-  PCRE2_SPTR name_table;
 
-  PCRE2_SPTR pattern = (PCRE2_SPTR)real_regex;
   PCRE2_SPTR subject = (PCRE2_SPTR)string->chars;
   PCRE2_SIZE subject_length = (PCRE2_SIZE)string->length;
 
-  pcre2_code *re = pcre2_compile(pattern, PCRE2_ZERO_TERMINATED, 0,
-                                 &error_number, &error_offset, NULL);
+  b_regex *regex = get_regex(vm, substr, 0, true, &error_number, &error_offset);
 
-  REGEX_COMPILATION_ERROR(re, error_number, error_offset);
+  REGEX_COMPILATION_ERROR(regex, error_number, error_offset);
 
-  pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, NULL);
+  pcre2_code *re = regex->code;
+  pcre2_match_data *match_data = regex->match_data;
 
   int rc = pcre2_match(re, subject, subject_length, 0, 0, match_data, NULL);
 
@@ -769,68 +704,14 @@ DECLARE_STRING_METHOD(matches) {
   // REGEX_VECTOR_SIZE_WARNING();
 
   // handle edge cases such as /(?=.\K)/
-  REGEX_ASSERTION_ERROR(re, match_data, o_vector);
+  REGEX_ASSERTION_ERROR(o_vector);
 
   (void)pcre2_pattern_info(re, PCRE2_INFO_NAMECOUNT, &name_count);
 
   b_obj_list *result = (b_obj_list *)GC(new_list(vm));
 
   // add first set of matches to response
-  if (name_count == 0) {
-    int i;
-    for (i = 0; i < rc; i++) {
-      PCRE2_SIZE substring_length = o_vector[2 * i + 1] - o_vector[2 * i];
-      if (substring_length > 0) {
-        PCRE2_SPTR substring_start = subject + o_vector[2 * i];
-        write_list(vm, result, GC_L_STRING((char *)substring_start, (int)substring_length));
-      }
-    }
-  } else {
-
-    b_obj_list *match_list = (b_obj_list *)GC(new_list(vm));
-    b_obj_dict *match_dict = (b_obj_dict *)GC(new_dict(vm));
-
-    int i;
-    for (i = 0; i < rc; i++) {
-      PCRE2_SIZE substring_length = o_vector[2 * i + 1] - o_vector[2 * i];
-      if (substring_length > 0) {
-        PCRE2_SPTR substring_start = subject + o_vector[2 * i];
-        write_value_arr(vm, &match_list->items,
-                        GC_L_STRING((char *)substring_start, (int)substring_length));
-      }
-    }
-
-    PCRE2_SPTR tab_ptr;
-
-    (void)pcre2_pattern_info(re, PCRE2_INFO_NAMETABLE, &name_table);
-    (void)pcre2_pattern_info(re, PCRE2_INFO_NAMEENTRYSIZE, &name_entry_size);
-
-    tab_ptr = name_table;
-
-    for (i = 0; i < (int)name_count; i++) {
-      int n = (tab_ptr[0] << 8) | tab_ptr[1];
-
-      char *_key = malloc(0);
-      char *_val = malloc(0);
-
-      sprintf(_key, "%*s", name_entry_size - 3, tab_ptr + 2);
-      sprintf(_val, "%*s", (int)(o_vector[2 * n + 1] - o_vector[2 * n]),
-              subject + o_vector[2 * n]);
-
-      while (isspace((unsigned char)*_key))
-        _key++;
-
-      dict_add_entry(
-          vm, match_dict, OBJ_VAL(GC(take_string(vm, _key, name_entry_size - 3))),
-          OBJ_VAL(GC(take_string(vm, _val,
-                              (int)(o_vector[2 * n + 1] - o_vector[2 * n])))));
-
-      tab_ptr += name_entry_size;
-    }
-
-    write_value_arr(vm, &match_list->items, OBJ_VAL(match_dict));
-    write_list(vm, result, OBJ_VAL(match_list));
-  }
+  write_match(vm, result, regex, subject, o_vector, rc, name_count);
 
   (void)pcre2_pattern_info(re, PCRE2_INFO_ALLOPTIONS, &option_bits);
   int utf8 = (option_bits & PCRE2_UTF) != 0;
@@ -885,75 +766,50 @@ DECLARE_STRING_METHOD(matches) {
     }
 
     if (rc < 0) {
-      pcre2_match_data_free(match_data);
-      pcre2_code_free(re);
       REGEX_ERR("regular expression error %d", rc);
     }
 
     // REGEX_VECTOR_SIZE_WARNING();
-    REGEX_ASSERTION_ERROR(re, match_data, o_vector);
-
-    if (name_count == 0) {
-      int i;
-      for (i = 0; i < rc; i++) {
-        PCRE2_SIZE substring_length = o_vector[2 * i + 1] - o_vector[2 * i];
-        if (substring_length > 0) {
-          PCRE2_SPTR substring_start = subject + o_vector[2 * i];
-          write_list(vm, result, GC_L_STRING((char *)substring_start, (int)substring_length));
-        }
-      }
-    } else {
-
-      b_obj_list *match_list = (b_obj_list *)GC(new_list(vm));
-      b_obj_dict *match_dict = (b_obj_dict *)GC(new_dict(vm));
-
-      int i;
-      for (i = 0; i < rc; i++) {
-        PCRE2_SIZE substring_length = o_vector[2 * i + 1] - o_vector[2 * i];
-        if (substring_length > 0) {
-          PCRE2_SPTR substring_start = subject + o_vector[2 * i];
-          write_value_arr(vm, &match_list->items,
-              GC_L_STRING((char *)substring_start, (int)substring_length));
-        }
-      }
-
-      PCRE2_SPTR tab_ptr;
-
-      (void)pcre2_pattern_info(re, PCRE2_INFO_NAMETABLE, &name_table);
-      (void)pcre2_pattern_info(re, PCRE2_INFO_NAMEENTRYSIZE, &name_entry_size);
+    REGEX_ASSERTION_ERROR(o_vector);
 
-      tab_ptr = name_table;
-
-      for (i = 0; i < (int)name_count; i++) {
-        int n = (tab_ptr[0] << 8) | tab_ptr[1];
+    write_match(vm, result, regex, subject, o_vector, rc, name_count);
+  }
 
-        char *_key = malloc(0);
-        char *_val = malloc(0);
+  RETURN_OBJ(result);
+}
 
-        sprintf(_key, "%*s", name_entry_size - 3, tab_ptr + 2);
-        sprintf(_val, "%*s", (int)(o_vector[2 * n + 1] - o_vector[2 * n]),
-                subject + o_vector[2 * n]);
+static b_obj_string *replace_text(b_vm *vm, b_obj_string *string,
+                                  b_obj_string *substr,
+                                  b_obj_string *rep_substr) {
+  const char *end = string->chars + string->length;
 
-        while (isspace((unsigned char)*_key))
-          _key++;
+  int count = 0;
+  for (const char *p = string->chars;
+       (p = find_bytes(p, (int)(end - p), substr->chars, substr->length));
+       p += substr->length) {
+    count++;
+  }
 
-        dict_add_entry(
-            vm, match_dict, OBJ_VAL(GC(take_string(vm, _key, name_entry_size - 3))),
-            OBJ_VAL(GC(take_string(vm, _val,
-                                (int)(o_vector[2 * n + 1] - o_vector[2 * n])))));
+  if (count == 0)
+    return string;
 
-        tab_ptr += name_entry_size;
-      }
+  int length = string->length + count * (rep_substr->length - substr->length);
+  char *result = ALLOCATE(char, (size_t)length + 1);
 
-      write_value_arr(vm, &match_list->items, OBJ_VAL(match_dict));
-      write_list(vm, result, OBJ_VAL(match_list));
-    }
+  char *out = result;
+  const char *p = string->chars, *found;
+  while ((found = find_bytes(p, (int)(end - p), substr->chars,
+                             substr->length))) {
+    memcpy(out, p, found - p);
+    out += found - p;
+    memcpy(out, rep_substr->chars, rep_substr->length);
+    out += rep_substr->length;
+    p = found + substr->length;
   }
+  memcpy(out, p, end - p);
+  result[length] = '\0';
 
-  pcre2_match_data_free(match_data);
-  pcre2_code_free(re);
-
-  RETURN_OBJ(result);
+  return take_string(vm, result, length);
 }
 
 DECLARE_STRING_METHOD(replace) {
@@ -972,56 +828,65 @@ DECLARE_STRING_METHOD(replace) {
   }
 
   GET_REGEX_COMPILE_OPTIONS(replace, substr, false);
-  char *real_regex = substr->chars;
-  if ((int)compile_options > -1) {
-    real_regex = remove_regex_delimiter(vm, substr);
+
+  // patterns and replacements without special characters mean the same
+  // thing as plain text, so skip pcre for them.
+  if ((int)compile_options == -1 &&
+      find_any_byte(substr->chars, substr->length, "\\^$.|?*+()[]{}",
+                    14) == NULL &&
+      find_any_byte(rep_substr->chars, rep_substr->length, "\\$",
+                    2) == NULL) {
+    RETURN_OBJ(replace_text(vm, string, substr, rep_substr));
   }
 
-  PCRE2_SPTR input = (PCRE2_SPTR)string->chars;
-  PCRE2_SPTR pattern = (PCRE2_SPTR)real_regex;
-  PCRE2_SPTR replacement = (PCRE2_SPTR)rep_substr->chars;
+  // plain patterns are compiled whole and always in multiline mode.
+  bool delimited = (int)compile_options > -1;
 
   int result, error_number;
   PCRE2_SIZE error_offset;
 
-  pcre2_code *re = pcre2_compile(pattern, PCRE2_ZERO_TERMINATED,
-                                 compile_options & PCRE2_MULTILINE,
-                                 &error_number, &error_offset, 0);
+  b_regex *regex = get_regex(vm, substr, compile_options & PCRE2_MULTILINE,
+                             delimited, &error_number, &error_offset);
 
-  REGEX_COMPILATION_ERROR(re, error_number, error_offset);
+  REGEX_COMPILATION_ERROR(regex, error_number, error_offset);
+
+  PCRE2_SPTR input = (PCRE2_SPTR)string->chars;
+  PCRE2_SPTR replacement = (PCRE2_SPTR)rep_substr->chars;
 
-  pcre2_match_context *match_context = pcre2_match_context_create(0);
+  // most replacements are about the size of the input so try once with
+  // room to spare before asking pcre for the exact length.
+  PCRE2_SIZE capacity = (PCRE2_SIZE)string->length + rep_substr->length + 64;
+  PCRE2_UCHAR *output_buffer = ALLOCATE(PCRE2_UCHAR, capacity);
+  PCRE2_SIZE output_length = capacity;
 
-  PCRE2_SIZE output_length = 0;
   result = pcre2_substitute(
-      re, input, PCRE2_ZERO_TERMINATED, 0,
+      regex->code, input, (PCRE2_SIZE)string->length, 0,
       PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH |
           PCRE2_SUBSTITUTE_EXTENDED,
-      0, match_context, replacement, PCRE2_ZERO_TERMINATED, 0, &output_length);
+      regex->match_data, NULL, replacement, (PCRE2_SIZE)rep_substr->length,
+      output_buffer, &output_length);
 
-  if (result != PCRE2_ERROR_NOMEMORY) {
-    REGEX_ERR("regular expression post-compilation failed for replacement",
-              result);
-  }
-
-  PCRE2_UCHAR *output_buffer = malloc(output_length * sizeof(PCRE2_UCHAR));
+  if (result == PCRE2_ERROR_NOMEMORY) {
+    // output_length now holds the size needed including the terminator.
+    output_buffer = GROW_ARRAY(PCRE2_UCHAR, output_buffer, capacity, output_length);
+    capacity = output_length;
 
-  result = pcre2_substitute(
-      re, input, PCRE2_ZERO_TERMINATED, 0,
-      PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_EXTENDED, 0, match_context,
-      replacement, PCRE2_ZERO_TERMINATED, output_buffer, &output_length);
+    result = pcre2_substitute(
+        regex->code, input, (PCRE2_SIZE)string->length, 0,
+        PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_EXTENDED, regex->match_data,
+        NULL, replacement, (PCRE2_SIZE)rep_substr->length, output_buffer,
+        &output_length);
+  }
 
   if (result < 0) {
+    FREE_ARRAY(PCRE2_UCHAR, output_buffer, capacity);
     REGEX_ERR("regular expression error at replacement time", result);
   }
 
-  b_obj_string *response =
-      take_string(vm, (char *)output_buffer, (int)output_length);
-
-  pcre2_match_context_free(match_context);
-  pcre2_code_free(re);
+  // shrink the buffer to the length of the result before the string takes it.
+  output_buffer = GROW_ARRAY(PCRE2_UCHAR, output_buffer, capacity, output_length + 1);
 
-  RETURN_OBJ(response);
+  RETURN_OBJ(take_string(vm, (char *)output_buffer, (int)output_length));
 }
 
 DECLARE_STRING_METHOD(to_bytes) {
@@ -1037,11 +902,11 @@ DECLARE_STRING_METHOD(__iter__) {
   b_obj_string *string = AS_STRING(METHOD_OBJECT);
   int index = AS_NUMBER(args[0]);
 
-  if (index > -1 && index < string->utf8_length) {
-    int start = index, end = index + 1;
-    utf8slice(string->chars, &start, &end);
+  if (index > -1 && index < string_utf8_length(string)) {
+    int start = string_utf8_offset(vm, string, index);
+    int end = string_utf8_offset(vm, string, index + 1);
 
-    RETURN_L_STRING(string->chars + start, (int)(end - start));
+    RETURN_L_STRING(string->chars + start, end - start);
   }
 
   RETURN;
@@ -1052,7 +917,7 @@ DECLARE_STRING_METHOD(__itern__) {
   b_obj_string *string = AS_STRING(METHOD_OBJECT);
 
   if (IS_NIL(args[0])) {
-    if (string->utf8_length == 0) {
+    if (string_utf8_length(string) == 0) {
       RETURN_FALSE;
     }
     RETURN_NUMBER(0);
@@ -1063,7 +928,7 @@ DECLARE_STRING_METHOD(__itern__) {
   }
 
   int index = AS_NUMBER(args[0]);
-  if (index < string->utf8_length - 1) {
+  if (index < string_utf8_length(string) - 1) {
     RETURN_NUMBER((double)index + 1);
   }
 
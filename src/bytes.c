@@ -1,5 +1,6 @@
 #include "bytes.h"
 #include "memory.h"
+#include "simd.h"
 
 #include <ctype.h>
 #include <string.h>
@@ -48,10 +49,8 @@ DECLARE_BYTES_METHOD(append) {
 
     // append here...
     b_obj_bytes *bytes = AS_BYTES(METHOD_OBJECT);
-    int old_count = bytes->bytes.count;
+    make_bytes_writable(vm, bytes, bytes->bytes.count + 1);
     bytes->bytes.count++;
-    bytes->bytes.bytes = reallocate(vm, bytes->bytes.bytes, old_count,
-                                    bytes->bytes.count);
     bytes->bytes.bytes[bytes->bytes.count - 1] = (unsigned char) byte;
     RETURN;
   } else if (IS_LIST(args[0])) {
@@ -59,9 +58,7 @@ DECLARE_BYTES_METHOD(append) {
     if (list->items.count > 0) {
       // append here...
       b_obj_bytes *bytes = AS_BYTES(METHOD_OBJECT);
-      bytes->bytes.bytes =
-          reallocate(vm, bytes->bytes.bytes, bytes->bytes.count,
-                     (size_t)bytes->bytes.count + (size_t)list->items.count);
+      make_bytes_writable(vm, bytes, bytes->bytes.count + list->items.count);
 
       for (int i = 0; i < list->items.count; i++) {
         if (!IS_NUMBER(list->items.values[i])) {
@@ -87,8 +84,13 @@ DECLARE_BYTES_METHOD(append) {
 DECLARE_BYTES_METHOD(clone) {
   ENFORCE_ARG_COUNT(clone, 0);
   b_obj_bytes *bytes = AS_BYTES(METHOD_OBJECT);
-  b_obj_bytes *n_bytes = new_bytes(vm, bytes->bytes.count);
 
+  // clones share the buffer until either of them is modified.
+  if (bytes->bytes.count >= MIN_BYTES_VIEW_LENGTH) {
+    RETURN_OBJ(new_bytes_view(vm, bytes, 0, bytes->bytes.count));
+  }
+
+  b_obj_bytes *n_bytes = new_bytes(vm, bytes->bytes.count);
   memcpy(n_bytes->bytes.bytes, bytes->bytes.bytes, bytes->bytes.count);
 
   RETURN_OBJ(n_bytes);
@@ -100,8 +102,7 @@ DECLARE_BYTES_METHOD(extend) {
   b_obj_bytes *bytes = AS_BYTES(METHOD_OBJECT);
   b_obj_bytes *n_bytes = AS_BYTES(args[0]);
 
-  bytes->bytes.bytes = reallocate(vm, bytes->bytes.bytes, bytes->bytes.count,
-    (size_t)bytes->bytes.count + (size_t)n_bytes->bytes.count);
+  make_bytes_writable(vm, bytes, bytes->bytes.count + n_bytes->bytes.count);
 
   memcpy(bytes->bytes.bytes + bytes->bytes.count, n_bytes->bytes.bytes,
          n_bytes->bytes.count);
@@ -130,6 +131,7 @@ DECLARE_BYTES_METHOD(remove) {
 
   unsigned char val = bytes->bytes.bytes[index];
 
+  make_bytes_writable(vm, bytes, bytes->bytes.count);
   for (int i = index; i < bytes->bytes.count; i++) {
     bytes->bytes.bytes[i] = bytes->bytes.bytes[i + 1];
   }
@@ -267,6 +269,41 @@ DECLARE_BYTES_METHOD(to_string) {
   RETURN_L_STRING(string, bytes->bytes.count);
 }
 
+DECLARE_BYTES_METHOD(index_of) {
+  ENFORCE_ARG_RANGE(index_of, 1, 2);
+  b_obj_bytes *bytes = AS_BYTES(METHOD_OBJECT);
+
+  const char *needle;
+  int needle_length;
+  if (IS_BYTES(args[0])) {
+    needle = (const char *) AS_BYTES(args[0])->bytes.bytes;
+    needle_length = AS_BYTES(args[0])->bytes.count;
+  } else if (IS_STRING(args[0])) {
+    needle = AS_STRING(args[0])->chars;
+    needle_length = AS_STRING(args[0])->length;
+  } else {
+    RETURN_ERROR("index_of() expects argument 1 as bytes or string, %s given",
+                 value_type(args[0]));
+  }
+
+  int start = 0;
+  if (arg_count == 2) {
+    ENFORCE_ARG_TYPE(index_of, 1, IS_NUMBER);
+    start = AS_NUMBER(args[1]);
+    if (start < 0 || start > bytes->bytes.count) {
+      RETURN_ERROR("bytes index %d out of range", start);
+    }
+  }
+
+  const char *haystack = (const char *) bytes->bytes.bytes;
+  const char *found = find_bytes(haystack + start, bytes->bytes.count - start,
+                                 needle, needle_length);
+  if (found == NULL) {
+    RETURN_NUMBER(-1);
+  }
+  RETURN_NUMBER(found - haystack);
+}
+
 DECLARE_BYTES_METHOD(__iter__) {
   ENFORCE_ARG_COUNT(__iter__, 1);
   ENFORCE_ARG_TYPE(__iter__, 0, IS_NUMBER);
@@ -144,6 +144,14 @@ DECLARE_BYTES_METHOD(to_list);
  */
 DECLARE_BYTES_METHOD(to_string);
 
+/**
+ * bytes.index_of(needle: bytes|string [, start: number])
+ *
+ * returns the index of the first occurrence of needle at or after start
+ * or -1 if needle is not in the bytes
+ */
+DECLARE_BYTES_METHOD(index_of);
+
 /**
  * bytes.@iter()
  *
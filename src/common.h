@@ -72,6 +72,10 @@
 
 #define DEFAULT_GC_START (1024 * 1024)
 
+// the size of the buffer echo and print write to when neither -o nor
+// BLADE_OUTPUT_BUFFER gives one.
+#define DEFAULT_STDOUT_BUFFER (64 * 1024)
+
 
 #define EXIT_COMPILE 10
 #define EXIT_RUNTIME 10
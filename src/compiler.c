@@ -2,6 +2,7 @@
 #include "common.h"
 #include "config.h"
 #include "memory.h"
+#include "number.h"
 #include "object.h"
 #include "pathinfo.h"
 #include "scanner.h"
@@ -385,7 +386,7 @@ static void init_compiler(b_parser *p, b_compiler *compiler, b_func_type type) {
 
   if (type != TYPE_SCRIPT) {
     p->vm->compiler->function->name =
-        copy_string(p->vm, p->previous.start, p->previous.length);
+        copy_interned_string(p->vm, p->previous.start, p->previous.length);
   }
 
   // claiming slot zero for use in class methods
@@ -404,7 +405,7 @@ static void init_compiler(b_parser *p, b_compiler *compiler, b_func_type type) {
 
 static int identifier_constant(b_parser *p, b_token *name) {
   return make_constant(p,
-                       OBJ_VAL(copy_string(p->vm, name->start, name->length)));
+                       OBJ_VAL(copy_interned_string(p->vm, name->start, name->length)));
 }
 
 static inline bool identifiers_equal(b_token *a, b_token *b) {
@@ -899,8 +900,8 @@ static void dictionary(b_parser *p, bool can_assign) {
       if (!check(p, RBRACE_TOKEN)) { // allow last pair to end with a comma
         if (check(p, IDENTIFIER_TOKEN)) {
           consume(p, IDENTIFIER_TOKEN, "");
-          emit_constant(p, OBJ_VAL(copy_string(p->vm, p->previous.start,
-                                               p->previous.length)));
+          emit_constant(p, OBJ_VAL(copy_interned_string(p->vm, p->previous.start,
+                                                        p->previous.length)));
         } else {
           expression(p);
         }
@@ -1005,7 +1006,7 @@ static b_value compile_number(b_parser *p) {
     long value = strtol(p->previous.start, NULL, 16);
     return NUMBER_VAL(value);
   } else {
-    double value = strtod(p->previous.start, NULL);
+    double value = parse_number(p->previous.start, NULL);
     return NUMBER_VAL(value);
   }
 }
@@ -1141,7 +1142,7 @@ static char *compile_string(b_parser *p, int *length) {
 static void string(b_parser *p, bool can_assign) {
   int length;
   char *str = compile_string(p, &length);
-  emit_constant(p, OBJ_VAL(take_string(p->vm, str, length)));
+  emit_constant(p, OBJ_VAL(take_interned_string(p->vm, str, length)));
 }
 
 static void string_interpolation(b_parser *p, bool can_assign) {
@@ -1870,7 +1871,7 @@ static void using_statement(b_parser *p) {
         } else if (p->previous.type == LITERAL_TOKEN) {
           int length;
           char *str = compile_string(p, &length);
-          b_obj_string *string = copy_string(p->vm, str, length);
+          b_obj_string *string = copy_interned_string(p->vm, str, length);
           table_set(p->vm, &sw->table, OBJ_VAL(string), jump);
         } else if (check_number(p)) {
           table_set(p->vm, &sw->table, compile_number(p), jump);
@@ -2113,11 +2114,11 @@ static void try_statement(b_parser *p) {
     address = current_blob(p)->count;
     // patch_try(p, try_begins, type);
 
+    // the vm resumes here with the exception on top of the stack
     if (match(p, IDENTIFIER_TOKEN)) {
       add_local(p, p->previous);
       mark_initialized(p);
-      uint16_t var = resolve_local(p, p->vm->compiler, &p->previous);
-      emit_byte_and_short(p, OP_SET_LOCAL, var);
+    } else {
       emit_byte(p, OP_POP);
     }
 
@@ -13,7 +13,6 @@
 #define MAX_USING_CASES 256
 #define MAX_FUNCTION_PARAMETERS 255
 #define FRAMES_MAX 512
-#define NUMBER_FORMAT "%.16g"
 #define MAX_INTERPOLATION_NESTING 8
 #define MAX_EXCEPTION_HANDLERS 16
 
@@ -23,6 +22,48 @@
 
 #define GC_HEAP_GROWTH_FACTOR 2
 
+// strings longer than this are not interned unless they are identifiers
+// or constants. their hash and utf8 length are computed on first use.
+#define MAX_INTERN_STRING_LENGTH 64
+
+// strings up to this length are stored in the same allocation as
+// their object header.
+#define MAX_INLINE_STRING_LENGTH 40
+
+// slices of bytes shorter than this are copied rather than shared so
+// that small headers do not keep large buffers alive.
+#define MIN_BYTES_VIEW_LENGTH 64
+
+// slices running to the end of a string share its buffer when they are
+// at least this long. other slices are copied so that chars stays nul
+// terminated.
+#define MIN_STRING_VIEW_LENGTH 128
+
+// indexing a non-ascii string scans at most this many code points from
+// the nearest entry of its code point index.
+#define UTF8_INDEX_STRIDE 64
+
+// when set, strings are hashed with the unseeded FNV-1a hash instead of
+// the per-process seeded wyhash. can be set with -DBLADE_USE_FNV_HASH=ON.
+#ifndef USE_FNV_HASH
+#define USE_FNV_HASH 0
+#endif
+
+// when unset, the string kernels in simd.c use their scalar versions only.
+// can be unset with -DBLADE_USE_SIMD=OFF.
+#ifndef USE_SIMD
+#define USE_SIMD 1
+#endif
+
+// the size of the buffer files read lines and chunks through.
+#define FILE_READ_BUFFER_SIZE 65536
+
+// the default size of the buffer writes to files are collected in.
+#define FILE_WRITE_BUFFER_SIZE 65536
+
+// the number of compiled regular expressions kept for reuse.
+#define REGEX_CACHE_SIZE 64
+
 #define USE_NAN_BOXING 1
 #define PCRE2_STATIC
 #define PCRE2_CODE_UNIT_WIDTH 8
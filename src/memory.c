@@ -4,10 +4,15 @@
 #include "object.h"
 #include "blade_file.h"
 #include "module.h"
+#include "snapshot.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
 #if defined(DEBUG_LOG_GC) && DEBUG_LOG_GC
 #include "debug.h"
 #include <stdio.h>
@@ -39,6 +44,10 @@ void *reallocate(b_vm *vm, void *pointer, size_t old_size, size_t new_size) {
 void mark_object(b_vm *vm, b_obj *object) {
   if (object == NULL)
     return;
+  if (vm->snapshot_file != NULL) {
+    record_snapshot_reference(vm, object);
+    return;
+  }
   if (object->mark == vm->mark_value)
     return;
 
@@ -99,12 +108,14 @@ void blacken_object(b_vm *vm, b_obj *object) {
       b_obj_file *file = (b_obj_file *)object;
       mark_object(vm, (b_obj *)file->mode);
       mark_object(vm, (b_obj *)file->path);
+      mark_value(vm, file->line);
       break;
     }
     case OBJ_DICT: {
       b_obj_dict *dict = (b_obj_dict *)object;
       mark_array(vm, &dict->names);
-      mark_table(vm, &dict->items);
+      mark_array(vm, &dict->values);
+      mark_table(vm, &dict->indices);
       break;
     }
     case OBJ_LIST: {
@@ -139,6 +150,7 @@ void blacken_object(b_vm *vm, b_obj *object) {
     case OBJ_FUNCTION: {
       b_obj_func *function = (b_obj_func *)object;
       mark_object(vm, (b_obj *)function->name);
+      mark_object(vm, (b_obj *)function->module);
       mark_array(vm, &function->blob.constants);
       break;
     }
@@ -155,7 +167,34 @@ void blacken_object(b_vm *vm, b_obj *object) {
     }
 
     case OBJ_BYTES: {
+      b_obj_bytes *bytes = (b_obj_bytes *)object;
       mark_object(vm, object);
+      if (bytes->parent != NULL) {
+        mark_object(vm, (b_obj *)bytes->parent);
+      }
+      break;
+    }
+
+    case OBJ_ARRAY:
+      break;
+
+    case OBJ_SET:
+      mark_table(vm, &((b_obj_set *)object)->items);
+      break;
+
+    case OBJ_DEQUE: {
+      b_obj_deque *deque = (b_obj_deque *)object;
+      for (int i = 0; i < deque->count; i++) {
+        mark_value(vm, DEQUE_AT(deque, i));
+      }
+      break;
+    }
+
+    case OBJ_HEAP: {
+      b_obj_heap *heap = (b_obj_heap *)object;
+      mark_value(vm, heap->comparator);
+      mark_array(vm, &heap->values);
+      mark_array(vm, &heap->keys);
       break;
     }
 
@@ -163,8 +202,13 @@ void blacken_object(b_vm *vm, b_obj *object) {
       mark_object(vm, object);
       break;
     }
-    case OBJ_STRING:
+    case OBJ_STRING: {
+      b_obj_string *string = (b_obj_string *)object;
+      if (string->parent != NULL) {
+        mark_object(vm, (b_obj *)string->parent);
+      }
       break;
+    }
   }
 }
 
@@ -194,22 +238,59 @@ static void free_object(b_vm *vm, b_obj *object) {
     }
     case OBJ_BYTES: {
       b_obj_bytes *bytes = (b_obj_bytes *)object;
-      free_byte_arr(vm, &bytes->bytes);
+      if (bytes->is_mapped) {
+#ifndef _WIN32
+        munmap(bytes->bytes.bytes, bytes->bytes.count);
+#endif
+        vm->bytes_allocated -= bytes->bytes.count;
+      } else if (bytes->parent == NULL) {
+        free_byte_arr(vm, &bytes->bytes);
+      }
       FREE(b_obj_bytes, object);
       break;
     }
+    case OBJ_ARRAY: {
+      b_obj_array *array = (b_obj_array *)object;
+      reallocate(vm, array->data,
+                 ARRAY_ELEMENT_SIZE(array->type) * (size_t)array->length, 0);
+      FREE(b_obj_array, object);
+      break;
+    }
+    case OBJ_SET: {
+      free_table(vm, &((b_obj_set *)object)->items);
+      FREE(b_obj_set, object);
+      break;
+    }
+    case OBJ_DEQUE: {
+      b_obj_deque *deque = (b_obj_deque *)object;
+      FREE_ARRAY(b_value, deque->values, deque->capacity);
+      FREE(b_obj_deque, object);
+      break;
+    }
+    case OBJ_HEAP: {
+      b_obj_heap *heap = (b_obj_heap *)object;
+      free_value_arr(vm, &heap->values);
+      free_value_arr(vm, &heap->keys);
+      FREE(b_obj_heap, object);
+      break;
+    }
     case OBJ_FILE: {
       b_obj_file *file = (b_obj_file *)object;
-      if (file->mode->length != 0 && !is_std_file(file)) {
+      if (file->file != NULL && !is_std_file(file)) {
         fclose(file->file);
       }
+      free(file->write_buffer);
+      if (file->buffer != NULL) {
+        FREE_ARRAY(unsigned char, file->buffer, FILE_READ_BUFFER_SIZE);
+      }
       FREE(b_obj_file, object);
       break;
     }
     case OBJ_DICT: {
       b_obj_dict *dict = (b_obj_dict *)object;
       free_value_arr(vm, &dict->names);
-      free_table(vm, &dict->items);
+      free_value_arr(vm, &dict->values);
+      free_table(vm, &dict->indices);
       FREE(b_obj_dict, object);
       break;
     }
@@ -268,8 +349,19 @@ static void free_object(b_vm *vm, b_obj *object) {
     }
     case OBJ_STRING: {
       b_obj_string *string = (b_obj_string *)object;
-      FREE_ARRAY(char, string->chars, (size_t)string->length + 1);
-      FREE(b_obj_string, object);
+      if (string->utf8_index != NULL) {
+        FREE_ARRAY(int, string->utf8_index,
+                   string_utf8_length(string) / UTF8_INDEX_STRIDE + 1);
+      }
+      if (string->parent != NULL) {
+        // views only borrow the buffer of their parent.
+        FREE(b_obj_string, object);
+      } else if (string->is_inline) {
+        reallocate(vm, object, sizeof(b_obj_string) + (size_t)string->length + 1, 0);
+      } else {
+        FREE_ARRAY(char, string->chars, (size_t)string->length + 1);
+        FREE(b_obj_string, object);
+      }
       break;
     }
 
@@ -278,7 +370,7 @@ static void free_object(b_vm *vm, b_obj *object) {
   }
 }
 
-static void mark_roots(b_vm *vm) {
+void mark_roots(b_vm *vm) {
   for (b_value *slot = vm->stack; slot < vm->stack_top; slot++) {
     mark_value(vm, *slot);
   }
@@ -294,6 +386,10 @@ static void mark_roots(b_vm *vm) {
 
   mark_table(vm, &vm->methods_string);
   mark_table(vm, &vm->methods_bytes);
+  mark_table(vm, &vm->methods_array);
+  mark_table(vm, &vm->methods_set);
+  mark_table(vm, &vm->methods_deque);
+  mark_table(vm, &vm->methods_heap);
   mark_table(vm, &vm->methods_file);
   mark_table(vm, &vm->methods_list);
   mark_table(vm, &vm->methods_dict);
@@ -349,6 +445,8 @@ void collect_garbage(b_vm *vm) {
   size_t before = vm->bytes_allocated;
 #endif
 
+  handle_heap_snapshot_request(vm);
+
   mark_roots(vm);
   trace_references(vm);
   table_remove_whites(vm, &vm->strings);
@@ -26,6 +26,8 @@ void mark_object(b_vm *vm, b_obj *object);
 
 void mark_value(b_vm *vm, b_value value);
 
+void mark_roots(b_vm *vm);
+
 void collect_garbage(b_vm *vm);
 
 void blacken_object(b_vm *vm, b_obj *object);
@@ -12,6 +12,8 @@ b_module_loader modules[] = {
     GET_MODULE_LOADER(date),     //
     GET_MODULE_LOADER(socket),     //
     GET_MODULE_LOADER(hash),     //
+    GET_MODULE_LOADER(profiler),     //
+    GET_MODULE_LOADER(reactor),     //
     NULL,
 };
 
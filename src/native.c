@@ -1,5 +1,6 @@
 #include "native.h"
 #include "blade_time.h"
+#include "number.h"
 #include "vm.h"
 
 #ifdef _WIN32
@@ -365,7 +366,14 @@ DECLARE_NATIVE(to_number) {
   } else if (IS_NIL(args[0])) {
     RETURN_NUMBER(-1);
   }
-  RETURN_NUMBER(strtod((const char *)value_to_string(vm, args[0]), NULL));
+  if (IS_STRING(args[0])) {
+    RETURN_NUMBER(parse_number(AS_C_STRING(args[0]), NULL));
+  }
+
+  char *value = value_to_string(vm, args[0]);
+  double number = parse_number(value, NULL);
+  free(value);
+  RETURN_NUMBER(number);
 }
 
 /**
@@ -404,12 +412,12 @@ DECLARE_NATIVE(to_list) {
   if (IS_DICT(args[0])) {
     b_obj_dict *dict = AS_DICT(args[0]);
     for (int i = 0; i < dict->names.count; i++) {
+      if (IS_EMPTY(dict->names.values[i]))
+        continue;
+
       b_obj_list *n_list = (b_obj_list *)GC(new_list(vm));
       write_value_arr(vm, &n_list->items, dict->names.values[i]);
-
-      b_value value;
-      table_get(&dict->items, dict->names.values[i], &value);
-      write_value_arr(vm, &n_list->items, value);
+      write_value_arr(vm, &n_list->items, dict->values.values[i]);
 
       write_value_arr(vm, &list->items, OBJ_VAL(n_list));
     }
@@ -645,6 +653,8 @@ DECLARE_NATIVE(is_function) {
 DECLARE_NATIVE(is_iterable) {
   ENFORCE_ARG_COUNT(is_iterable, 1);
   RETURN_BOOL(IS_LIST(args[0]) || IS_DICT(args[0]) || IS_BYTES(args[0]) ||
+              IS_ARRAY(args[0]) || IS_SET(args[0]) ||
+              IS_DEQUE(args[0]) || IS_FILE(args[0]) ||
               (IS_INSTANCE(args[0]) &&
                is_instance_of(AS_INSTANCE(args[0])->klass, "Iterable")));
 }
@@ -695,10 +705,10 @@ DECLARE_NATIVE(print) {
   for (int i = 0; i < arg_count; i++) {
     print_value(args[i]);
     if (i != arg_count - 1) {
-      printf(" ");
+      putchar(' ');
     }
   }
-  printf("\n");
+  putchar('\n');
   RETURN;
 }
 
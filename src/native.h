@@ -41,12 +41,15 @@
 #define NORMALIZE_IS_CHAR "char"
 #define NORMALIZE_IS_STRING "string"
 #define NORMALIZE_IS_CLOSURE "function"
+#define NORMALIZE_IS_CALLABLE "function"
 #define NORMALIZE_IS_INSTANCE "instance"
 #define NORMALIZE_IS_CLASS "class"
 #define NORMALIZE_IS_LIST "list"
 #define NORMALIZE_IS_DICT "dict"
 #define NORMALIZE_IS_OBJ "object"
 #define NORMALIZE_IS_FILE "file"
+#define NORMALIZE_IS_ARRAY "array"
+#define NORMALIZE_IS_SET "set"
 
 #define NORMALIZE(token) NORMALIZE_##token
 
@@ -134,15 +137,12 @@
                  (int)error_offset, buffer);                                   \
   }
 
-#define REGEX_ASSERTION_ERROR(re, match_data, ovector)                         \
+#define REGEX_ASSERTION_ERROR(ovector)                                         \
   if (ovector[0] > ovector[1]) {                                               \
     RETURN_ERROR(                                                            \
         "match aborted: regular expression used \\K in an assertion %.*s to "  \
         "set match start after its end.",                                      \
         (int)(ovector[0] - ovector[1]), (char *)(subject + ovector[1]));       \
-    pcre2_match_data_free(match_data);                                         \
-    pcre2_code_free(re);                                                       \
-    RETURN_EMPTY;                                                          \
   }
 
 
@@ -173,8 +173,6 @@
 
 extern int is_regex(b_obj_string *string);
 
-extern char *remove_regex_delimiter(b_vm *vm, b_obj_string *string);
-
 extern void write_list(b_vm *vm, b_obj_list *list, b_value value);
 
 extern b_obj_list *copy_list(b_vm *vm, b_obj_list *list, int start, int length);
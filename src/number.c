@@ -0,0 +1,494 @@
+#include "number.h"
+
+#include <ctype.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// an unnormalized floating point number f * 2^e
+typedef struct {
+  uint64_t f;
+  int e;
+} b_diy_fp;
+
+#define DP_SIGNIFICAND_SIZE 52
+#define DP_EXPONENT_BIAS (0x3FF + DP_SIGNIFICAND_SIZE)
+#define DP_MIN_EXPONENT (-DP_EXPONENT_BIAS)
+#define DP_HIDDEN_BIT 0x0010000000000000ull
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFull
+#define DP_EXPONENT_MASK 0x7FF0000000000000ull
+
+static inline b_diy_fp diy_fp_of(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+
+  int biased_e = (int) ((bits & DP_EXPONENT_MASK) >> DP_SIGNIFICAND_SIZE);
+  uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+
+  b_diy_fp fp;
+  if (biased_e != 0) {
+    fp.f = significand + DP_HIDDEN_BIT;
+    fp.e = biased_e - DP_EXPONENT_BIAS;
+  } else {
+    fp.f = significand;
+    fp.e = DP_MIN_EXPONENT + 1;
+  }
+  return fp;
+}
+
+static inline b_diy_fp diy_fp_multiply(b_diy_fp x, b_diy_fp y) {
+  b_diy_fp fp;
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 p = (unsigned __int128) x.f * y.f;
+  uint64_t h = (uint64_t) (p >> 64), l = (uint64_t) p;
+  if (l & (1ull << 63)) h++; // rounding
+  fp.f = h;
+#else
+  const uint64_t M32 = 0xFFFFFFFFull;
+  uint64_t a = x.f >> 32, b = x.f & M32, c = y.f >> 32, d = y.f & M32;
+  uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+  tmp += 1u << 31; // rounding
+  fp.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+#endif
+  fp.e = x.e + y.e + 64;
+  return fp;
+}
+
+static inline b_diy_fp diy_fp_normalize(b_diy_fp fp) {
+  while (!(fp.f & DP_HIDDEN_BIT)) {
+    fp.f <<= 1;
+    fp.e--;
+  }
+  fp.f <<= 64 - DP_SIGNIFICAND_SIZE - 1;
+  fp.e -= 64 - DP_SIGNIFICAND_SIZE - 1;
+  return fp;
+}
+
+// the boundaries halfway to the neighbouring doubles, normalized to the
+// exponent of the upper one.
+static inline void diy_fp_boundaries(b_diy_fp fp, b_diy_fp *minus,
+                                     b_diy_fp *plus) {
+  b_diy_fp p = {(fp.f << 1) + 1, fp.e - 1};
+  while (!(p.f & (DP_HIDDEN_BIT << 1))) {
+    p.f <<= 1;
+    p.e--;
+  }
+  p.f <<= 64 - DP_SIGNIFICAND_SIZE - 2;
+  p.e -= 64 - DP_SIGNIFICAND_SIZE - 2;
+
+  // the neighbour below is closer when the significand is a power of two
+  // unless the value is the smallest normal number.
+  b_diy_fp m;
+  if (fp.f == DP_HIDDEN_BIT && fp.e != DP_MIN_EXPONENT + 1) {
+    m.f = (fp.f << 2) - 1;
+    m.e = fp.e - 2;
+  } else {
+    m.f = (fp.f << 1) - 1;
+    m.e = fp.e - 1;
+  }
+  m.f <<= m.e - p.e;
+  m.e = p.e;
+
+  *plus = p;
+  *minus = m;
+}
+
+// 10^k for k = -348, -340, ..., 340 normalized to 64 bits.
+static const uint64_t cached_powers_f[] = {
+    0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull, 0xcf42894a5dce35eaull,
+    0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull, 0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full,
+    0xbe5691ef416bd60cull, 0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+    0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull, 0xc21094364dfb5637ull,
+    0x9096ea6f3848984full, 0xd77485cb25823ac7ull, 0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull,
+    0xb23867fb2a35b28eull, 0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+    0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull, 0xb5b5ada8aaff80b8ull,
+    0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull, 0x964e858c91ba2655ull, 0xdff9772470297ebdull,
+    0xa6dfbd9fb8e5b88full, 0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+    0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull, 0xaa242499697392d3ull,
+    0xfd87b5f28300ca0eull, 0xbce5086492111aebull, 0x8cbccc096f5088ccull, 0xd1b71758e219652cull,
+    0x9c40000000000000ull, 0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+    0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull, 0x9f4f2726179a2245ull,
+    0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull, 0x83c7088e1aab65dbull, 0xc45d1df942711d9aull,
+    0x924d692ca61be758ull, 0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+    0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull, 0x952ab45cfa97a0b3ull,
+    0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull, 0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull,
+    0x88fcf317f22241e2ull, 0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+    0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull, 0x8bab8eefb6409c1aull,
+    0xd01fef10a657842cull, 0x9b10a4e5e9913129ull, 0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull,
+    0x80444b5e7aa7cf85ull, 0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+    0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull,
+};
+
+static const int16_t cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+// returns the cached power of ten that brings a number with binary
+// exponent e into the range the digit generation works in.
+static inline b_diy_fp cached_power(int e, int *k) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int ik = (int) dk;
+  if (dk - ik > 0.0) ik++;
+
+  unsigned index = (unsigned) ((ik >> 3) + 1);
+  *k = -(-348 + (int) (index << 3)); // the decimal exponent of the power
+  b_diy_fp fp = {cached_powers_f[index], cached_powers_e[index]};
+  return fp;
+}
+
+static const uint64_t pow10_64[] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+static inline int count_decimal_digits(uint32_t n) {
+  int digits = 1;
+  while (digits < 10 && n >= pow10_64[digits]) digits++;
+  return digits;
+}
+
+// moves the last digit of buffer towards w while it stays inside the unsafe
+// interval. returns false if the digits cannot be proven to be the closest
+// shortest ones because of the imprecision of w, which is unit at most.
+static inline bool round_weed(char *buffer, int length,
+                              uint64_t distance_too_high_w,
+                              uint64_t unsafe_interval, uint64_t rest,
+                              uint64_t ten_kappa, uint64_t unit) {
+  uint64_t small_distance = distance_too_high_w - unit;
+  uint64_t big_distance = distance_too_high_w + unit;
+
+  while (rest < small_distance && unsafe_interval - rest >= ten_kappa &&
+         (rest + ten_kappa < small_distance ||
+          small_distance - rest >= rest + ten_kappa - small_distance)) {
+    buffer[length - 1]--;
+    rest += ten_kappa;
+  }
+
+  // another digit could be closer to the upper end of w's range.
+  if (rest < big_distance && unsafe_interval - rest >= ten_kappa &&
+      (rest + ten_kappa < big_distance ||
+       big_distance - rest > rest + ten_kappa - big_distance)) {
+    return false;
+  }
+
+  // the digits must be inside the safe interval.
+  return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+// generates the digits of w between the boundaries low and high, which are
+// widened by the error of their multiplication so that any number inside
+// them is certain to read back as the same double.
+static inline bool digit_gen(b_diy_fp low, b_diy_fp w, b_diy_fp high,
+                             char *buffer, int *length, int *k) {
+  uint64_t unit = 1;
+  b_diy_fp too_low = {low.f - unit, low.e};
+  b_diy_fp too_high = {high.f + unit, high.e};
+  uint64_t unsafe_interval = too_high.f - too_low.f;
+
+  b_diy_fp one = {1ull << -w.e, w.e};
+  uint32_t p1 = (uint32_t) (too_high.f >> -one.e);
+  uint64_t p2 = too_high.f & (one.f - 1);
+  int kappa = count_decimal_digits(p1);
+  *length = 0;
+
+  while (kappa > 0) {
+    uint32_t d = p1 / (uint32_t) pow10_64[kappa - 1];
+    p1 %= (uint32_t) pow10_64[kappa - 1];
+    if (d || *length) buffer[(*length)++] = (char) ('0' + d);
+    kappa--;
+
+    uint64_t rest = ((uint64_t) p1 << -one.e) + p2;
+    if (rest < unsafe_interval) {
+      *k += kappa;
+      return round_weed(buffer, *length, too_high.f - w.f, unsafe_interval,
+                        rest, pow10_64[kappa] << -one.e, unit);
+    }
+  }
+
+  for (;;) {
+    p2 *= 10;
+    unit *= 10;
+    unsafe_interval *= 10;
+    buffer[(*length)++] = (char) ('0' + (p2 >> -one.e));
+    p2 &= one.f - 1;
+    kappa--;
+    if (p2 < unsafe_interval) {
+      *k += kappa;
+      return round_weed(buffer, *length, (too_high.f - w.f) * unit,
+                        unsafe_interval, p2, one.f, unit);
+    }
+  }
+}
+
+// writes the shortest digits of a positive finite value that read back as
+// the same double into buffer and stores their count in length. the value
+// is digits * 10^k. returns false in the rare cases where that cannot be
+// proven.
+static bool grisu3(double value, char *buffer, int *length, int *k) {
+  b_diy_fp v = diy_fp_of(value), minus, plus;
+  diy_fp_boundaries(v, &minus, &plus);
+
+  b_diy_fp c = cached_power(plus.e, k);
+  b_diy_fp w = diy_fp_multiply(diy_fp_normalize(v), c);
+  b_diy_fp wp = diy_fp_multiply(plus, c);
+  b_diy_fp wm = diy_fp_multiply(minus, c);
+
+  return digit_gen(wm, w, wp, buffer, length, k);
+}
+
+// reads the digits and exponent of text written by "%.*e" into buffer and k
+// and returns the count of the digits.
+static int scientific_digits(const char *text, char *buffer, int *k) {
+  int length = 0;
+  for (; *text != 'e'; text++) {
+    if (*text != '.') buffer[length++] = *text;
+  }
+  *k = atoi(text + 1) - (length - 1);
+  return length;
+}
+
+// adds one to the last of the digits. returns true if that carried out of
+// the first digit, which leaves the digits as 10...0 of the same length.
+static bool increment_digits(char *buffer, int length) {
+  for (int i = length - 1; i >= 0; i--) {
+    if (buffer[i] != '9') {
+      buffer[i]++;
+      return false;
+    }
+    buffer[i] = '0';
+  }
+  buffer[0] = '1';
+  return true;
+}
+
+// finds the shortest digits of value that read back as the same double
+// from the correctly rounded output of snprintf(). it is only used where
+// grisu3() fails, which is well under 1% of doubles.
+static int shortest_digits(double value, char *buffer, int *k) {
+  char text[NUMBER_STRING_MAX];
+  int length = 0;
+
+  for (int precision = 1; precision <= 17; precision++) {
+    snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+    double read = strtod(text, NULL);
+    length = scientific_digits(text, buffer, k);
+    if (read == value) {
+      break;
+    }
+
+    // when the neighbour below is closer than the one above, the number
+    // with these many digits just above value may read back as value even
+    // though the nearest one below does not.
+    if (read < value) {
+      if (increment_digits(buffer, length)) {
+        (*k)++;
+      }
+
+      char *end = text;
+      *end++ = buffer[0];
+      *end++ = '.';
+      memcpy(end, buffer + 1, length - 1);
+      end += length - 1;
+      snprintf(end, sizeof(text) - (end - text), "e%d", *k + length - 1);
+      if (strtod(text, NULL) == value) {
+        break;
+      }
+    }
+  }
+
+  // 17 digits always read back, and a carry may leave zeros at the end.
+  while (length > 1 && buffer[length - 1] == '0') {
+    length--;
+    (*k)++;
+  }
+  return length;
+}
+
+static inline int write_uint(char *buffer, uint64_t n) {
+  char digits[20];
+  int length = 0;
+  do {
+    digits[length++] = (char) ('0' + n % 10);
+    n /= 10;
+  } while (n > 0);
+
+  for (int i = 0; i < length; i++) {
+    buffer[i] = digits[length - 1 - i];
+  }
+  return length;
+}
+
+int format_number(char *buffer, double number) {
+  char *start = buffer;
+
+  if (isnan(number)) {
+    memcpy(buffer, "nan", 4);
+    return 3;
+  }
+  if (signbit(number)) {
+    *buffer++ = '-';
+    number = -number;
+  }
+  if (isinf(number)) {
+    memcpy(buffer, "inf", 4);
+    return (int) (buffer - start) + 3;
+  }
+
+  // counters, ids and indexes are the usual case.
+  if (number < 9007199254740992.0 && number == (double) (uint64_t) number) {
+    buffer += write_uint(buffer, (uint64_t) number);
+    *buffer = '\0';
+    return (int) (buffer - start);
+  }
+
+  char digits[18];
+  int k, length;
+  if (!grisu3(number, digits, &length, &k)) {
+    length = shortest_digits(number, digits, &k);
+  }
+  int exponent = length + k - 1; // of the first digit
+
+  if (exponent >= -4 && exponent < 16) {
+    if (exponent >= length - 1) {
+      // an integer at least 2^53
+      memcpy(buffer, digits, length);
+      memset(buffer + length, '0', exponent - length + 1);
+      buffer += exponent + 1;
+    } else if (exponent >= 0) {
+      memcpy(buffer, digits, exponent + 1);
+      buffer[exponent + 1] = '.';
+      memcpy(buffer + exponent + 2, digits + exponent + 1,
+             length - exponent - 1);
+      buffer += length + 1;
+    } else {
+      buffer[0] = '0';
+      buffer[1] = '.';
+      memset(buffer + 2, '0', -exponent - 1);
+      memcpy(buffer + 1 - exponent, digits, length);
+      buffer += length + 1 - exponent;
+    }
+  } else {
+    *buffer++ = digits[0];
+    if (length > 1) {
+      *buffer++ = '.';
+      memcpy(buffer, digits + 1, length - 1);
+      buffer += length - 1;
+    }
+
+    *buffer++ = 'e';
+    *buffer++ = exponent < 0 ? '-' : '+';
+    int magnitude = exponent < 0 ? -exponent : exponent;
+    if (magnitude < 10) *buffer++ = '0';
+    buffer += write_uint(buffer, (uint64_t) magnitude);
+  }
+
+  *buffer = '\0';
+  return (int) (buffer - start);
+}
+
+static const double pow10_exact[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+double parse_number(const char *s, char **end) {
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD != 0
+  // the fast path relies on doubles being rounded as doubles.
+  return strtod(s, end);
+#else
+  const char *p = s;
+  while (isspace((unsigned char) *p)) p++;
+
+  bool negative = *p == '-';
+  if (*p == '-' || *p == '+') p++;
+
+  // leave hex, inf and nan to strtod.
+  if (!isdigit((unsigned char) *p) &&
+      !(*p == '.' && isdigit((unsigned char) p[1]))) {
+    return strtod(s, end);
+  }
+  if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+    return strtod(s, end);
+  }
+
+  uint64_t mantissa = 0;
+  int digits = 0, exponent = 0;
+
+  while (*p == '0') p++;
+  for (; isdigit((unsigned char) *p); p++, digits++) {
+    mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+  }
+
+  if (*p == '.') {
+    p++;
+    if (mantissa == 0) {
+      for (; *p == '0'; p++) exponent--;
+    }
+    for (; isdigit((unsigned char) *p); p++, digits++, exponent--) {
+      mantissa = mantissa * 10 + (uint64_t) (*p - '0');
+    }
+  }
+
+  // the exponent only counts when digits follow it.
+  if (*p == 'e' || *p == 'E') {
+    const char *q = p + 1;
+    bool negative_exponent = *q == '-';
+    if (*q == '-' || *q == '+') q++;
+
+    if (isdigit((unsigned char) *q)) {
+      int value = 0;
+      for (; isdigit((unsigned char) *q); q++) {
+        if (value < 100000) value = value * 10 + (*q - '0');
+      }
+      exponent += negative_exponent ? -value : value;
+      p = q;
+    }
+  }
+
+  // beyond 19 digits the mantissa has overflowed.
+  if (mantissa != 0 && (digits > 19 || mantissa > (1ull << 53) ||
+                        exponent < -22 || exponent > 22)) {
+    return strtod(s, end);
+  }
+
+  if (end != NULL) *end = (char *) p;
+
+  // both the mantissa and the power of ten are exact so the one rounding
+  // of the multiply or divide gives the correctly rounded result.
+  double value = (double) mantissa;
+  if (mantissa != 0) {
+    value = exponent < 0 ? value / pow10_exact[-exponent]
+                         : value * pow10_exact[exponent];
+  }
+  return negative ? -value : value;
+#endif
+}
@@ -0,0 +1,33 @@
+#ifndef BLADE_NUMBER_H
+#define BLADE_NUMBER_H
+
+#include "common.h"
+
+/**
+ * conversions between numbers and their text.
+ *
+ * numbers are written with the fewest digits that read back as the same
+ * double (e.g. 0.1, 1e+21, 0.30000000000000004) using the Grisu3
+ * algorithm, falling back to an exact search with snprintf() for the few
+ * numbers it cannot prove, and integers below 2^53 are written directly. numbers with a
+ * decimal exponent from -4 to 15 are written in plain notation, the rest
+ * in scientific notation. neither direction depends on the locale.
+ */
+
+// large enough for any number including the sign, point and exponent.
+#define NUMBER_STRING_MAX 32
+
+/**
+ * writes number into buffer with a terminating NUL and returns its length
+ */
+int format_number(char *buffer, double number);
+
+/**
+ * reads a number from the start of s the way strtod() does and stores a
+ * pointer to the first character after it in end if end is not NULL.
+ * plain decimal numbers that fit in a double exactly are read directly,
+ * anything else is left to strtod()
+ */
+double parse_number(const char *s, char **end);
+
+#endif
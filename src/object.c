@@ -1,5 +1,7 @@
 #include "object.h"
+#include "blade_array.h"
 #include "memory.h"
+#include "number.h"
 #include "table.h"
 #include "util.h"
 #include "value.h"
@@ -51,6 +53,8 @@ b_obj_switch *new_switch(b_vm *vm) {
 b_obj_bytes *new_bytes(b_vm *vm, int length) {
   b_obj_bytes *bytes = ALLOCATE_OBJ(b_obj_bytes, OBJ_BYTES);
   init_byte_arr(&bytes->bytes, length);
+  bytes->parent = NULL;
+  bytes->is_mapped = false;
   return bytes;
 }
 
@@ -63,7 +67,8 @@ b_obj_list *new_list(b_vm *vm) {
 b_obj_dict *new_dict(b_vm *vm) {
   b_obj_dict *dict = ALLOCATE_OBJ(b_obj_dict, OBJ_DICT);
   init_value_arr(&dict->names);
-  init_table(&dict->items);
+  init_value_arr(&dict->values);
+  init_table(&dict->indices);
   return dict;
 }
 
@@ -73,9 +78,62 @@ b_obj_file *new_file(b_vm *vm, b_obj_string *path, b_obj_string *mode) {
   file->mode = mode;
   file->path = path;
   file->file = NULL;
+  file->buffered = false;
+  file->buffer = NULL;
+  file->buffer_start = 0;
+  file->buffer_end = 0;
+  file->line = NIL_VAL;
+  file->write_buffer = NULL;
+  file->write_buffer_size = FILE_WRITE_BUFFER_SIZE;
   return file;
 }
 
+b_obj_array *new_array(b_vm *vm, b_array_type type, int length) {
+  // the buffer is allocated first as it is not an object the gc can
+  // collect while the array itself is being allocated.
+  size_t size = ARRAY_ELEMENT_SIZE(type) * (size_t) length;
+  void *data = reallocate(vm, NULL, 0, size);
+  if (size > 0) memset(data, 0, size);
+
+  b_obj_array *array = ALLOCATE_OBJ(b_obj_array, OBJ_ARRAY);
+  array->type = type;
+  array->length = length;
+  array->data = data;
+  return array;
+}
+
+b_obj_set *new_set(b_vm *vm) {
+  b_obj_set *set = ALLOCATE_OBJ(b_obj_set, OBJ_SET);
+  init_table(&set->items);
+  return set;
+}
+
+b_obj_deque *new_deque(b_vm *vm) {
+  b_obj_deque *deque = ALLOCATE_OBJ(b_obj_deque, OBJ_DEQUE);
+  deque->head = 0;
+  deque->count = 0;
+  deque->capacity = 0;
+  deque->values = NULL;
+  return deque;
+}
+
+b_obj_heap *new_heap(b_vm *vm, b_value comparator) {
+  b_obj_heap *heap = ALLOCATE_OBJ(b_obj_heap, OBJ_HEAP);
+  heap->comparator = comparator;
+  init_value_arr(&heap->values);
+  init_value_arr(&heap->keys);
+  heap->busy = false;
+  return heap;
+}
+
+static const char *array_type_name(b_array_type type) {
+  switch (type) {
+    case ARRAY_FLOAT64: return "Float64Array";
+    case ARRAY_INT32: return "Int32Array";
+    default: return "UInt8Array";
+  }
+}
+
 b_obj_bound *new_bound_method(b_vm *vm, b_value receiver, b_obj *method) {
   b_obj_bound *bound = ALLOCATE_OBJ(b_obj_bound, OBJ_BOUND_METHOD);
   bound->receiver = receiver;
@@ -140,13 +198,60 @@ b_obj_closure *new_closure(b_vm *vm, b_obj_func *function) {
   return closure;
 }
 
-b_obj_string *allocate_string(b_vm *vm, char *chars, int length,
-                              uint32_t hash) {
-  b_obj_string *string = ALLOCATE_OBJ(b_obj_string, OBJ_STRING);
-  string->chars = chars;
+// a code point starts at every byte that is not a continuation byte.
+#define IS_CODE_POINT_START(c) (((c) & 0xC0) != 0x80)
+
+static int count_code_points(const char *chars, int length) {
+  int count = 0;
+  for (int i = 0; i < length; i++) {
+    if (IS_CODE_POINT_START(chars[i]))
+      count++;
+  }
+  return count;
+}
+
+static b_obj_string *allocate_string(b_vm *vm, const char *chars, int length,
+                                     uint32_t hash, bool intern, bool take) {
+  b_obj_string *string;
+
+  if (length <= MAX_INLINE_STRING_LENGTH) {
+    // small strings live right after the header in the same allocation.
+    string = (b_obj_string *) allocate_object(
+        vm, sizeof(b_obj_string) + (size_t) length + 1, OBJ_STRING);
+    memcpy(string->inline_chars, chars, length);
+    string->inline_chars[length] = '\0';
+    string->chars = string->inline_chars;
+    string->is_inline = true;
+
+    if (take)
+      FREE_ARRAY(char, (char *) chars, (size_t) length + 1);
+  } else {
+    char *heap_chars = (char *) chars;
+    if (!take) {
+      heap_chars = ALLOCATE(char, (size_t) length + 1);
+      memcpy(heap_chars, chars, length);
+      heap_chars[length] = '\0';
+    }
+
+    string = ALLOCATE_OBJ(b_obj_string, OBJ_STRING);
+    string->chars = heap_chars;
+    string->is_inline = false;
+  }
+
   string->length = length;
-  string->utf8_length = utf8len(chars);
+  string->is_interned = intern;
+  string->is_hashed = intern;
   string->hash = hash;
+  string->parent = NULL;
+  string->utf8_index = NULL;
+
+  if (!intern) {
+    // computed on demand by string_utf8_length()
+    string->utf8_length = -1;
+    return string;
+  }
+
+  string->utf8_length = count_code_points(string->chars, length);
 
   push(vm, OBJ_VAL(string)); // fixing gc corruption
   table_set(vm, &vm->strings, OBJ_VAL(string), NIL_VAL);
@@ -155,30 +260,135 @@ b_obj_string *allocate_string(b_vm *vm, char *chars, int length,
   return string;
 }
 
-b_obj_string *take_string(b_vm *vm, char *chars, int length) {
+static b_obj_string *make_string(b_vm *vm, const char *chars, int length,
+                                 bool take, bool intern) {
+  if (!intern) {
+    return allocate_string(vm, chars, length, 0, false, take);
+  }
+
   uint32_t hash = hash_string(chars, length);
 
   b_obj_string *interned = table_find_string(&vm->strings, chars, length, hash);
   if (interned != NULL) {
-    FREE_ARRAY(char, chars, (size_t) length + 1);
+    if (take)
+      FREE_ARRAY(char, (char *) chars, (size_t) length + 1);
     return interned;
   }
 
-  return allocate_string(vm, chars, length, hash);
+  return allocate_string(vm, chars, length, hash, true, take);
+}
+
+b_obj_string *take_string(b_vm *vm, char *chars, int length) {
+  return make_string(vm, chars, length, true,
+                     length <= MAX_INTERN_STRING_LENGTH);
 }
 
 b_obj_string *copy_string(b_vm *vm, const char *chars, int length) {
-  uint32_t hash = hash_string(chars, length);
+  return make_string(vm, chars, length, false,
+                     length <= MAX_INTERN_STRING_LENGTH);
+}
 
-  b_obj_string *interned = table_find_string(&vm->strings, chars, length, hash);
-  if (interned != NULL)
-    return interned;
+b_obj_string *take_interned_string(b_vm *vm, char *chars, int length) {
+  return make_string(vm, chars, length, true, true);
+}
 
-  char *heap_chars = ALLOCATE(char, (size_t) length + 1);
-  memcpy(heap_chars, chars, length);
-  heap_chars[length] = '\0';
+b_obj_string *copy_interned_string(b_vm *vm, const char *chars, int length) {
+  return make_string(vm, chars, length, false, true);
+}
 
-  return allocate_string(vm, heap_chars, length, hash);
+int string_utf8_length(b_obj_string *string) {
+  if (string->utf8_length < 0) {
+    string->utf8_length = count_code_points(string->chars, string->length);
+  }
+  return string->utf8_length;
+}
+
+static void build_utf8_index(b_vm *vm, b_obj_string *string) {
+  int entries = string_utf8_length(string) / UTF8_INDEX_STRIDE + 1;
+  int *index = ALLOCATE(int, entries);
+
+  for (int i = 0, code_point = 0; i < string->length; i++) {
+    if (IS_CODE_POINT_START(string->chars[i])) {
+      if (code_point % UTF8_INDEX_STRIDE == 0)
+        index[code_point / UTF8_INDEX_STRIDE] = i;
+      code_point++;
+    }
+  }
+
+  string->utf8_index = index;
+}
+
+// returns the byte offset of the index'th code point in the string or its
+// length when index is the number of code points. index must be in that range.
+int string_utf8_offset(b_vm *vm, b_obj_string *string, int index) {
+  int utf8_length = string_utf8_length(string);
+
+  // every byte starts a code point in ascii strings.
+  if (utf8_length == string->length)
+    return index;
+  if (index >= utf8_length)
+    return string->length;
+
+  int offset = 0, remaining = index;
+  if (index >= UTF8_INDEX_STRIDE) {
+    if (string->utf8_index == NULL)
+      build_utf8_index(vm, string);
+    offset = string->utf8_index[index / UTF8_INDEX_STRIDE];
+    remaining = index % UTF8_INDEX_STRIDE;
+  } else {
+    while (!IS_CODE_POINT_START(string->chars[offset]))
+      offset++;
+  }
+
+  while (remaining-- > 0) {
+    offset++;
+    while (!IS_CODE_POINT_START(string->chars[offset]))
+      offset++;
+  }
+  return offset;
+}
+
+// returns a string for the chars from offset to the end of string that
+// shares the buffer of string instead of copying it.
+b_obj_string *new_string_view(b_vm *vm, b_obj_string *string, int offset) {
+  b_obj_string *owner = string->parent != NULL ? string->parent : string;
+
+  push(vm, OBJ_VAL(string)); // fixing gc corruption
+  b_obj_string *view = ALLOCATE_OBJ(b_obj_string, OBJ_STRING);
+  pop(vm);
+
+  view->chars = string->chars + offset;
+  view->length = string->length - offset;
+  view->is_inline = false;
+  view->is_interned = false;
+  view->is_hashed = false;
+  view->hash = 0;
+  view->parent = owner;
+  view->utf8_index = NULL;
+  view->utf8_length =
+      string_utf8_length(string) == string->length ? view->length : -1;
+  return view;
+}
+
+uint32_t string_hash(b_obj_string *string) {
+  if (!string->is_hashed) {
+    string->hash = hash_string(string->chars, string->length);
+    string->is_hashed = true;
+  }
+  return string->hash;
+}
+
+bool strings_equal(b_obj_string *a, b_obj_string *b) {
+  if (a == b)
+    return true;
+
+  // two distinct interned strings can never be equal.
+  if ((a->is_interned && b->is_interned) || a->length != b->length)
+    return false;
+  if (a->is_hashed && b->is_hashed && a->hash != b->hash)
+    return false;
+
+  return memcmp(a->chars, b->chars, a->length) == 0;
 }
 
 b_obj_up_value *new_up_value(b_vm *vm, b_value *slot) {
@@ -224,23 +434,69 @@ static void print_bytes(b_obj_bytes *bytes) {
   printf(")");
 }
 
+static void print_array(b_obj_array *array) {
+  printf("%s(", array_type_name(array->type));
+  for (int i = 0; i < array->length; i++) {
+    char number[NUMBER_STRING_MAX];
+    format_number(number, array_get(array, i));
+    printf("%s", number);
+    if (i > 100) { // as arrays can get really heavy
+      printf("...");
+      break;
+    }
+
+    if (i != array->length - 1) {
+      printf(", ");
+    }
+  }
+  printf(")");
+}
+
 static void print_dict(b_obj_dict *dict) {
   printf("{");
+  bool is_first = true;
   for (int i = 0; i < dict->names.count; i++) {
-    print_value(dict->names.values[i]);
+    if (IS_EMPTY(dict->names.values[i]))
+      continue;
 
+    if (!is_first) {
+      printf(", ");
+    }
+    is_first = false;
+
+    print_value(dict->names.values[i]);
     printf(": ");
+    print_value(dict->values.values[i]);
+  }
+  printf("}");
+}
+
+static void print_set(b_obj_set *set) {
+  printf("Set(");
+  bool is_first = true;
+  for (int i = 0; i < set->items.capacity; i++) {
+    if (IS_EMPTY(set->items.entries[i].key))
+      continue;
 
-    b_value value;
-    if (table_get(&dict->items, dict->names.values[i], &value)) {
-      print_value(value);
+    if (!is_first) {
+      printf(", ");
     }
+    is_first = false;
+
+    print_value(set->items.entries[i].key);
+  }
+  printf(")");
+}
 
-    if (i != dict->names.count - 1) {
+static void print_deque(b_obj_deque *deque) {
+  printf("Deque(");
+  for (int i = 0; i < deque->count; i++) {
+    print_value(DEQUE_AT(deque, i));
+    if (i != deque->count - 1) {
       printf(", ");
     }
   }
-  printf("}");
+  printf(")");
 }
 
 static void print_file(b_obj_file *file) {
@@ -268,6 +524,22 @@ void print_object(b_value value, bool fix_string) {
       print_bytes(AS_BYTES(value));
       break;
     }
+    case OBJ_ARRAY: {
+      print_array(AS_ARRAY(value));
+      break;
+    }
+    case OBJ_SET: {
+      print_set(AS_SET(value));
+      break;
+    }
+    case OBJ_DEQUE: {
+      print_deque(AS_DEQUE(value));
+      break;
+    }
+    case OBJ_HEAP: {
+      printf("<heap of %d>", AS_HEAP(value)->values.count);
+      break;
+    }
 
     case OBJ_BOUND_METHOD: {
       b_obj *method = AS_BOUND(value)->method;
@@ -316,7 +588,7 @@ void print_object(b_value value, bool fix_string) {
       if (fix_string) {
         printf(strchr(string, '\'') != NULL ? "\"%s\"" : "'%s'", string);
       } else {
-        printf("%s", string);
+        fwrite(string, sizeof(char), AS_STRING(value)->length, stdout);
       }
       break;
     }
@@ -330,11 +602,87 @@ b_obj_bytes *copy_bytes(b_vm *vm, unsigned char *b, int length) {
 }
 
 b_obj_bytes *take_bytes(b_vm *vm, unsigned char *b, int length) {
-  b_obj_bytes *bytes = new_bytes(vm, length);
+  b_obj_bytes *bytes = new_bytes(vm, 0);
+  free(bytes->bytes.bytes);
   bytes->bytes.bytes = b;
+  bytes->bytes.count = length;
   return bytes;
 }
 
+/**
+ * returns bytes that share length bytes of the buffer of bytes
+ * starting at offset without copying them.
+ *
+ * the first time a bytes is sliced, its buffer is moved into a hidden
+ * bytes object that both it and the view point into. since all the
+ * sharing objects are then views, copy-on-write only ever needs to
+ * happen in make_bytes_writable().
+ */
+b_obj_bytes *new_bytes_view(b_vm *vm, b_obj_bytes *bytes, int offset,
+                            int length) {
+  if (bytes->parent == NULL) {
+    b_obj_bytes *owner = ALLOCATE_OBJ(b_obj_bytes, OBJ_BYTES);
+    owner->bytes = bytes->bytes;
+    owner->parent = NULL;
+    owner->is_mapped = false;
+    bytes->parent = owner;
+  }
+
+  b_obj_bytes *view = ALLOCATE_OBJ(b_obj_bytes, OBJ_BYTES);
+  view->bytes.bytes = bytes->bytes.bytes + offset;
+  view->bytes.count = length;
+  view->parent = bytes->parent;
+  view->is_mapped = false;
+  return view;
+}
+
+/**
+ * returns bytes backed by a read-only memory mapping of length bytes
+ * without copying them.
+ *
+ * the mapping belongs to a hidden bytes object that the returned bytes
+ * are a view of, so it is only unmapped once every view of it has been
+ * collected and is copied by make_bytes_writable() before a change.
+ */
+b_obj_bytes *new_mapped_bytes(b_vm *vm, unsigned char *mapping, int length) {
+  b_obj_bytes *owner = ALLOCATE_OBJ(b_obj_bytes, OBJ_BYTES);
+  owner->bytes.bytes = mapping;
+  owner->bytes.count = length;
+  owner->parent = NULL;
+  owner->is_mapped = true;
+
+  // mappings count towards the heap so that collections keep up with them.
+  vm->bytes_allocated += length;
+
+  push(vm, OBJ_VAL(owner));
+  b_obj_bytes *view = ALLOCATE_OBJ(b_obj_bytes, OBJ_BYTES);
+  view->bytes = owner->bytes;
+  view->parent = owner;
+  view->is_mapped = false;
+  pop(vm);
+  return view;
+}
+
+/**
+ * gives bytes its own buffer of length bytes before it is modified,
+ * copying the shared data if it is a view.
+ */
+void make_bytes_writable(b_vm *vm, b_obj_bytes *bytes, int length) {
+  if (bytes->parent == NULL) {
+    if (length != bytes->bytes.count) {
+      bytes->bytes.bytes = reallocate(vm, bytes->bytes.bytes,
+                                      bytes->bytes.count, length);
+    }
+    return;
+  }
+
+  unsigned char *buffer = reallocate(vm, NULL, 0, length);
+  memcpy(buffer, bytes->bytes.bytes,
+         length < bytes->bytes.count ? length : bytes->bytes.count);
+  bytes->bytes.bytes = buffer;
+  bytes->parent = NULL;
+}
+
 static inline char *function_to_string(b_obj_func *func) {
   if (func->name == NULL) {
     return strdup("<script 0x00>");
@@ -380,29 +728,94 @@ static inline char *bytes_to_string(b_vm *vm, b_byte_arr *array) {
   return str;
 }
 
+static char *array_to_string(b_obj_array *array) {
+  char *str = strdup(array_type_name(array->type));
+  str = append_strings(str, "(");
+  for (int i = 0; i < array->length; i++) {
+    char number[NUMBER_STRING_MAX];
+    format_number(number, array_get(array, i));
+    str = append_strings(str, number);
+
+    if (i != array->length - 1) {
+      str = append_strings(str, ", ");
+    }
+  }
+  str = append_strings(str, ")");
+  return str;
+}
+
 static char *dict_to_string(b_vm *vm, b_obj_dict *dict) {
   char *str = strdup("{");
+  bool is_first = true;
   for (int i = 0; i < dict->names.count; i++) {
-    // print_value(dict->names.values[i]);
     b_value key = dict->names.values[i];
+    if (IS_EMPTY(key))
+      continue;
+
+    if (!is_first) {
+      str = append_strings(str, ", ");
+    }
+    is_first = false;
+
     char *_key = value_to_string(vm, key);
     if (_key != NULL) {
       str = append_strings(str, _key);
     }
     str = append_strings(str, ": ");
 
-    b_value value;
-    table_get(&dict->items, key, &value);
-    char *val = value_to_string(vm, value);
+    char *val = value_to_string(vm, dict->values.values[i]);
     if (val != NULL) {
       str = append_strings(str, val);
     }
+  }
+  str = append_strings(str, "}");
+  return str;
+}
+
+static char *set_to_string(b_vm *vm, b_obj_set *set) {
+  char *str = strdup("Set(");
+  bool is_first = true;
+  for (int i = 0; i < set->items.capacity; i++) {
+    b_value key = set->items.entries[i].key;
+    if (IS_EMPTY(key))
+      continue;
 
-    if (i != dict->names.count - 1) {
+    if (!is_first) {
       str = append_strings(str, ", ");
     }
+    is_first = false;
+
+    char *item = value_to_string(vm, key);
+    if (item != NULL) {
+      str = append_strings(str, item);
+    }
+  }
+  str = append_strings(str, ")");
+  return str;
+}
+
+static char *deque_to_string(b_vm *vm, b_obj_deque *deque) {
+  char *str = strdup("Deque(");
+  for (int i = 0; i < deque->count; i++) {
+    char *item = value_to_string(vm, DEQUE_AT(deque, i));
+    if (item != NULL) {
+      str = append_strings(str, item);
+    }
+
+    if (i != deque->count - 1) {
+      str = append_strings(str, ", ");
+    }
+  }
+  str = append_strings(str, ")");
+  return str;
+}
+
+static char *heap_to_string(b_obj_heap *heap) {
+  int length = snprintf(NULL, 0, "<heap of %d>", heap->values.count);
+  char *str = (char *) malloc(sizeof(char) * (length + 1));
+  if (str != NULL) {
+    snprintf(str, length + 1, "<heap of %d>", heap->values.count);
   }
-  str = append_strings(str, "}");
   return str;
 }
 
@@ -450,6 +863,14 @@ char *object_to_string(b_vm *vm, b_value value) {
       return strdup("<up value>");
     case OBJ_BYTES:
       return bytes_to_string(vm, &AS_BYTES(value)->bytes);
+    case OBJ_ARRAY:
+      return array_to_string(AS_ARRAY(value));
+    case OBJ_SET:
+      return set_to_string(vm, AS_SET(value));
+    case OBJ_DEQUE:
+      return deque_to_string(vm, AS_DEQUE(value));
+    case OBJ_HEAP:
+      return heap_to_string(AS_HEAP(value));
     case OBJ_LIST:
       return list_to_string(vm, &AS_LIST(value)->items);
     case OBJ_DICT:
@@ -473,6 +894,18 @@ const char *object_type(b_obj *object) {
       return "switch";
     case OBJ_BYTES:
       return "bytes";
+    case OBJ_ARRAY:
+      switch (((b_obj_array *) object)->type) {
+        case ARRAY_FLOAT64: return "float64array";
+        case ARRAY_INT32: return "int32array";
+        default: return "uint8array";
+      }
+    case OBJ_SET:
+      return "set";
+    case OBJ_DEQUE:
+      return "deque";
+    case OBJ_HEAP:
+      return "heap";
     case OBJ_FILE:
       return "file";
     case OBJ_DICT:
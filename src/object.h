@@ -27,12 +27,18 @@ typedef enum {
 #define IS_CLASS(v) is_obj_type(v, OBJ_CLASS)
 #define IS_INSTANCE(v) is_obj_type(v, OBJ_INSTANCE)
 #define IS_BOUND(v) is_obj_type(v, OBJ_BOUND_METHOD)
+#define IS_CALLABLE(v)                                                         \
+  (IS_CLOSURE(v) || IS_FUNCTION(v) || IS_BOUND(v) || IS_NATIVE(v))
 
 // containers
 #define IS_BYTES(v) is_obj_type(v, OBJ_BYTES)
 #define IS_LIST(v) is_obj_type(v, OBJ_LIST)
 #define IS_DICT(v) is_obj_type(v, OBJ_DICT)
 #define IS_FILE(v) is_obj_type(v, OBJ_FILE)
+#define IS_ARRAY(v) is_obj_type(v, OBJ_ARRAY)
+#define IS_SET(v) is_obj_type(v, OBJ_SET)
+#define IS_DEQUE(v) is_obj_type(v, OBJ_DEQUE)
+#define IS_HEAP(v) is_obj_type(v, OBJ_HEAP)
 
 // promote b_value to object
 #define AS_STRING(v) ((b_obj_string *)AS_OBJ(v))
@@ -54,6 +60,10 @@ typedef enum {
 #define AS_LIST(v) ((b_obj_list *)AS_OBJ(v))
 #define AS_DICT(v) ((b_obj_dict *)AS_OBJ(v))
 #define AS_FILE(v) ((b_obj_file *)AS_OBJ(v))
+#define AS_ARRAY(v) ((b_obj_array *)AS_OBJ(v))
+#define AS_SET(v) ((b_obj_set *)AS_OBJ(v))
+#define AS_DEQUE(v) ((b_obj_deque *)AS_OBJ(v))
+#define AS_HEAP(v) ((b_obj_heap *)AS_OBJ(v))
 
 // demote blade value to c string
 #define AS_C_STRING(v) (((b_obj_string *)AS_OBJ(v))->chars)
@@ -76,6 +86,10 @@ typedef enum {
   OBJ_LIST,
   OBJ_DICT,
   OBJ_FILE,
+  OBJ_ARRAY,
+  OBJ_SET,
+  OBJ_DEQUE,
+  OBJ_HEAP,
 
   // non-user objects
   OBJ_MODULE,
@@ -90,10 +104,19 @@ struct s_obj {
 
 struct s_obj_string {
   b_obj obj;
+  bool is_interned;
+  bool is_hashed;
+  bool is_inline;
   int length;
-  int utf8_length;
-  char *chars;
+  int utf8_length; // -1 until computed
+  char *chars; // points to inline_chars for small strings
   uint32_t hash;
+  // for substring views, the string whose buffer chars points into.
+  struct s_obj_string *parent;
+  // byte offsets of every UTF8_INDEX_STRIDE'th code point. built on first
+  // index into a non-ascii string.
+  int *utf8_index;
+  char inline_chars[];
 };
 
 typedef struct b_obj_up_value {
@@ -165,25 +188,99 @@ typedef struct {
   b_value_arr items;
 } b_obj_list;
 
-typedef struct {
+typedef struct s_obj_bytes {
   b_obj obj;
   b_byte_arr bytes;
+  // views point into the buffer of another bytes object which is kept
+  // here so that the gc keeps it alive. NULL if the bytes own their buffer.
+  struct s_obj_bytes *parent;
+  // true if the buffer is a memory mapping to unmap rather than free.
+  bool is_mapped;
 } b_obj_bytes;
 
+// dictionaries keep their keys and values in dense arrays in insertion
+// order and map each key to its position through a table. removed
+// entries leave an EMPTY_VAL key behind until the dictionary is compacted.
 typedef struct {
   b_obj obj;
   b_value_arr names;
-  b_table items;
+  b_value_arr values;
+  b_table indices;
 } b_obj_dict;
 
+#define DICT_LENGTH(dict) ((dict)->indices.count)
+
 typedef struct {
   b_obj obj;
   bool is_open;
   b_obj_string *mode;
   b_obj_string *path;
   FILE *file;
+
+  // data read ahead of the position of the file by the line and chunk
+  // readers. buffered is true while they, not stdio, own that position.
+  bool buffered;
+  unsigned char *buffer;
+  int buffer_start;
+  int buffer_end;
+
+  // the line read by @itern() for @iter() to return.
+  b_value line;
+
+  // the stdio buffer of writable files. writes stay in it until it is
+  // full or the file is flushed, closed or collected.
+  char *write_buffer;
+  int write_buffer_size;
 } b_obj_file;
 
+typedef enum {
+  ARRAY_FLOAT64,
+  ARRAY_INT32,
+  ARRAY_UINT8,
+} b_array_type;
+
+// typed arrays keep their numbers unboxed in one contiguous buffer.
+typedef struct {
+  b_obj obj;
+  b_array_type type;
+  int length;
+  void *data;
+} b_obj_array;
+
+#define ARRAY_ELEMENT_SIZE(type)                                               \
+  ((type) == ARRAY_FLOAT64 ? sizeof(double)                                    \
+                           : ((type) == ARRAY_INT32 ? sizeof(int32_t)          \
+                                                    : sizeof(uint8_t)))
+
+// sets keep their members as the keys of a table. the values are unused.
+typedef struct {
+  b_obj obj;
+  b_table items;
+} b_obj_set;
+
+// deques keep their items in a ring buffer whose capacity is zero or a
+// power of two so that positions wrap around with a mask.
+typedef struct {
+  b_obj obj;
+  int head; // the position of the first item in values
+  int count;
+  int capacity;
+  b_value *values;
+} b_obj_deque;
+
+#define DEQUE_AT(deque, index)                                                 \
+  ((deque)->values[((deque)->head + (index)) & ((deque)->capacity - 1)])
+
+// binary min-heaps ordered either by a comparator function or by the key
+// of each value, which is its priority or the value itself.
+typedef struct {
+  b_obj obj;
+  b_value comparator; // nil when ordering by key
+  b_value_arr values;
+  b_value_arr keys; // empty when there is a comparator
+  bool busy; // set while the comparator runs so it cannot change the heap
+} b_obj_heap;
+
 typedef struct {
   b_obj obj;
   b_table table;
@@ -203,6 +300,14 @@ b_obj_dict *new_dict(b_vm *vm);
 
 b_obj_file *new_file(b_vm *vm, b_obj_string *path, b_obj_string *mode);
 
+b_obj_array *new_array(b_vm *vm, b_array_type type, int length);
+
+b_obj_set *new_set(b_vm *vm);
+
+b_obj_deque *new_deque(b_vm *vm);
+
+b_obj_heap *new_heap(b_vm *vm, b_value comparator);
+
 // base objects
 b_obj_bound *new_bound_method(b_vm *vm, b_value receiver, b_obj *method);
 
@@ -222,6 +327,20 @@ b_obj_string *copy_string(b_vm *vm, const char *chars, int length);
 
 b_obj_string *take_string(b_vm *vm, char *chars, int length);
 
+b_obj_string *copy_interned_string(b_vm *vm, const char *chars, int length);
+
+b_obj_string *take_interned_string(b_vm *vm, char *chars, int length);
+
+int string_utf8_length(b_obj_string *string);
+
+int string_utf8_offset(b_vm *vm, b_obj_string *string, int index);
+
+b_obj_string *new_string_view(b_vm *vm, b_obj_string *string, int offset);
+
+uint32_t string_hash(b_obj_string *string);
+
+bool strings_equal(b_obj_string *a, b_obj_string *b);
+
 void print_object(b_value value, bool fix_string);
 
 const char *object_type(b_obj *object);
@@ -232,6 +351,13 @@ b_obj_bytes *copy_bytes(b_vm *vm, unsigned char *b, int length);
 
 b_obj_bytes *take_bytes(b_vm *vm, unsigned char *b, int length);
 
+b_obj_bytes *new_bytes_view(b_vm *vm, b_obj_bytes *bytes, int offset,
+                            int length);
+
+void make_bytes_writable(b_vm *vm, b_obj_bytes *bytes, int length);
+
+b_obj_bytes *new_mapped_bytes(b_vm *vm, unsigned char *mapping, int length);
+
 static inline bool is_obj_type(b_value v, b_obj_type t) {
   return IS_OBJ(v) && AS_OBJ(v)->type == t;
 }
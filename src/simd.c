@@ -0,0 +1,430 @@
+#include "simd.h"
+
+#include <string.h>
+
+#if USE_SIMD && (defined(__SSE2__) || defined(_M_X64) ||                       \
+                 (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HAS_SSE2 1
+#include <emmintrin.h>
+#else
+#define HAS_SSE2 0
+#endif
+
+// the avx2 kernels are compiled for avx2 regardless of the build flags
+// and only called once the cpu is known to support it.
+#if HAS_SSE2 && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAS_AVX2 1
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define HAS_AVX2 0
+#endif
+
+#if HAS_SSE2 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if HAS_SSE2
+static inline int first_bit(uint32_t mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (int) index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+#if HAS_AVX2
+static bool cpu_has_avx2(void) {
+  static int supported = -1;
+  if (supported < 0) {
+    __builtin_cpu_init();
+    supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+  return supported == 1;
+}
+#endif
+
+static inline bool ascii_in_class(unsigned char c, b_ascii_class type) {
+  switch (type) {
+    case ASCII_ALPHA: return (unsigned char) ((c | 0x20) - 'a') < 26;
+    case ASCII_ALNUM:
+      return (unsigned char) ((c | 0x20) - 'a') < 26 ||
+             (unsigned char) (c - '0') < 10;
+    case ASCII_DIGIT: return (unsigned char) (c - '0') < 10;
+    case ASCII_LOWER: return (unsigned char) (c - 'a') < 26;
+    case ASCII_UPPER: return (unsigned char) (c - 'A') < 26;
+    default: return c == ' ' || (unsigned char) (c - '\t') < 5;
+  }
+}
+
+// substring search compares the first and last bytes of the needle against
+// a block of candidate positions at once and only runs memcmp() on the
+// positions where both match.
+// see: http://0x80.pl/articles/simd-strfind.html
+
+#if HAS_AVX2
+AVX2_TARGET
+static const char *find_bytes_avx2(const char *haystack, int last,
+                                   const char *needle, int needle_length,
+                                   int *position) {
+  __m256i first = _mm256_set1_epi8(needle[0]);
+  __m256i final = _mm256_set1_epi8(needle[needle_length - 1]);
+
+  int i = *position;
+  while (i + 31 <= last) {
+    // skip two blocks per iteration while neither has a candidate.
+    for (; i + 63 <= last; i += 64) {
+      const char *p = haystack + i;
+      __m256i a = _mm256_and_si256(
+          _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *) p)),
+          _mm256_cmpeq_epi8(final, _mm256_loadu_si256(
+              (const __m256i *) (p + needle_length - 1))));
+      __m256i b = _mm256_and_si256(
+          _mm256_cmpeq_epi8(first,
+                            _mm256_loadu_si256((const __m256i *) (p + 32))),
+          _mm256_cmpeq_epi8(final, _mm256_loadu_si256(
+              (const __m256i *) (p + 32 + needle_length - 1))));
+      __m256i any = _mm256_or_si256(a, b);
+      if (!_mm256_testz_si256(any, any))
+        break;
+    }
+
+    for (int stop = i + 64; i + 31 <= last && i < stop; i += 32) {
+      __m256i block_first =
+          _mm256_loadu_si256((const __m256i *) (haystack + i));
+      __m256i block_last = _mm256_loadu_si256(
+          (const __m256i *) (haystack + i + needle_length - 1));
+      uint32_t mask = (uint32_t) _mm256_movemask_epi8(
+          _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                           _mm256_cmpeq_epi8(final, block_last)));
+
+      while (mask != 0) {
+        int candidate = i + first_bit(mask);
+        if (memcmp(haystack + candidate + 1, needle + 1,
+                   needle_length - 2) == 0)
+          return haystack + candidate;
+        mask &= mask - 1;
+      }
+    }
+  }
+
+  *position = i;
+  return NULL;
+}
+#endif
+
+#if HAS_SSE2
+static const char *find_bytes_sse2(const char *haystack, int last,
+                                   const char *needle, int needle_length,
+                                   int *position) {
+  __m128i first = _mm_set1_epi8(needle[0]);
+  __m128i final = _mm_set1_epi8(needle[needle_length - 1]);
+
+  int i = *position;
+  for (; i + 15 <= last; i += 16) {
+    __m128i block_first = _mm_loadu_si128((const __m128i *) (haystack + i));
+    __m128i block_last = _mm_loadu_si128(
+        (const __m128i *) (haystack + i + needle_length - 1));
+    uint32_t mask = (uint32_t) _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                      _mm_cmpeq_epi8(final, block_last)));
+
+    while (mask != 0) {
+      int candidate = i + first_bit(mask);
+      if (memcmp(haystack + candidate + 1, needle + 1, needle_length - 2) == 0)
+        return haystack + candidate;
+      mask &= mask - 1;
+    }
+  }
+
+  *position = i;
+  return NULL;
+}
+#endif
+
+const char *find_bytes(const char *haystack, int haystack_length,
+                       const char *needle, int needle_length) {
+  if (needle_length == 0)
+    return haystack;
+  if (needle_length > haystack_length)
+    return NULL;
+  if (needle_length == 1)
+    return memchr(haystack, needle[0], haystack_length);
+
+  // the last position the needle can start at.
+  int last = haystack_length - needle_length;
+  int i = 0;
+
+#if HAS_AVX2
+  if (cpu_has_avx2()) {
+    const char *found =
+        find_bytes_avx2(haystack, last, needle, needle_length, &i);
+    if (found != NULL)
+      return found;
+  }
+#endif
+#if HAS_SSE2
+  const char *found = find_bytes_sse2(haystack, last, needle, needle_length, &i);
+  if (found != NULL)
+    return found;
+#endif
+
+  for (; i <= last; i++) {
+    if (haystack[i] == needle[0] &&
+        memcmp(haystack + i + 1, needle + 1, needle_length - 1) == 0)
+      return haystack + i;
+  }
+  return NULL;
+}
+
+// sets of up to four bytes are compared against whole blocks. larger sets
+// fall back to a lookup table.
+#define MAX_VECTOR_SET_LENGTH 4
+
+#if HAS_AVX2
+AVX2_TARGET
+static const char *find_any_byte_avx2(const char *s, int length,
+                                      const char *set, int *position) {
+  __m256i a = _mm256_set1_epi8(set[0]), b = _mm256_set1_epi8(set[1]);
+  __m256i c = _mm256_set1_epi8(set[2]), d = _mm256_set1_epi8(set[3]);
+
+  int i = *position;
+  for (; i + 32 <= length; i += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *) (s + i));
+    __m256i matches = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, a), _mm256_cmpeq_epi8(block, b)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, c), _mm256_cmpeq_epi8(block, d)));
+    uint32_t mask = (uint32_t) _mm256_movemask_epi8(matches);
+    if (mask != 0)
+      return s + i + first_bit(mask);
+  }
+
+  *position = i;
+  return NULL;
+}
+#endif
+
+#if HAS_SSE2
+static const char *find_any_byte_sse2(const char *s, int length,
+                                      const char *set, int *position) {
+  __m128i a = _mm_set1_epi8(set[0]), b = _mm_set1_epi8(set[1]);
+  __m128i c = _mm_set1_epi8(set[2]), d = _mm_set1_epi8(set[3]);
+
+  int i = *position;
+  for (; i + 16 <= length; i += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *) (s + i));
+    __m128i matches = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, a), _mm_cmpeq_epi8(block, b)),
+        _mm_or_si128(_mm_cmpeq_epi8(block, c), _mm_cmpeq_epi8(block, d)));
+    uint32_t mask = (uint32_t) _mm_movemask_epi8(matches);
+    if (mask != 0)
+      return s + i + first_bit(mask);
+  }
+
+  *position = i;
+  return NULL;
+}
+#endif
+
+const char *find_any_byte(const char *s, int length, const char *set,
+                          int set_length) {
+  if (set_length == 0 || length == 0)
+    return NULL;
+  if (set_length == 1)
+    return memchr(s, set[0], length);
+
+  int i = 0;
+
+#if HAS_SSE2
+  if (set_length <= MAX_VECTOR_SET_LENGTH) {
+    // repeat the first byte to fill the unused slots.
+    char padded[MAX_VECTOR_SET_LENGTH];
+    for (int j = 0; j < MAX_VECTOR_SET_LENGTH; j++)
+      padded[j] = set[j < set_length ? j : 0];
+
+#if HAS_AVX2
+    if (cpu_has_avx2()) {
+      const char *found = find_any_byte_avx2(s, length, padded, &i);
+      if (found != NULL)
+        return found;
+    }
+#endif
+    const char *found = find_any_byte_sse2(s, length, padded, &i);
+    if (found != NULL)
+      return found;
+  }
+#endif
+
+  bool in_set[UINT8_COUNT] = {false};
+  for (int j = 0; j < set_length; j++)
+    in_set[(unsigned char) set[j]] = true;
+
+  for (; i < length; i++) {
+    if (in_set[(unsigned char) s[i]])
+      return s + i;
+  }
+  return NULL;
+}
+
+// case conversion flips bit 0x20 of every byte between low and high.
+// bytes above 0x7f are negative as signed chars and never in range.
+
+#if HAS_AVX2
+AVX2_TARGET
+static int convert_case_avx2(char *destination, const char *s, int length,
+                             char low, char high) {
+  __m256i below = _mm256_set1_epi8((char) (low - 1));
+  __m256i above = _mm256_set1_epi8((char) (high + 1));
+  __m256i flip = _mm256_set1_epi8(0x20);
+
+  int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *) (s + i));
+    __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(block, below),
+                                        _mm256_cmpgt_epi8(above, block));
+    _mm256_storeu_si256(
+        (__m256i *) (destination + i),
+        _mm256_xor_si256(block, _mm256_and_si256(in_range, flip)));
+  }
+  return i;
+}
+#endif
+
+#if HAS_SSE2
+static int convert_case_sse2(char *destination, const char *s, int length,
+                             int start, char low, char high) {
+  __m128i below = _mm_set1_epi8((char) (low - 1));
+  __m128i above = _mm_set1_epi8((char) (high + 1));
+  __m128i flip = _mm_set1_epi8(0x20);
+
+  int i = start;
+  for (; i + 16 <= length; i += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *) (s + i));
+    __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(block, below),
+                                     _mm_cmplt_epi8(block, above));
+    _mm_storeu_si128((__m128i *) (destination + i),
+                     _mm_xor_si128(block, _mm_and_si128(in_range, flip)));
+  }
+  return i;
+}
+#endif
+
+static void convert_case(char *destination, const char *s, int length,
+                         char low, char high) {
+  int i = 0;
+#if HAS_AVX2
+  if (cpu_has_avx2())
+    i = convert_case_avx2(destination, s, length, low, high);
+#endif
+#if HAS_SSE2
+  i = convert_case_sse2(destination, s, length, i, low, high);
+#endif
+
+  for (; i < length; i++) {
+    char c = s[i];
+    destination[i] = c >= low && c <= high ? (char) (c ^ 0x20) : c;
+  }
+}
+
+void ascii_to_upper(char *destination, const char *s, int length) {
+  convert_case(destination, s, length, 'a', 'z');
+}
+
+void ascii_to_lower(char *destination, const char *s, int length) {
+  convert_case(destination, s, length, 'A', 'Z');
+}
+
+#if HAS_AVX2
+AVX2_TARGET
+static inline __m256i in_range_avx2(__m256i block, char low, char high) {
+  return _mm256_and_si256(
+      _mm256_cmpgt_epi8(block, _mm256_set1_epi8((char) (low - 1))),
+      _mm256_cmpgt_epi8(_mm256_set1_epi8((char) (high + 1)), block));
+}
+
+AVX2_TARGET
+static inline __m256i class_mask_avx2(__m256i block, b_ascii_class type) {
+  __m256i folded = _mm256_or_si256(block, _mm256_set1_epi8(0x20));
+  switch (type) {
+    case ASCII_ALPHA: return in_range_avx2(folded, 'a', 'z');
+    case ASCII_ALNUM:
+      return _mm256_or_si256(in_range_avx2(folded, 'a', 'z'),
+                             in_range_avx2(block, '0', '9'));
+    case ASCII_DIGIT: return in_range_avx2(block, '0', '9');
+    case ASCII_LOWER: return in_range_avx2(block, 'a', 'z');
+    case ASCII_UPPER: return in_range_avx2(block, 'A', 'Z');
+    default:
+      return _mm256_or_si256(in_range_avx2(block, '\t', '\r'),
+                             _mm256_cmpeq_epi8(block, _mm256_set1_epi8(' ')));
+  }
+}
+
+AVX2_TARGET
+static int all_of_avx2(const char *s, int length, b_ascii_class type) {
+  int i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *) (s + i));
+    if ((uint32_t) _mm256_movemask_epi8(class_mask_avx2(block, type)) !=
+        UINT32_MAX)
+      return -1;
+  }
+  return i;
+}
+#endif
+
+#if HAS_SSE2
+static inline __m128i in_range_sse2(__m128i block, char low, char high) {
+  return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8((char) (low - 1))),
+                       _mm_cmplt_epi8(block, _mm_set1_epi8((char) (high + 1))));
+}
+
+static inline __m128i class_mask_sse2(__m128i block, b_ascii_class type) {
+  __m128i folded = _mm_or_si128(block, _mm_set1_epi8(0x20));
+  switch (type) {
+    case ASCII_ALPHA: return in_range_sse2(folded, 'a', 'z');
+    case ASCII_ALNUM:
+      return _mm_or_si128(in_range_sse2(folded, 'a', 'z'),
+                          in_range_sse2(block, '0', '9'));
+    case ASCII_DIGIT: return in_range_sse2(block, '0', '9');
+    case ASCII_LOWER: return in_range_sse2(block, 'a', 'z');
+    case ASCII_UPPER: return in_range_sse2(block, 'A', 'Z');
+    default:
+      return _mm_or_si128(in_range_sse2(block, '\t', '\r'),
+                          _mm_cmpeq_epi8(block, _mm_set1_epi8(' ')));
+  }
+}
+
+static int all_of_sse2(const char *s, int length, int start,
+                       b_ascii_class type) {
+  int i = start;
+  for (; i + 16 <= length; i += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *) (s + i));
+    if (_mm_movemask_epi8(class_mask_sse2(block, type)) != 0xFFFF)
+      return -1;
+  }
+  return i;
+}
+#endif
+
+bool ascii_all_of(const char *s, int length, b_ascii_class type) {
+  // the kernels return -1 as soon as a block has a byte outside the class
+  // or the position where the scalar loop should continue.
+  int i = 0;
+#if HAS_AVX2
+  if (cpu_has_avx2() && (i = all_of_avx2(s, length, type)) < 0)
+    return false;
+#endif
+#if HAS_SSE2
+  if ((i = all_of_sse2(s, length, i, type)) < 0)
+    return false;
+#endif
+
+  for (; i < length; i++) {
+    if (!ascii_in_class((unsigned char) s[i], type))
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,53 @@
+#ifndef BLADE_SIMD_H
+#define BLADE_SIMD_H
+
+#include "common.h"
+
+/**
+ * byte kernels behind the string methods.
+ *
+ * on x86 they process 16 bytes at a time with SSE2 and 32 bytes at a time
+ * with AVX2 when the cpu supports it. other targets (or builds with
+ * USE_SIMD disabled) use the scalar versions. every version treats
+ * characters the way the C locale does i.e. only ascii letters, digits
+ * and spaces belong to a class.
+ */
+
+typedef enum {
+  ASCII_ALPHA,
+  ASCII_ALNUM,
+  ASCII_DIGIT,
+  ASCII_LOWER,
+  ASCII_UPPER,
+  ASCII_SPACE,
+} b_ascii_class;
+
+/**
+ * returns a pointer to the first occurrence of needle in haystack or NULL
+ */
+const char *find_bytes(const char *haystack, int haystack_length,
+                       const char *needle, int needle_length);
+
+/**
+ * returns a pointer to the first byte of s that is one of the bytes in set
+ * or NULL if there is none
+ */
+const char *find_any_byte(const char *s, int length, const char *set,
+                          int set_length);
+
+/**
+ * writes s to destination with ascii letters converted to upper case
+ */
+void ascii_to_upper(char *destination, const char *s, int length);
+
+/**
+ * writes s to destination with ascii letters converted to lower case
+ */
+void ascii_to_lower(char *destination, const char *s, int length);
+
+/**
+ * returns true if every byte of s is in the class
+ */
+bool ascii_all_of(const char *s, int length, b_ascii_class type);
+
+#endif
@@ -0,0 +1,276 @@
+#include "snapshot.h"
+#include "memory.h"
+#include "object.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+static volatile sig_atomic_t snapshot_requested = 0;
+static char snapshot_signal_path[1024];
+
+static const char *snapshot_type(b_obj *object) {
+  switch (object->type) {
+    case OBJ_BOUND_METHOD: return "bound_method";
+    case OBJ_CLASS: return "class";
+    case OBJ_CLOSURE: return "closure";
+    case OBJ_FUNCTION: return "function";
+    case OBJ_INSTANCE: return "instance";
+    case OBJ_NATIVE: return "native";
+    case OBJ_STRING: return "string";
+    case OBJ_UP_VALUE: return "up_value";
+    case OBJ_BYTES: return "bytes";
+    case OBJ_LIST: return "list";
+    case OBJ_DICT: return "dictionary";
+    case OBJ_FILE: return "file";
+    case OBJ_ARRAY: return "array";
+    case OBJ_SET: return "set";
+    case OBJ_DEQUE: return "deque";
+    case OBJ_HEAP: return "heap";
+    case OBJ_MODULE: return "module";
+    case OBJ_SWITCH: return "switch";
+    default: return "unknown";
+  }
+}
+
+// the class name for instances and the declared name for named objects.
+static const char *snapshot_name(b_obj *object) {
+  switch (object->type) {
+    case OBJ_INSTANCE:
+      return ((b_obj_instance *) object)->klass->name->chars;
+    case OBJ_CLASS:
+      return ((b_obj_class *) object)->name->chars;
+    case OBJ_FUNCTION: {
+      b_obj_func *function = (b_obj_func *) object;
+      return function->name == NULL ? "<script>" : function->name->chars;
+    }
+    case OBJ_CLOSURE: {
+      b_obj_func *function = ((b_obj_closure *) object)->function;
+      return function->name == NULL ? "<script>" : function->name->chars;
+    }
+    case OBJ_NATIVE:
+      return ((b_obj_native *) object)->name;
+    case OBJ_MODULE:
+      return ((b_obj_module *) object)->name;
+    default:
+      return snapshot_type(object);
+  }
+}
+
+// every table slot has an entry and a control byte.
+#define TABLE_SIZE(table)                                                      \
+  ((sizeof(b_entry) + sizeof(uint8_t)) * (size_t) (table).capacity)
+
+// the shallow size of the object i.e. its header and the buffers it owns.
+static size_t snapshot_size(b_obj *object) {
+  switch (object->type) {
+    case OBJ_STRING: {
+      b_obj_string *string = (b_obj_string *) object;
+      return sizeof(b_obj_string) +
+             (string->parent == NULL ? (size_t) string->length + 1 : 0);
+    }
+    case OBJ_LIST: {
+      b_obj_list *list = (b_obj_list *) object;
+      return sizeof(b_obj_list) + sizeof(b_value) * list->items.capacity;
+    }
+    case OBJ_DICT: {
+      b_obj_dict *dict = (b_obj_dict *) object;
+      return sizeof(b_obj_dict) + sizeof(b_value) * dict->names.capacity +
+             sizeof(b_value) * dict->values.capacity + TABLE_SIZE(dict->indices);
+    }
+    case OBJ_BYTES: {
+      b_obj_bytes *bytes = (b_obj_bytes *) object;
+      return sizeof(b_obj_bytes) +
+             (bytes->parent == NULL ? (size_t) bytes->bytes.count : 0);
+    }
+    case OBJ_ARRAY: {
+      b_obj_array *array = (b_obj_array *) object;
+      return sizeof(b_obj_array) +
+             ARRAY_ELEMENT_SIZE(array->type) * (size_t) array->length;
+    }
+    case OBJ_SET:
+      return sizeof(b_obj_set) + TABLE_SIZE(((b_obj_set *) object)->items);
+    case OBJ_DEQUE:
+      return sizeof(b_obj_deque) +
+             sizeof(b_value) * ((b_obj_deque *) object)->capacity;
+    case OBJ_HEAP: {
+      b_obj_heap *heap = (b_obj_heap *) object;
+      return sizeof(b_obj_heap) +
+             sizeof(b_value) * (heap->values.capacity + heap->keys.capacity);
+    }
+    case OBJ_CLASS: {
+      b_obj_class *klass = (b_obj_class *) object;
+      return sizeof(b_obj_class) + TABLE_SIZE(klass->methods) +
+             TABLE_SIZE(klass->properties) +
+             TABLE_SIZE(klass->static_properties);
+    }
+    case OBJ_INSTANCE:
+      return sizeof(b_obj_instance) +
+             TABLE_SIZE(((b_obj_instance *) object)->properties);
+    case OBJ_FUNCTION: {
+      b_obj_func *function = (b_obj_func *) object;
+      return sizeof(b_obj_func) +
+             (sizeof(uint8_t) + sizeof(int)) * function->blob.capacity +
+             sizeof(b_value) * function->blob.constants.capacity;
+    }
+    case OBJ_CLOSURE:
+      return sizeof(b_obj_closure) + sizeof(b_obj_up_value *) *
+                                     ((b_obj_closure *) object)->up_value_count;
+    case OBJ_MODULE:
+      return sizeof(b_obj_module) +
+             TABLE_SIZE(((b_obj_module *) object)->values);
+    case OBJ_SWITCH:
+      return sizeof(b_obj_switch) +
+             TABLE_SIZE(((b_obj_switch *) object)->table);
+    case OBJ_BOUND_METHOD: return sizeof(b_obj_bound);
+    case OBJ_NATIVE: return sizeof(b_obj_native);
+    case OBJ_UP_VALUE: return sizeof(b_obj_up_value);
+    case OBJ_FILE: return sizeof(b_obj_file);
+    default: return sizeof(b_obj);
+  }
+}
+
+void record_snapshot_reference(b_vm *vm, b_obj *object) {
+  if (vm->snapshot_from == NULL) {
+    fprintf(vm->snapshot_file, "root %p\n", (void *) object);
+  } else if (object != vm->snapshot_from) {
+    fprintf(vm->snapshot_file, "edge %p %p\n", (void *) vm->snapshot_from,
+            (void *) object);
+  }
+}
+
+bool write_heap_snapshot(b_vm *vm, const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) return false;
+
+  size_t count = 0, bytes = 0;
+  for (b_obj *object = vm->objects; object != NULL; object = object->next) {
+    count++;
+    bytes += snapshot_size(object);
+  }
+
+  fprintf(file, "# blade heap snapshot\n");
+  fprintf(file, "# objects %zu bytes %zu allocated %zu\n", count, bytes,
+          vm->bytes_allocated);
+
+  for (b_obj *object = vm->objects; object != NULL; object = object->next) {
+    fprintf(file, "object %p %s %zu %s\n", (void *) object,
+            snapshot_type(object), snapshot_size(object),
+            snapshot_name(object));
+  }
+
+  // while snapshot_file is set, mark_object() reports references here
+  // instead of marking, so the gc's own tracing code drives the walk.
+  vm->snapshot_file = file;
+
+  vm->snapshot_from = NULL;
+  mark_roots(vm);
+
+  for (b_obj *object = vm->objects; object != NULL; object = object->next) {
+    vm->snapshot_from = object;
+    blacken_object(vm, object);
+  }
+
+  vm->snapshot_file = NULL;
+  vm->snapshot_from = NULL;
+
+  return fclose(file) == 0;
+}
+
+static inline uint32_t hash_pointer(const void *pointer) {
+  return (uint32_t) (((uintptr_t) pointer >> 3) * 2654435761u);
+}
+
+typedef struct {
+  const char *name;
+  size_t count;
+  size_t bytes;
+} b_heap_class;
+
+static int compare_heap_class(const void *a, const void *b) {
+  size_t x = ((const b_heap_class *) a)->bytes;
+  size_t y = ((const b_heap_class *) b)->bytes;
+  return x < y ? 1 : (x > y ? -1 : 0);
+}
+
+void print_heap_summary(b_vm *vm, FILE *out, int top) {
+  // instances of the same class share their name, so grouping
+  // by the name's address is enough.
+  int capacity = 64, used = 0;
+  b_heap_class *classes = calloc(capacity, sizeof(b_heap_class));
+  if (classes == NULL) return;
+
+  size_t total_count = 0, total_bytes = 0;
+
+  for (b_obj *object = vm->objects; object != NULL; object = object->next) {
+    const char *name = object->type == OBJ_INSTANCE
+                       ? snapshot_name(object) : snapshot_type(object);
+    size_t size = snapshot_size(object);
+    total_count++;
+    total_bytes += size;
+
+    if (used + 1 > capacity / 2) {
+      int new_capacity = capacity * 2;
+      b_heap_class *grown = calloc(new_capacity, sizeof(b_heap_class));
+      if (grown == NULL) break;
+      for (int i = 0; i < capacity; i++) {
+        if (classes[i].name == NULL) continue;
+        uint32_t index = hash_pointer(classes[i].name) & (new_capacity - 1);
+        while (grown[index].name != NULL)
+          index = (index + 1) & (new_capacity - 1);
+        grown[index] = classes[i];
+      }
+      free(classes);
+      classes = grown;
+      capacity = new_capacity;
+    }
+
+    uint32_t index = hash_pointer(name) & (capacity - 1);
+    while (classes[index].name != NULL && classes[index].name != name)
+      index = (index + 1) & (capacity - 1);
+
+    if (classes[index].name == NULL) {
+      classes[index].name = name;
+      used++;
+    }
+    classes[index].count++;
+    classes[index].bytes += size;
+  }
+
+  qsort(classes, capacity, sizeof(b_heap_class), compare_heap_class);
+
+  fprintf(out, "Heap: %zu objects, %zu bytes\n", total_count, total_bytes);
+  fprintf(out, "%12s %14s  %s\n", "count", "bytes", "class");
+  for (int i = 0; i < capacity && i < top && classes[i].name != NULL; i++) {
+    fprintf(out, "%12zu %14zu  %s\n", classes[i].count, classes[i].bytes,
+            classes[i].name);
+  }
+  fflush(out);
+
+  free(classes);
+}
+
+#ifdef SIGUSR2
+static void handle_snapshot_signal(int sig_no) {
+  (void) sig_no;
+  snapshot_requested = 1;
+}
+#endif
+
+bool watch_heap_snapshot_signal(const char *path) {
+#ifdef SIGUSR2
+  size_t length = strlen(path);
+  if (length >= sizeof(snapshot_signal_path)) return false;
+  memcpy(snapshot_signal_path, path, length + 1);
+  return signal(SIGUSR2, handle_snapshot_signal) != SIG_ERR;
+#else
+  return false;
+#endif
+}
+
+void handle_heap_snapshot_request(b_vm *vm) {
+  if (snapshot_requested) {
+    snapshot_requested = 0;
+    write_heap_snapshot(vm, snapshot_signal_path);
+  }
+}
@@ -0,0 +1,46 @@
+#ifndef BLADE_SNAPSHOT_H
+#define BLADE_SNAPSHOT_H
+
+#include "common.h"
+#include "vm.h"
+
+#include <stdio.h>
+
+/**
+ * writes every live object in the vm along with its type, size, class name
+ * and the objects it references to the file at path.
+ *
+ * the file is a plain text list of lines in one of the forms:
+ *
+ *   object <address> <type> <size> <name>
+ *   root <address>
+ *   edge <from address> <to address>
+ *
+ * which is enough to build the object graph offline for dominator and
+ * retained size analysis.
+ */
+bool write_heap_snapshot(b_vm *vm, const char *path);
+
+/**
+ * prints the top classes (or object types) on the heap by bytes
+ */
+void print_heap_summary(b_vm *vm, FILE *out, int top);
+
+/**
+ * called by mark_object() while a snapshot is being written
+ */
+void record_snapshot_reference(b_vm *vm, b_obj *object);
+
+/**
+ * requests that a heap snapshot be written to path whenever the
+ * process receives SIGUSR2. the snapshot is taken at the next
+ * garbage collection after the signal arrives.
+ */
+bool watch_heap_snapshot_signal(const char *path);
+
+/**
+ * writes a pending signal triggered snapshot if any
+ */
+void handle_heap_snapshot_request(b_vm *vm);
+
+#endif
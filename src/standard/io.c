@@ -5,6 +5,7 @@
 #endif
 
 #include "io.h"
+#include "blade_file.h"
 #include "blade_unistd.h"
 #include "util.h"
 
@@ -19,6 +20,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef _WIN32
 #include <fcntl.h>
@@ -616,6 +618,10 @@ DECLARE_MODULE_METHOD(io_tty__tcsetattr) {
 
   // make sure we have good values so that we don't freeze the tty
   for (int i = 0; i < dict->names.count; i++) {
+    // skip the keys of removed entries
+    if (IS_EMPTY(dict->names.values[i]))
+      continue;
+
     if (!IS_NUMBER(dict->names.values[i]) ||
         AS_NUMBER(dict->names.values[i]) < 0 || // c_iflag
         AS_NUMBER(dict->names.values[i]) > 5) { // ospeed
@@ -723,6 +729,54 @@ DECLARE_MODULE_METHOD(io_getc) {
   RETURN_L_STRING(result, length);
 }
 
+// the file io.stdin holds. readline() and readlines() read its lines with
+// getline() on the stdio stream, so they can be mixed with io.getc() and
+// with reading or iterating io.stdin.
+static b_obj_file *std_input = NULL;
+
+/**
+ * readline()
+ *
+ * reads the next line from standard input without its line feed
+ * @returns string or nil at the end of the input
+ */
+DECLARE_MODULE_METHOD(io_readline) {
+  ENFORCE_ARG_COUNT(readline, 0);
+
+  b_value line;
+  int status = file_read_line(vm, std_input, &line);
+  if (status < 0) {
+    RETURN_ERROR("readline() -> %s", strerror(errno));
+  } else if (status == 0) {
+    RETURN;
+  }
+  RETURN_VALUE(line);
+}
+
+/**
+ * readlines()
+ *
+ * reads every remaining line from standard input
+ * @returns list
+ */
+DECLARE_MODULE_METHOD(io_readlines) {
+  ENFORCE_ARG_COUNT(readlines, 0);
+
+  b_obj_list *list = (b_obj_list *) GC(new_list(vm));
+  b_value line;
+  int status;
+  while ((status = file_read_line(vm, std_input, &line)) > 0) {
+    push(vm, line);
+    write_list(vm, list, line);
+    pop(vm);
+  }
+
+  if (status < 0) {
+    RETURN_ERROR("readlines() -> %s", strerror(errno));
+  }
+  RETURN_OBJ(list);
+}
+
 /**
  * putc(c: char)
  * writes character c to the screen
@@ -745,9 +799,9 @@ DECLARE_MODULE_METHOD(io_putc) {
   }
 #endif
 
-  if(write(STDOUT_FILENO, string->chars, count) != -1) {
-    fflush(stdout);
-  }
+  // write out whatever echo left in the buffer first.
+  fflush(stdout);
+  write(STDOUT_FILENO, string->chars, count);
   RETURN;
 }
 
@@ -762,6 +816,7 @@ b_value io_module_stdin(b_vm *vm) {
   file->file = stdin;
   file->is_open = true;
   file->mode = copy_string(vm, "", 0);
+  std_input = file;
   return OBJ_VAL(file);
 }
 
@@ -808,6 +863,8 @@ CREATE_MODULE_LOADER(io) {
   static b_func_reg io_functions[] = {
       {"getc",   false, GET_MODULE_METHOD(io_getc)},
       {"putc",   false, GET_MODULE_METHOD(io_putc)},
+      {"readline",   false, GET_MODULE_METHOD(io_readline)},
+      {"readlines",   false, GET_MODULE_METHOD(io_readlines)},
       {"flush",   false, GET_MODULE_METHOD(io_flush)},
       {NULL,     false, NULL},
   };
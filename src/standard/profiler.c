@@ -0,0 +1,39 @@
+#include "profiler.h"
+#include "snapshot.h"
+
+DECLARE_MODULE_METHOD(profiler_snapshot) {
+  ENFORCE_ARG_COUNT(snapshot, 1);
+  ENFORCE_ARG_TYPE(snapshot, 0, IS_STRING);
+
+  if (!write_heap_snapshot(vm, AS_C_STRING(args[0]))) {
+    RETURN_ERROR("could not write heap snapshot to %s", AS_C_STRING(args[0]));
+  }
+  RETURN_TRUE;
+}
+
+DECLARE_MODULE_METHOD(profiler_summary) {
+  ENFORCE_ARG_COUNT(summary, 1);
+  ENFORCE_ARG_TYPE(summary, 0, IS_NUMBER);
+
+  print_heap_summary(vm, stdout, (int) AS_NUMBER(args[0]));
+  RETURN;
+}
+
+DECLARE_MODULE_METHOD(profiler_watch) {
+  ENFORCE_ARG_COUNT(watch, 1);
+  ENFORCE_ARG_TYPE(watch, 0, IS_STRING);
+  RETURN_BOOL(watch_heap_snapshot_signal(AS_C_STRING(args[0])));
+}
+
+CREATE_MODULE_LOADER(profiler) {
+  static b_func_reg module_functions[] = {
+      {"snapshot", false, GET_MODULE_METHOD(profiler_snapshot)},
+      {"summary",  false, GET_MODULE_METHOD(profiler_summary)},
+      {"watch",    false, GET_MODULE_METHOD(profiler_watch)},
+      {NULL,       false, NULL},
+  };
+
+  static b_module_reg module = {"_profiler", NULL, module_functions, NULL, NULL};
+
+  return module;
+}
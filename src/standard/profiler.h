@@ -0,0 +1,10 @@
+#ifndef BLADE_MODULE_PROFILER_H
+#define BLADE_MODULE_PROFILER_H
+
+#include "module.h"
+#include "native.h"
+#include "value.h"
+
+CREATE_MODULE_LOADER(profiler);
+
+#endif
@@ -0,0 +1,373 @@
+#ifdef _MSC_VER
+#pragma warning (disable : 5105)
+#endif
+
+#include "reactor.h"
+#include "blade_unistd.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "win32.h"
+#define poll WSAPoll
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#define HAS_EPOLL 1
+#else
+#define HAS_EPOLL 0
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+#endif
+
+// the events watchers ask for and wait() reports. they are the same on
+// every backend.
+#define REACTOR_READ 1
+#define REACTOR_WRITE 2
+#define REACTOR_ERROR 4
+#define REACTOR_HANGUP 8
+
+// the number of events wait() returns when it is not told.
+#define REACTOR_MAX_EVENTS 1024
+
+#if HAS_EPOLL
+static uint32_t to_epoll_events(int events) {
+  uint32_t result = 0;
+  if (events & REACTOR_READ) result |= EPOLLIN | EPOLLRDHUP;
+  if (events & REACTOR_WRITE) result |= EPOLLOUT;
+  return result;
+}
+
+static int from_epoll_events(uint32_t events) {
+  int result = 0;
+  if (events & EPOLLIN) result |= REACTOR_READ;
+  if (events & EPOLLOUT) result |= REACTOR_WRITE;
+  if (events & EPOLLERR) result |= REACTOR_ERROR;
+  if (events & (EPOLLHUP | EPOLLRDHUP)) result |= REACTOR_HANGUP;
+  return result;
+}
+#else
+static short to_poll_events(int events) {
+  short result = 0;
+  if (events & REACTOR_READ) result |= POLLIN;
+  if (events & REACTOR_WRITE) result |= POLLOUT;
+  return result;
+}
+
+static int from_poll_events(short events) {
+  int result = 0;
+  if (events & POLLIN) result |= REACTOR_READ;
+  if (events & POLLOUT) result |= REACTOR_WRITE;
+  if (events & (POLLERR | POLLNVAL)) result |= REACTOR_ERROR;
+  if (events & POLLHUP) result |= REACTOR_HANGUP;
+  return result;
+}
+#endif
+
+static bool set_blocking(int fd, bool blocking) {
+#ifdef _WIN32
+  unsigned long mode = blocking ? 0 : 1;
+  return ioctlsocket(fd, FIONBIO, &mode) == 0;
+#else
+  int flags = fcntl(fd, F_GETFL);
+  if (flags == -1) return false;
+  flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+  return fcntl(fd, F_SETFL, flags) == 0;
+#endif
+}
+
+/**
+ * create()
+ *
+ * creates a new event queue and returns its handle or -1 on failure.
+ * the poll backend keeps no kernel state and always returns 0.
+ */
+DECLARE_MODULE_METHOD(reactor__create) {
+  ENFORCE_ARG_COUNT(create, 0);
+#if HAS_EPOLL
+  RETURN_NUMBER(epoll_create1(EPOLL_CLOEXEC));
+#else
+  RETURN_NUMBER(0);
+#endif
+}
+
+/**
+ * close(handle: number)
+ *
+ * releases the event queue
+ */
+DECLARE_MODULE_METHOD(reactor__close) {
+  ENFORCE_ARG_COUNT(close, 1);
+  ENFORCE_ARG_TYPE(close, 0, IS_NUMBER);
+#if HAS_EPOLL
+  close((int) AS_NUMBER(args[0]));
+#endif
+  RETURN;
+}
+
+// adds, changes or removes the events the queue reports for fd.
+static int control(b_value *args, int operation) {
+#if HAS_EPOLL
+  struct epoll_event event = {0};
+  event.events = to_epoll_events((int) AS_NUMBER(args[2]));
+  event.data.fd = (int) AS_NUMBER(args[1]);
+  return epoll_ctl((int) AS_NUMBER(args[0]), operation, event.data.fd, &event);
+#else
+  // poll() is given every watched descriptor on each wait.
+  return 0;
+#endif
+}
+
+/**
+ * add(handle: number, fd: number, events: number)
+ *
+ * starts reporting events for fd
+ * @return 0 or -1 on failure
+ */
+DECLARE_MODULE_METHOD(reactor__add) {
+  ENFORCE_ARG_COUNT(add, 3);
+  ENFORCE_ARG_TYPE(add, 0, IS_NUMBER);
+  ENFORCE_ARG_TYPE(add, 1, IS_NUMBER);
+  ENFORCE_ARG_TYPE(add, 2, IS_NUMBER);
+  RETURN_NUMBER(control(args, EPOLL_CTL_ADD));
+}
+
+/**
+ * modify(handle: number, fd: number, events: number)
+ *
+ * changes the events reported for fd
+ * @return 0 or -1 on failure
+ */
+DECLARE_MODULE_METHOD(reactor__modify) {
+  ENFORCE_ARG_COUNT(modify, 3);
+  ENFORCE_ARG_TYPE(modify, 0, IS_NUMBER);
+  ENFORCE_ARG_TYPE(modify, 1, IS_NUMBER);
+  ENFORCE_ARG_TYPE(modify, 2, IS_NUMBER);
+  RETURN_NUMBER(control(args, EPOLL_CTL_MOD));
+}
+
+/**
+ * remove(handle: number, fd: number)
+ *
+ * stops reporting events for fd
+ * @return 0 or -1 on failure
+ */
+DECLARE_MODULE_METHOD(reactor__remove) {
+  ENFORCE_ARG_COUNT(remove, 2);
+  ENFORCE_ARG_TYPE(remove, 0, IS_NUMBER);
+  ENFORCE_ARG_TYPE(remove, 1, IS_NUMBER);
+
+  b_value control_args[3] = {args[0], args[1], NUMBER_VAL(0)};
+  RETURN_NUMBER(control(control_args, EPOLL_CTL_DEL));
+}
+
+/**
+ * wait(handle: number, watchers: dict, timeout: number [, max_events: number])
+ *
+ * waits at most timeout milliseconds (forever if negative) for watched
+ * descriptors to become ready. watchers maps every watched descriptor to
+ * its events and is only read by the poll backend.
+ * @return a flat list of ready descriptors each followed by its events
+ * i.e. [fd, events, fd, events, ...] or -1 on failure
+ */
+DECLARE_MODULE_METHOD(reactor__wait) {
+  ENFORCE_ARG_RANGE(wait, 3, 4);
+  ENFORCE_ARG_TYPE(wait, 0, IS_NUMBER);
+  ENFORCE_ARG_TYPE(wait, 1, IS_DICT);
+  ENFORCE_ARG_TYPE(wait, 2, IS_NUMBER);
+
+  int max_events = REACTOR_MAX_EVENTS;
+  if (arg_count == 4) {
+    ENFORCE_ARG_TYPE(wait, 3, IS_NUMBER);
+    max_events = (int) AS_NUMBER(args[3]);
+    if (max_events < 1) {
+      RETURN_ERROR("wait() expects max_events greater than 0");
+    }
+  }
+
+  int timeout = (int) AS_NUMBER(args[2]);
+  b_obj_list *ready = (b_obj_list *) GC(new_list(vm));
+
+#if HAS_EPOLL
+  struct epoll_event *events = ALLOCATE(struct epoll_event, max_events);
+  int count = epoll_wait((int) AS_NUMBER(args[0]), events, max_events, timeout);
+
+  for (int i = 0; i < count; i++) {
+    write_list(vm, ready, NUMBER_VAL(events[i].data.fd));
+    write_list(vm, ready, NUMBER_VAL(from_epoll_events(events[i].events)));
+  }
+  FREE_ARRAY(struct epoll_event, events, max_events);
+#else
+  b_obj_dict *watchers = AS_DICT(args[1]);
+  struct pollfd *descriptors = ALLOCATE(struct pollfd, watchers->names.count);
+
+  int watched = 0;
+  for (int i = 0; i < watchers->names.count; i++) {
+    b_value fd = watchers->names.values[i];
+    if (IS_NUMBER(fd) && IS_NUMBER(watchers->values.values[i])) {
+      descriptors[watched].fd = (int) AS_NUMBER(fd);
+      descriptors[watched].events =
+          to_poll_events((int) AS_NUMBER(watchers->values.values[i]));
+      descriptors[watched].revents = 0;
+      watched++;
+    }
+  }
+
+  int count = poll(descriptors, watched, timeout);
+  for (int i = 0, found = 0; i < watched && found < max_events && count > 0; i++) {
+    if (descriptors[i].revents != 0) {
+      write_list(vm, ready, NUMBER_VAL(descriptors[i].fd));
+      write_list(vm, ready, NUMBER_VAL(from_poll_events(descriptors[i].revents)));
+      found++;
+    }
+  }
+  FREE_ARRAY(struct pollfd, descriptors, watchers->names.count);
+#endif
+
+  // being interrupted by a signal is the same as timing out.
+  if (count == -1 && errno != EINTR) {
+    RETURN_NUMBER(-1);
+  }
+  RETURN_OBJ(ready);
+}
+
+/**
+ * accept(fd: number)
+ *
+ * accepts a connection on the non-blocking listening socket fd. the new
+ * socket is non-blocking as well.
+ * @return [fd, host, port], nil if no connection is waiting or -1 on failure
+ */
+DECLARE_MODULE_METHOD(reactor__accept) {
+  ENFORCE_ARG_COUNT(accept, 1);
+  ENFORCE_ARG_TYPE(accept, 0, IS_NUMBER);
+
+  // large enough for the address of a client of any family.
+  struct sockaddr_storage client;
+  memset(&client, 0, sizeof(client));
+  socklen_t client_length = sizeof(client);
+
+  int sock;
+  do {
+#ifdef __linux__
+    sock = accept4((int) AS_NUMBER(args[0]), (struct sockaddr *) &client,
+                   &client_length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    sock = accept((int) AS_NUMBER(args[0]), (struct sockaddr *) &client,
+                  &client_length);
+    if (sock != -1) {
+      set_blocking(sock, false);
+    }
+#endif
+  } while (sock == -1 && errno == EINTR);
+
+  if (sock == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      RETURN;
+    }
+    RETURN_NUMBER(-1);
+  }
+
+  char ip[INET6_ADDRSTRLEN] = {0};
+  int port = 0;
+  if (client.ss_family == AF_INET6) {
+    struct sockaddr_in6 *address = (struct sockaddr_in6 *) &client;
+    inet_ntop(AF_INET6, &address->sin6_addr, ip, sizeof(ip));
+    port = ntohs(address->sin6_port);
+  } else if (client.ss_family == AF_INET) {
+    struct sockaddr_in *address = (struct sockaddr_in *) &client;
+    inet_ntop(AF_INET, &address->sin_addr, ip, sizeof(ip));
+    port = ntohs(address->sin_port);
+  }
+
+  b_obj_list *response = (b_obj_list *) GC(new_list(vm));
+  write_list(vm, response, NUMBER_VAL(sock));
+  write_list(vm, response, GC_L_STRING(ip, (int) strlen(ip)));
+  write_list(vm, response, NUMBER_VAL(port));
+  RETURN_OBJ(response);
+}
+
+/**
+ * set_blocking(fd: number, blocking: bool)
+ *
+ * switches fd between blocking and non-blocking mode
+ * @return true on success
+ */
+DECLARE_MODULE_METHOD(reactor__set_blocking) {
+  ENFORCE_ARG_COUNT(set_blocking, 2);
+  ENFORCE_ARG_TYPE(set_blocking, 0, IS_NUMBER);
+  ENFORCE_ARG_TYPE(set_blocking, 1, IS_BOOL);
+  RETURN_BOOL(set_blocking((int) AS_NUMBER(args[0]), AS_BOOL(args[1])));
+}
+
+/**
+ * now()
+ *
+ * returns a monotonic time in milliseconds for scheduling timers
+ */
+DECLARE_MODULE_METHOD(reactor__now) {
+  ENFORCE_ARG_COUNT(now, 0);
+#ifdef _WIN32
+  RETURN_NUMBER((double) GetTickCount64());
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  RETURN_NUMBER((double) now.tv_sec * 1000 + (double) now.tv_nsec / 1000000);
+#endif
+}
+
+b_value reactor_module_backend(b_vm *vm) {
+#if HAS_EPOLL
+  return OBJ_VAL(copy_string(vm, "epoll", 5));
+#else
+  return OBJ_VAL(copy_string(vm, "poll", 4));
+#endif
+}
+
+b_value reactor_module_read(b_vm *vm) { return NUMBER_VAL(REACTOR_READ); }
+
+b_value reactor_module_write(b_vm *vm) { return NUMBER_VAL(REACTOR_WRITE); }
+
+b_value reactor_module_error(b_vm *vm) { return NUMBER_VAL(REACTOR_ERROR); }
+
+b_value reactor_module_hangup(b_vm *vm) { return NUMBER_VAL(REACTOR_HANGUP); }
+
+CREATE_MODULE_LOADER(reactor) {
+  static b_field_reg module_fields[] = {
+      {"backend", false, reactor_module_backend},
+      {"READ", false, reactor_module_read},
+      {"WRITE", false, reactor_module_write},
+      {"ERROR", false, reactor_module_error},
+      {"HANGUP", false, reactor_module_hangup},
+      {NULL, false, NULL},
+  };
+
+  static b_func_reg module_functions[] = {
+      {"create", false, GET_MODULE_METHOD(reactor__create)},
+      {"close", false, GET_MODULE_METHOD(reactor__close)},
+      {"add", false, GET_MODULE_METHOD(reactor__add)},
+      {"modify", false, GET_MODULE_METHOD(reactor__modify)},
+      {"remove", false, GET_MODULE_METHOD(reactor__remove)},
+      {"wait", false, GET_MODULE_METHOD(reactor__wait)},
+      {"accept", false, GET_MODULE_METHOD(reactor__accept)},
+      {"set_blocking", false, GET_MODULE_METHOD(reactor__set_blocking)},
+      {"now", false, GET_MODULE_METHOD(reactor__now)},
+      {NULL, false, NULL},
+  };
+
+  static b_module_reg module = {"_reactor", module_fields, module_functions, NULL, NULL};
+
+  return module;
+}
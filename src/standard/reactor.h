@@ -0,0 +1,10 @@
+#ifndef BLADE_MODULE_REACTOR_H
+#define BLADE_MODULE_REACTOR_H
+
+#include "module.h"
+#include "native.h"
+#include "value.h"
+
+CREATE_MODULE_LOADER(reactor);
+
+#endif
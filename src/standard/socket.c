@@ -3,6 +3,7 @@
 #endif
 
 #include "socket.h"
+#include "blade_file.h"
 #include "blade_unistd.h"
 #include "pathinfo.h"
 
@@ -15,6 +16,11 @@
 //#include <arpa/nameser.h>
 #include <netdb.h> //hostent
 #include <sys/ioctl.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+#include <sys/sendfile.h>
 #endif
 
 #include <stdlib.h>
@@ -214,6 +220,117 @@ DECLARE_MODULE_METHOD(socket__accept) {
   RETURN_OBJ(response);
 }
 
+// sends count bytes of fd from offset by reading them into a buffer.
+// stops early if the socket would block or fails after sending anything.
+static ssize_t send_file_copy(int sock, int fd, off_t offset, size_t count) {
+  char buffer[BIGSIZ];
+  size_t total = 0;
+
+  if (lseek(fd, offset, SEEK_SET) == -1) {
+    return -1;
+  }
+
+  while (total < count) {
+    size_t wanted = count - total < sizeof(buffer) ? count - total : sizeof(buffer);
+    ssize_t length = read(fd, buffer, wanted);
+    if (length == -1 && errno == EINTR) {
+      continue;
+    } else if (length <= 0) {
+      break; // the file ended before count.
+    }
+
+    ssize_t sent = 0;
+    while (sent < length) {
+      ssize_t n = send(sock, buffer + sent, length - sent, 0);
+      if (n == -1 && errno == EINTR) {
+        continue;
+      } else if (n <= 0) {
+        total += sent;
+        return total > 0 ? (ssize_t) total : -1;
+      }
+      sent += n;
+    }
+    total += length;
+  }
+  return (ssize_t) total;
+}
+
+// sends count bytes of fd from offset without copying them through user
+// space where the kernel supports it. partial sends are continued until
+// everything is sent, the file ends or the socket would block.
+// returns the number of bytes sent or -1 if nothing could be sent.
+static ssize_t send_file(int sock, int fd, off_t offset, size_t count) {
+#ifdef __linux__
+  size_t total = 0;
+  while (total < count) {
+    ssize_t sent = sendfile(sock, fd, &offset, count - total);
+    if (sent == -1 && errno == EINTR) {
+      continue;
+    } else if (sent == -1 && total == 0 && (errno == EINVAL || errno == ENOSYS)) {
+      // the descriptors do not support sendfile.
+      return send_file_copy(sock, fd, offset, count);
+    } else if (sent <= 0) {
+      return total > 0 ? (ssize_t) total : sent;
+    }
+    total += sent;
+  }
+  return (ssize_t) total;
+#else
+  return send_file_copy(sock, fd, offset, count);
+#endif
+}
+
+// sends count bytes of file from offset, or the rest of it if count is
+// negative. returns the number of bytes sent or -1 if nothing could be sent.
+static ssize_t send_file_object(int sock, b_obj_file *file, double offset,
+                                double count) {
+  // writes still waiting in the buffer of the file are part of it.
+  if (file->file != NULL && !is_std_file(file)) {
+    fflush(file->file);
+  }
+
+  // a descriptor of our own leaves the position of the file untouched.
+  int fd;
+  if (is_std_file(file)) {
+    fd = fileno(file->file);
+  } else if ((fd = open(file->path->chars, O_RDONLY)) == -1) {
+    return -1;
+  }
+
+  if (count < 0) {
+    struct stat stats;
+    if (fstat(fd, &stats) == -1) {
+      count = 0;
+    } else {
+      count = (double) stats.st_size > offset ? (double) stats.st_size - offset : 0;
+    }
+  }
+
+  ssize_t sent = count > 0 ? send_file(sock, fd, (off_t) offset, (size_t) count) : 0;
+
+  if (!is_std_file(file)) {
+    int error = errno;
+    close(fd);
+    errno = error;
+  }
+  return sent;
+}
+
+DECLARE_MODULE_METHOD(socket__sendfile) {
+  ENFORCE_ARG_COUNT(_sendfile, 4);
+  ENFORCE_ARG_TYPE(_sendfile, 0, IS_NUMBER); // the socket id
+  ENFORCE_ARG_TYPE(_sendfile, 1, IS_FILE);
+  ENFORCE_ARG_TYPE(_sendfile, 2, IS_NUMBER); // offset
+  ENFORCE_ARG_TYPE(_sendfile, 3, IS_NUMBER); // count, -1 for the rest
+
+  if (AS_NUMBER(args[2]) < 0) {
+    RETURN_ERROR("sendfile() offset cannot be negative");
+  }
+
+  RETURN_NUMBER(send_file_object((int) AS_NUMBER(args[0]), AS_FILE(args[1]),
+                                 AS_NUMBER(args[2]), AS_NUMBER(args[3])));
+}
+
 DECLARE_MODULE_METHOD(socket__send) {
   ENFORCE_ARG_COUNT(_send, 3);
   ENFORCE_ARG_TYPE(_send, 0, IS_NUMBER); // the socket id
@@ -229,9 +346,12 @@ DECLARE_MODULE_METHOD(socket__send) {
   if(IS_STRING(data)) {
     content = AS_STRING(data)->chars;
     length = AS_STRING(data)->length;
+  } else if(IS_BYTES(data)) {
+    content = (char *) AS_BYTES(data)->bytes.bytes;
+    length = AS_BYTES(data)->bytes.count;
   } else if(IS_FILE(data)) {
-    content = read_file(realpath(AS_FILE(data)->path->chars, NULL));
-    length = (int)strlen(content);
+    // the whole file is sent without reading it into memory.
+    RETURN_NUMBER(send_file_object(sock, AS_FILE(data), 0, -1));
   } else {
     content = value_to_string(vm, data);
     length = (int)strlen(content);
@@ -240,16 +360,9 @@ DECLARE_MODULE_METHOD(socket__send) {
   RETURN_NUMBER(send(sock, content, length, flags));
 }
 
-DECLARE_MODULE_METHOD(socket__recv) {
-  ENFORCE_ARG_COUNT(_recv, 3);
-  ENFORCE_ARG_TYPE(_recv, 0, IS_NUMBER); // the socket id
-  ENFORCE_ARG_TYPE(_recv, 1, IS_NUMBER); // length to read
-  ENFORCE_ARG_TYPE(_recv, 2, IS_NUMBER); // flags
-
-  int sock = AS_NUMBER(args[0]);
-  int length = AS_NUMBER(args[1]);
-  int flags = AS_NUMBER(args[2]);
-
+// returns how long to wait for data on sock i.e. SO_RCVTIMEO or 5 minutes
+// if it is not set.
+static struct timeval receive_timeout(int sock) {
   struct timeval timeout;
   int option_length = sizeof(timeout);
 
@@ -264,6 +377,84 @@ DECLARE_MODULE_METHOD(socket__recv) {
     timeout.tv_sec = 300;
     timeout.tv_usec = 0;
   }
+  return timeout;
+}
+
+// waits for sock to have data to read. sets errno to ETIMEDOUT and
+// returns false if none arrives in time.
+static bool wait_readable(int sock) {
+  struct timeval timeout = receive_timeout(sock);
+
+  fd_set read_set;
+  FD_ZERO(&read_set);
+  FD_SET(sock, &read_set);
+
+  int status = select(sock + 1, &read_set, NULL, NULL, &timeout);
+  if (status == 0) {
+    errno = ETIMEDOUT;
+  }
+  return status > 0;
+}
+
+DECLARE_MODULE_METHOD(socket__recv_into) {
+  ENFORCE_ARG_COUNT(_recv_into, 6);
+  ENFORCE_ARG_TYPE(_recv_into, 0, IS_NUMBER); // the socket id
+  ENFORCE_ARG_TYPE(_recv_into, 1, IS_BYTES); // the buffer
+  ENFORCE_ARG_TYPE(_recv_into, 2, IS_NUMBER); // offset
+  ENFORCE_ARG_TYPE(_recv_into, 3, IS_NUMBER); // length to read
+  ENFORCE_ARG_TYPE(_recv_into, 4, IS_NUMBER); // flags
+  ENFORCE_ARG_TYPE(_recv_into, 5, IS_BOOL); // wait for all of length
+
+  int sock = AS_NUMBER(args[0]);
+  b_obj_bytes *bytes = AS_BYTES(args[1]);
+  int offset = AS_NUMBER(args[2]);
+  int length = AS_NUMBER(args[3]);
+  int flags = AS_NUMBER(args[4]);
+  bool exact = AS_BOOL(args[5]);
+
+  if (offset < 0 || length < 0 || offset > bytes->bytes.count ||
+      length > bytes->bytes.count - offset) {
+    RETURN_ERROR("cannot receive %d bytes at %d into bytes of length %d",
+                 length, offset, bytes->bytes.count);
+  }
+
+  make_bytes_writable(vm, bytes, bytes->bytes.count);
+  char *buffer = (char *) bytes->bytes.bytes + offset;
+
+  int total = 0;
+  while (total < length) {
+    ssize_t received = recv(sock, buffer + total, length - total, flags);
+    if (received > 0) {
+      total += (int) received;
+      if (!exact) break;
+    } else if (received == 0) {
+      break; // the connection was closed.
+    } else if (errno == EINTR) {
+      continue;
+    } else if (exact && (errno == EAGAIN || errno == EWOULDBLOCK) &&
+               wait_readable(sock)) {
+      continue;
+    } else if (total == 0) {
+      RETURN_NUMBER(-1);
+    } else {
+      break;
+    }
+  }
+
+  RETURN_NUMBER(total);
+}
+
+DECLARE_MODULE_METHOD(socket__recv) {
+  ENFORCE_ARG_COUNT(_recv, 3);
+  ENFORCE_ARG_TYPE(_recv, 0, IS_NUMBER); // the socket id
+  ENFORCE_ARG_TYPE(_recv, 1, IS_NUMBER); // length to read
+  ENFORCE_ARG_TYPE(_recv, 2, IS_NUMBER); // flags
+
+  int sock = AS_NUMBER(args[0]);
+  int length = AS_NUMBER(args[1]);
+  int flags = AS_NUMBER(args[2]);
+
+  struct timeval timeout = receive_timeout(sock);
 
   fd_set read_set;
   FD_ZERO(&read_set);
@@ -519,7 +710,9 @@ CREATE_MODULE_LOADER(socket) {
       {"create", false, GET_MODULE_METHOD(socket__create)},
       {"connect", false, GET_MODULE_METHOD(socket__connect)},
       {"send", false, GET_MODULE_METHOD(socket__send)},
+      {"sendfile", false, GET_MODULE_METHOD(socket__sendfile)},
       {"recv", false, GET_MODULE_METHOD(socket__recv)},
+      {"recv_into", false, GET_MODULE_METHOD(socket__recv_into)},
       {"setsockopt", false, GET_MODULE_METHOD(socket__setsockopt)},
       {"getsockopt", false, GET_MODULE_METHOD(socket__getsockopt)},
       {"bind", false, GET_MODULE_METHOD(socket__bind)},
@@ -6,6 +6,8 @@
 #include "standard/io.h"
 #include "standard/math.h"
 #include "standard/os.h"
+#include "standard/profiler.h"
+#include "standard/reactor.h"
 #include "standard/socket.h"
 #include "standard/hash.h"
 
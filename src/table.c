@@ -8,54 +8,141 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) ||              \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TABLE_USE_SSE2 1
+#else
+#define TABLE_USE_SSE2 0
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define CONTROL_EMPTY ((uint8_t)0x80)
+#define CONTROL_DELETED ((uint8_t)0xfe)
+
+#define IS_FULL_CONTROL(c) (((c) & 0x80) == 0)
+#define HASH_TAG(hash) ((uint8_t)((hash) & 0x7f))
+#define HASH_GROUP(hash) ((hash) >> 7)
+
+// tables smaller than a group still get a full group of control bytes.
+// the extra bytes stay empty forever so probing needs no special case.
+// tables that were never grown have none.
+#define CONTROL_SIZE(capacity)                                                 \
+  ((capacity) == 0 ? 0                                                         \
+                   : (capacity) < TABLE_GROUP_WIDTH ? TABLE_GROUP_WIDTH        \
+                                                    : (capacity))
+#define GROUP_MASK(capacity)                                                   \
+  ((uint32_t)(((capacity) + TABLE_GROUP_WIDTH - 1) / TABLE_GROUP_WIDTH) - 1)
+
+// returns a bitmask of the slots in the group whose control byte is tag
+static inline uint32_t match_group(const uint8_t *group, uint8_t tag) {
+#if TABLE_USE_SSE2
+  __m128i control = _mm_loadu_si128((const __m128i *) group);
+  return (uint32_t) _mm_movemask_epi8(
+      _mm_cmpeq_epi8(control, _mm_set1_epi8((char) tag)));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < TABLE_GROUP_WIDTH; i++) {
+    if (group[i] == tag) mask |= 1u << i;
+  }
+  return mask;
+#endif
+}
+
+// returns a bitmask of the empty or deleted slots in the group
+static inline uint32_t match_group_free(const uint8_t *group) {
+#if TABLE_USE_SSE2
+  return (uint32_t) _mm_movemask_epi8(
+      _mm_loadu_si128((const __m128i *) group));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < TABLE_GROUP_WIDTH; i++) {
+    if (!IS_FULL_CONTROL(group[i])) mask |= 1u << i;
+  }
+  return mask;
+#endif
+}
+
+static inline int lowest_bit(uint32_t mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (int) index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
 void init_table(b_table *table) {
   table->count = 0;
   table->capacity = 0;
+  table->tombstones = 0;
+  table->control = NULL;
   table->entries = NULL;
 }
 
 void free_table(b_vm *vm, b_table *table) {
+  FREE_ARRAY(uint8_t, table->control, CONTROL_SIZE(table->capacity));
   FREE_ARRAY(b_entry, table->entries, table->capacity);
   init_table(table);
 }
 
-static b_entry *find_entry(b_entry *entries, int capacity, b_value key) {
-  uint32_t hash = hash_value(key);
+// groups are probed triangularly so that every group is visited
+// once the number of groups (always a power of two) is exhausted.
+static int find_index(b_table *table, b_value key, uint32_t hash) {
+  if (table->capacity == 0)
+    return -1;
 
+  uint8_t tag = HASH_TAG(hash);
+  uint32_t group_mask = GROUP_MASK(table->capacity);
+  uint32_t group = HASH_GROUP(hash) & group_mask;
+
+  for (uint32_t step = 1; step <= group_mask + 1; step++) {
+    const uint8_t *control = table->control + group * TABLE_GROUP_WIDTH;
+
+    // only entries whose tag matches are ever touched.
+    uint32_t matches = match_group(control, tag);
+    while (matches != 0) {
+      int index = (int) group * TABLE_GROUP_WIDTH + lowest_bit(matches);
+      if (values_equal(key, table->entries[index].key)) {
 #if defined(DEBUG_TABLE) && DEBUG_TABLE
-  printf("looking for key ");
-  print_value(key);
-  printf(" with hash %u in table...\n", hash);
+        printf("found entry for key ");
+        print_value(key);
+        printf(" with hash %u in table as ", hash);
+        print_value(table->entries[index].value);
+        printf("...\n");
 #endif
+        return index;
+      }
+      matches &= matches - 1;
+    }
 
-  uint32_t index = hash & (capacity - 1);
-  b_entry *tombstone = NULL;
+    // an empty slot ends the probe sequence
+    if (match_group(control, CONTROL_EMPTY) != 0)
+      return -1;
 
-  for (;;) {
-    b_entry *entry = &entries[index];
+    group = (group + step) & group_mask;
+  }
 
-    if (IS_EMPTY(entry->key)) {
-      if (IS_NIL(entry->value)) {
-        // empty entry
-        return tombstone != NULL ? tombstone : entry;
-      } else {
-        // we found a tombstone.
-        if (tombstone == NULL)
-          tombstone = entry;
-      }
-    } else if (values_equal(key, entry->key)) {
-#if defined(DEBUG_TABLE) && DEBUG_TABLE
-      printf("found entry for key ");
-      print_value(key);
-      printf(" with hash %u in table as ", hash);
-      print_value(entry->value);
-      printf("...\n");
-#endif
+  return -1;
+}
 
-      return entry;
-    }
+static int find_free_index(uint8_t *controls, int capacity, uint32_t hash) {
+  uint32_t group_mask = GROUP_MASK(capacity);
+  uint32_t group = HASH_GROUP(hash) & group_mask;
+
+  // ignore the padding of tables smaller than a group
+  uint32_t slots = capacity < TABLE_GROUP_WIDTH ? (1u << capacity) - 1 : ~0u;
 
-    index = (index + 1) & (capacity - 1);
+  for (uint32_t step = 1;; step++) {
+    uint32_t free_slots =
+        match_group_free(controls + group * TABLE_GROUP_WIDTH) & slots;
+    if (free_slots != 0)
+      return (int) group * TABLE_GROUP_WIDTH + lowest_bit(free_slots);
+    group = (group + step) & group_mask;
   }
 }
 
@@ -67,22 +154,18 @@ bool table_get(b_table *table, b_value key, b_value *value) {
   printf("getting entry with hash %u...\n", hash_value(key));
 #endif
 
-  b_entry *entry = find_entry(table->entries, table->capacity, key);
-
-  if (IS_EMPTY(entry->key) || IS_NIL(entry->key))
+  int index = find_index(table, key, hash_value(key));
+  if (index < 0)
     return false;
 
-#if defined(DEBUG_TABLE) && DEBUG_TABLE
-  printf("found entry for hash %u == ", hash_value(entry->key));
-  print_value(entry->value);
-  printf("\n");
-#endif
-
-  *value = entry->value;
+  *value = table->entries[index].value;
   return true;
 }
 
 static void adjust_capacity(b_vm *vm, b_table *table, int capacity) {
+  uint8_t *controls = ALLOCATE(uint8_t, CONTROL_SIZE(capacity));
+  memset(controls, CONTROL_EMPTY, CONTROL_SIZE(capacity));
+
   b_entry *entries = ALLOCATE(b_entry, capacity);
   for (int i = 0; i < capacity; i++) {
     entries[i].key = EMPTY_VAL;
@@ -90,42 +173,72 @@ static void adjust_capacity(b_vm *vm, b_table *table, int capacity) {
   }
 
   // repopulate buckets
-  table->count = 0;
   for (int i = 0; i < table->capacity; i++) {
-    b_entry *entry = &table->entries[i];
-    if (IS_EMPTY(entry->key))
+    if (!IS_FULL_CONTROL(table->control[i]))
       continue;
-    b_entry *dest = find_entry(entries, capacity, entry->key);
-    dest->key = entry->key;
-    dest->value = entry->value;
-    table->count++;
+
+    b_entry *entry = &table->entries[i];
+    uint32_t hash = hash_value(entry->key);
+    int index = find_free_index(controls, capacity, hash);
+    controls[index] = HASH_TAG(hash);
+    entries[index] = *entry;
   }
 
   // free the old entries...
+  FREE_ARRAY(uint8_t, table->control, CONTROL_SIZE(table->capacity));
   FREE_ARRAY(b_entry, table->entries, table->capacity);
 
+  table->control = controls;
   table->entries = entries;
   table->capacity = capacity;
+  table->tombstones = 0;
 }
 
 bool table_set(b_vm *vm, b_table *table, b_value key, b_value value) {
-  if (table->count + 1 > table->capacity * TABLE_MAX_LOAD) {
-    int capacity = GROW_CAPACITY(table->capacity);
+  uint32_t hash = hash_value(key);
+
+  int index = find_index(table, key, hash);
+  if (index >= 0) {
+    // overwrites existing entries.
+    table->entries[index].value = value;
+    return false;
+  }
+
+  if (table->count + table->tombstones + 1 >
+      table->capacity * TABLE_MAX_LOAD) {
+    // when tombstones make up most of the load, rehashing in place is enough.
+    int capacity = table->count + 1 > table->capacity * TABLE_MAX_LOAD / 2
+                   ? GROW_CAPACITY(table->capacity)
+                   : table->capacity;
     adjust_capacity(vm, table, capacity);
   }
 
-  b_entry *entry = find_entry(table->entries, table->capacity, key);
+  index = find_free_index(table->control, table->capacity, hash);
+  if (table->control[index] == CONTROL_DELETED)
+    table->tombstones--;
 
-  bool is_new = IS_EMPTY(entry->key);
+  table->control[index] = HASH_TAG(hash);
+  table->entries[index].key = key;
+  table->entries[index].value = value;
+  table->count++;
 
-  if (is_new && IS_NIL(entry->value))
-    table->count++;
+  return true;
+}
 
-  // overwrites existing entries.
-  entry->key = key;
-  entry->value = value;
+static void delete_index(b_table *table, int index) {
+  // a lookup stops at the first group with an empty slot, so if this
+  // group already has one, the slot can be freed outright.
+  int group = index - (index % TABLE_GROUP_WIDTH);
+  if (match_group(table->control + group, CONTROL_EMPTY) != 0) {
+    table->control[index] = CONTROL_EMPTY;
+  } else {
+    table->control[index] = CONTROL_DELETED;
+    table->tombstones++;
+  }
 
-  return is_new;
+  table->entries[index].key = EMPTY_VAL;
+  table->entries[index].value = NIL_VAL;
+  table->count--;
 }
 
 bool table_delete(b_table *table, b_value key) {
@@ -133,21 +246,18 @@ bool table_delete(b_table *table, b_value key) {
     return false;
 
   // find the entry
-  b_entry *entry = find_entry(table->entries, table->capacity, key);
-  if (IS_EMPTY(entry->key))
+  int index = find_index(table, key, hash_value(key));
+  if (index < 0)
     return false;
 
-  // place a tombstone in the entry.
-  entry->key = EMPTY_VAL;
-  entry->value = BOOL_VAL(true);
-
+  delete_index(table, index);
   return true;
 }
 
 void table_add_all(b_vm *vm, b_table *from, b_table *to) {
   for (int i = 0; i < from->capacity; i++) {
-    b_entry *entry = &from->entries[i];
-    if (!IS_EMPTY(entry->key)) {
+    if (IS_FULL_CONTROL(from->control[i])) {
+      b_entry *entry = &from->entries[i];
       table_set(vm, to, entry->key, entry->value);
     }
   }
@@ -158,28 +268,32 @@ b_obj_string *table_find_string(b_table *table, const char *chars, int length,
   if (table->count == 0)
     return NULL;
 
-  uint32_t index = hash & (table->capacity - 1);
-
-  for (;;) {
-    b_entry *entry = &table->entries[index];
-
-    if (IS_EMPTY(entry->key)) {
-      /* // stop if we find an empty non-tombstone entry
-      if (IS_NIL(entry->value)) */
-      return NULL;
+  uint8_t tag = HASH_TAG(hash);
+  uint32_t group_mask = GROUP_MASK(table->capacity);
+  uint32_t group = HASH_GROUP(hash) & group_mask;
+
+  for (uint32_t step = 1; step <= group_mask + 1; step++) {
+    const uint8_t *control = table->control + group * TABLE_GROUP_WIDTH;
+
+    uint32_t matches = match_group(control, tag);
+    while (matches != 0) {
+      int index = (int) group * TABLE_GROUP_WIDTH + lowest_bit(matches);
+      b_obj_string *string = AS_STRING(table->entries[index].key);
+      if (string->length == length && string->hash == hash &&
+          memcmp(string->chars, chars, length) == 0) {
+        // we found it
+        return string;
+      }
+      matches &= matches - 1;
     }
 
-    // if (IS_STRING(entry->key)) {
-    b_obj_string *string = AS_STRING(entry->key);
-    if (string->length == length && string->hash == hash &&
-        memcmp(string->chars, chars, length) == 0) {
-      // we found it
-      return string;
-    }
-    // }
+    if (match_group(control, CONTROL_EMPTY) != 0)
+      return NULL;
 
-    index = (index + 1) & (table->capacity - 1);
+    group = (group + step) & group_mask;
   }
+
+  return NULL;
 }
 
 b_value table_find_key(b_table *table, b_value value) {
@@ -211,13 +325,8 @@ void table_print(b_table *table) {
 
 void mark_table(b_vm *vm, b_table *table) {
   for (int i = 0; i < table->capacity; i++) {
-    b_entry *entry = &table->entries[i];
-
-#if defined(USE_NAN_BOXING) && USE_NAN_BOXING
-    if(entry && entry->key) {
-#else
-    if(entry != NULL) {
-#endif
+    if (IS_FULL_CONTROL(table->control[i])) {
+      b_entry *entry = &table->entries[i];
       mark_value(vm, entry->key);
       mark_value(vm, entry->value);
     }
@@ -227,8 +336,9 @@ void mark_table(b_vm *vm, b_table *table) {
 void table_remove_whites(b_vm *vm, b_table *table) {
   for (int i = 0; i < table->capacity; i++) {
     b_entry *entry = &table->entries[i];
-    if (IS_OBJ(entry->key) && AS_OBJ(entry->key)->mark != vm->mark_value) {
-      table_delete(table, entry->key);
+    if (IS_FULL_CONTROL(table->control[i]) && IS_OBJ(entry->key) &&
+        AS_OBJ(entry->key)->mark != vm->mark_value) {
+      delete_index(table, i);
     }
   }
-}
\ No newline at end of file
+}
@@ -9,9 +9,17 @@ typedef struct {
   b_value value;
 } b_entry;
 
+// tables are open addressed in groups of TABLE_GROUP_WIDTH slots.
+// every slot has a control byte that is either empty, deleted or
+// the low 7 bits of the hash of its key so that a whole group can be
+// matched against a key with one vector compare.
+#define TABLE_GROUP_WIDTH 16
+
 typedef struct {
   int count;
   int capacity;
+  int tombstones;
+  uint8_t *control;
   b_entry *entries;
 } b_table;
 
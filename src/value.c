@@ -1,12 +1,16 @@
 #include "value.h"
 #include "config.h"
 #include "memory.h"
+#include "number.h"
 #include "object.h"
 
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#include "blade_unistd.h"
 
 void init_value_arr(b_value_arr *array) {
   array->capacity = 0;
@@ -68,16 +72,22 @@ void free_byte_arr(b_vm *vm, b_byte_arr *array) {
   FREE_ARRAY(unsigned char, array->bytes, array->count);
 }
 
+static inline void print_number(double number) {
+  char chars[NUMBER_STRING_MAX];
+  int length = format_number(chars, number);
+  fwrite(chars, sizeof(char), length, stdout);
+}
+
 static inline void do_print_value(b_value value, bool fix_string) {
 #if defined(USE_NAN_BOXING) && USE_NAN_BOXING
   if (IS_EMPTY(value))
     printf("%s", "");
   else if (IS_NIL(value))
-    printf("nil");
+    fputs("nil", stdout);
   else if (IS_BOOL(value))
-    printf(AS_BOOL(value) ? "true" : "false");
+    fputs(AS_BOOL(value) ? "true" : "false", stdout);
   else if (IS_NUMBER(value))
-    printf(NUMBER_FORMAT, AS_NUMBER(value));
+    print_number(AS_NUMBER(value));
   else
     print_object(value, fix_string);
 #else
@@ -86,13 +96,13 @@ static inline void do_print_value(b_value value, bool fix_string) {
     printf("%s", "");
     break;
   case VAL_NIL:
-    printf("nil");
+    fputs("nil", stdout);
     break;
   case VAL_BOOL:
-    printf(AS_BOOL(value) ? "true" : "false");
+    fputs(AS_BOOL(value) ? "true" : "false", stdout);
     break;
   case VAL_NUMBER:
-    printf(NUMBER_FORMAT, AS_NUMBER(value));
+    print_number(AS_NUMBER(value));
     break;
   case VAL_OBJ:
     print_object(value, fix_string);
@@ -116,10 +126,11 @@ void echo_value(b_value value) { do_print_value(value, true); }
 #endif // !_WIN32
 
 static inline char *number_to_string(double number) {
-  int length = snprintf(NULL, 0, NUMBER_FORMAT, number);
-  char *num_str = (char *) calloc((size_t)length + 1, sizeof(char));
+  char chars[NUMBER_STRING_MAX];
+  int length = format_number(chars, number);
+  char *num_str = (char *) malloc((size_t)length + 1);
   if (num_str != NULL) {
-    sprintf(num_str, NUMBER_FORMAT, number);
+    memcpy(num_str, chars, (size_t)length + 1);
     return num_str;
   }
   return "";
@@ -173,7 +184,12 @@ bool values_equal(b_value a, b_value b) {
 #if defined(USE_NAN_BOXING) && USE_NAN_BOXING
   if (IS_NUMBER(a) && IS_NUMBER(b))
     return AS_NUMBER(a) == AS_NUMBER(b);
-  return a == b;
+  if (a == b)
+    return true;
+  // long strings are not interned, so compare them by content
+  if (IS_STRING(a) && IS_STRING(b))
+    return strings_equal(AS_STRING(a), AS_STRING(b));
+  return false;
 #else
   if (a.type != b.type)
     return false;
@@ -186,7 +202,11 @@ bool values_equal(b_value a, b_value b) {
   case VAL_NUMBER:
     return AS_NUMBER(a) == AS_NUMBER(b);
   case VAL_OBJ:
-    return AS_OBJ(a) == AS_OBJ(b);
+    if (AS_OBJ(a) == AS_OBJ(b))
+      return true;
+    if (IS_STRING(a) && IS_STRING(b))
+      return strings_equal(AS_STRING(a), AS_STRING(b));
+    return false;
 
   default:
     return false;
@@ -321,12 +341,11 @@ static uint64_t siphash24(uint64_t k0, uint64_t k1, const char *src,
   return t;
 } */
 
-#ifndef _WIN32
-inline uint32_t hash_string(const char *key, int length) {
-#else
-uint32_t hash_string(const char *key, int length) {
-#endif // !_WIN32
+#if defined(USE_FNV_HASH) && USE_FNV_HASH
+
+void seed_hash(void) {}
 
+uint32_t hash_string(const char *key, int length) {
   uint32_t hash = 2166136261u;
   const char *be = key + length;
 
@@ -335,9 +354,127 @@ uint32_t hash_string(const char *key, int length) {
   }
 
   return hash;
-  // return siphash24(127, 255, key, length);
 }
 
+#else
+
+// wyhash (final version 4) by Wang Yi.
+// see: https://github.com/wangyi-fudan/wyhash
+static const uint64_t wy_p[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+static uint64_t hash_seed = 0x2d358dccaa6c78a5ull;
+
+static inline void wy_mum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = (__uint128_t) *a * *b;
+  *a = (uint64_t) r;
+  *b = (uint64_t) (r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  *a = _umul128(*a, *b, b);
+#else
+  uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t) *a, lb = (uint32_t) *b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), c = t < rl, lo = t + (rm1 << 32);
+  c += lo < t;
+  *a = lo;
+  *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t wy_mix(uint64_t a, uint64_t b) {
+  wy_mum(&a, &b);
+  return a ^ b;
+}
+
+// only the process that computed a hash ever sees it, so reading
+// in native byte order is fine.
+static inline uint64_t wy_read8(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t wy_read4(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t wy_read3(const uint8_t *p, size_t k) {
+  return (((uint64_t) p[0]) << 16) | (((uint64_t) p[k >> 1]) << 8) | p[k - 1];
+}
+
+/**
+ * picks a new hash seed for this process so that the layout of tables
+ * cannot be predicted (and flooded with colliding keys) from outside.
+ * setting the BLADE_HASH_SEED environment variable fixes the seed
+ * for reproducible runs.
+ */
+void seed_hash(void) {
+  const char *fixed = getenv("BLADE_HASH_SEED");
+  if (fixed != NULL && *fixed != '\0') {
+    hash_seed = wy_mix(strtoull(fixed, NULL, 10) ^ wy_p[0], wy_p[1]);
+    return;
+  }
+
+  uint64_t entropy = (uint64_t) time(NULL);
+  entropy = wy_mix(entropy ^ wy_p[0], (uint64_t) clock() ^ wy_p[1]);
+  entropy = wy_mix(entropy ^ (uint64_t) getpid(), wy_p[2]);
+  // the stack and code addresses are randomized by ASLR where available
+  entropy = wy_mix(entropy ^ (uint64_t) (uintptr_t) &entropy, wy_p[3]);
+  entropy = wy_mix(entropy ^ (uint64_t) (uintptr_t) &seed_hash, wy_p[0]);
+  hash_seed = entropy;
+}
+
+uint32_t hash_string(const char *key, int length) {
+  const uint8_t *p = (const uint8_t *) key;
+  size_t len = (size_t) length;
+  uint64_t seed = hash_seed ^ wy_p[0];
+  uint64_t a, b;
+
+  if (len <= 16) {
+    if (len >= 4) {
+      a = (wy_read4(p) << 32) | wy_read4(p + ((len >> 3) << 2));
+      b = (wy_read4(p + len - 4) << 32) |
+          wy_read4(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = wy_read3(p, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = wy_mix(wy_read8(p) ^ wy_p[1], wy_read8(p + 8) ^ seed);
+        see1 = wy_mix(wy_read8(p + 16) ^ wy_p[2], wy_read8(p + 24) ^ see1);
+        see2 = wy_mix(wy_read8(p + 32) ^ wy_p[3], wy_read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = wy_mix(wy_read8(p) ^ wy_p[1], wy_read8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = wy_read8(p + i - 16);
+    b = wy_read8(p + i - 8);
+  }
+
+  a ^= wy_p[1];
+  b ^= seed;
+  wy_mum(&a, &b);
+  return (uint32_t) wy_mix(a ^ wy_p[0] ^ len, b ^ wy_p[1]);
+}
+
+#endif // USE_FNV_HASH
+
 /*#define _PADr_KAZE(x, n) ( ((x) << (n))>>(n) )
 uint32_t hash_string(const char *str, int wrdlen) {
   const uint32_t PRIME = 591798841; uint32_t hash32;
@@ -373,7 +510,7 @@ static uint32_t hash_object(b_obj *object) {
     }
 
     case OBJ_STRING:
-      return ((b_obj_string *) object)->hash;
+      return string_hash((b_obj_string *) object);
 
     default:
       return 0;
@@ -405,69 +542,381 @@ uint32_t hash_value(b_value value) {
 #endif
 }
 
+static inline int value_rank(b_value value) {
+  if (IS_NIL(value)) return 0;
+  if (IS_BOOL(value)) return 1;
+  if (IS_NUMBER(value)) return 2;
+  return 3;
+}
+
+static inline int compare_strings(b_obj_string *a, b_obj_string *b) {
+  int length = a->length < b->length ? a->length : b->length;
+  int result = memcmp(a->chars, b->chars, length);
+  if (result != 0) return result < 0 ? -1 : 1;
+  return a->length < b->length ? -1 : (a->length > b->length ? 1 : 0);
+}
+
+#define COMPARE_COUNTS(a, b) ((a) < (b) ? -1 : ((a) > (b) ? 1 : 0))
+
 /**
- * returns the greater of the two values.
- * this function encapsulates Blade's object hierarchy
+ * compares two values using Blade's object hierarchy i.e.
+ * nil < booleans < numbers < objects.
  */
-static b_value find_max_value(b_value a, b_value b) {
-  if (IS_NIL(a)) {
-    return b;
-  } else if (IS_BOOL(a)) {
-    if (IS_NIL(b) || (IS_BOOL(b) && AS_BOOL(b) == false))
-      return a; // only nil, false and false are lower than numbers
-    else
-      return b;
-  } else if (IS_NUMBER(a)) {
-    if (IS_NIL(b) || IS_BOOL(b))
-      return a;
-    else if (IS_NUMBER(b))
-      return AS_NUMBER(a) >= AS_NUMBER(b) ? a : b;
-    else
-      return b; // every other thing is greater than a number
-  } else if (IS_OBJ(a)) {
-    if (IS_STRING(a) && IS_STRING(b)) {
-      return strcmp(AS_C_STRING(a), AS_C_STRING(b)) >= 0 ? a : b;
-    } else if (IS_CLOSURE(a) && IS_CLOSURE(b)) {
-      return AS_CLOSURE(a)->function->arity >= AS_CLOSURE(b)->function->arity
-             ? a
-             : b;
-    } else if (IS_CLASS(a) && IS_CLASS(b)) {
-      return AS_CLASS(a)->methods.count >= AS_CLASS(b)->methods.count ? a : b;
-    } else if (IS_LIST(a) && IS_LIST(b)) {
-      return AS_LIST(a)->items.count >= AS_LIST(b)->items.count ? a : b;
-    } else if (IS_DICT(a) && IS_DICT(b)) {
-      return AS_DICT(a)->names.count >= AS_DICT(b)->names.count ? a : b;
-    } else if (IS_OBJ(b)) {
-      return AS_OBJ(a)->type >= AS_OBJ(b)->type ? a : b;
-    } else {
-      return a;
+int compare_values(b_value a, b_value b) {
+  int rank_a = value_rank(a), rank_b = value_rank(b);
+  if (rank_a != rank_b) return rank_a < rank_b ? -1 : 1;
+
+  switch (rank_a) {
+    case 0:
+      return 0;
+    case 1:
+      return COMPARE_COUNTS(AS_BOOL(a), AS_BOOL(b));
+    case 2:
+      return COMPARE_COUNTS(AS_NUMBER(a), AS_NUMBER(b));
+    default:
+      break;
+  }
+
+  if (IS_STRING(a) && IS_STRING(b)) {
+    return compare_strings(AS_STRING(a), AS_STRING(b));
+  } else if (IS_CLOSURE(a) && IS_CLOSURE(b)) {
+    return COMPARE_COUNTS(AS_CLOSURE(a)->function->arity,
+                          AS_CLOSURE(b)->function->arity);
+  } else if (IS_CLASS(a) && IS_CLASS(b)) {
+    return COMPARE_COUNTS(AS_CLASS(a)->methods.count,
+                          AS_CLASS(b)->methods.count);
+  } else if (IS_LIST(a) && IS_LIST(b)) {
+    return COMPARE_COUNTS(AS_LIST(a)->items.count, AS_LIST(b)->items.count);
+  } else if (IS_DICT(a) && IS_DICT(b)) {
+    return COMPARE_COUNTS(DICT_LENGTH(AS_DICT(a)), DICT_LENGTH(AS_DICT(b)));
+  }
+  return COMPARE_COUNTS(AS_OBJ(a)->type, AS_OBJ(b)->type);
+}
+
+static bool compare_any(void *context, b_value a, b_value b, int *result) {
+  (void) context;
+  *result = compare_values(a, b);
+  return true;
+}
+
+static bool compare_numbers(void *context, b_value a, b_value b, int *result) {
+  (void) context;
+  *result = COMPARE_COUNTS(AS_NUMBER(a), AS_NUMBER(b));
+  return true;
+}
+
+static bool compare_string_values(void *context, b_value a, b_value b,
+                                  int *result) {
+  (void) context;
+  *result = compare_strings(AS_STRING(a), AS_STRING(b));
+  return true;
+}
+
+#undef COMPARE_COUNTS
+
+// runs shorter than this are extended with a binary insertion sort.
+#define SORT_MIN_MERGE 32
+#define SORT_MAX_RUNS 85
+
+typedef struct {
+  b_value *values;
+  // equal to values when sorting by the values themselves.
+  b_value *keys;
+  b_value *tmp_values;
+  b_value *tmp_keys;
+  b_value_comparator compare;
+  void *context;
+  bool reverse;
+
+  int run_base[SORT_MAX_RUNS];
+  int run_length[SORT_MAX_RUNS];
+  int run_count;
+} b_sorter;
+
+static inline bool sort_less(b_sorter *sorter, b_value a, b_value b,
+                             bool *less) {
+  int result;
+  if (!sorter->compare(sorter->context, a, b, &result)) return false;
+  *less = sorter->reverse ? result > 0 : result < 0;
+  return true;
+}
+
+static inline bool has_keys(b_sorter *sorter) {
+  return sorter->keys != sorter->values;
+}
+
+static void reverse_range(b_sorter *sorter, int lo, int hi) {
+  for (hi--; lo < hi; lo++, hi--) {
+    b_value temp = sorter->values[lo];
+    sorter->values[lo] = sorter->values[hi];
+    sorter->values[hi] = temp;
+    if (has_keys(sorter)) {
+      temp = sorter->keys[lo];
+      sorter->keys[lo] = sorter->keys[hi];
+      sorter->keys[hi] = temp;
+    }
+  }
+}
+
+// returns the length of the run starting at lo, making it ascending.
+// only strictly descending runs are reversed so that sorting stays stable.
+static bool count_run(b_sorter *sorter, int lo, int hi, int *length) {
+  int run_hi = lo + 1;
+  if (run_hi == hi) {
+    *length = 1;
+    return true;
+  }
+
+  bool less;
+  if (!sort_less(sorter, sorter->keys[run_hi], sorter->keys[lo], &less))
+    return false;
+  run_hi++;
+
+  if (less) {
+    while (run_hi < hi) {
+      if (!sort_less(sorter, sorter->keys[run_hi], sorter->keys[run_hi - 1],
+                     &less))
+        return false;
+      if (!less) break;
+      run_hi++;
     }
+    reverse_range(sorter, lo, run_hi);
   } else {
-    return a;
+    while (run_hi < hi) {
+      if (!sort_less(sorter, sorter->keys[run_hi], sorter->keys[run_hi - 1],
+                     &less))
+        return false;
+      if (less) break;
+      run_hi++;
+    }
+  }
+
+  *length = run_hi - lo;
+  return true;
+}
+
+// sorts [lo, hi) given that [lo, start) is already sorted.
+static bool binary_insertion_sort(b_sorter *sorter, int lo, int hi,
+                                  int start) {
+  for (; start < hi; start++) {
+    b_value value = sorter->values[start];
+    b_value key = sorter->keys[start];
+
+    // find the first slot whose key is greater than the pivot so that
+    // equal keys keep their order.
+    int left = lo, right = start;
+    while (left < right) {
+      int mid = left + ((right - left) >> 1);
+      bool less;
+      if (!sort_less(sorter, key, sorter->keys[mid], &less)) return false;
+      if (less) {
+        right = mid;
+      } else {
+        left = mid + 1;
+      }
+    }
+
+    int n = start - left;
+    memmove(&sorter->values[left + 1], &sorter->values[left],
+            sizeof(b_value) * n);
+    sorter->values[left] = value;
+    if (has_keys(sorter)) {
+      memmove(&sorter->keys[left + 1], &sorter->keys[left],
+              sizeof(b_value) * n);
+      sorter->keys[left] = key;
+    }
+  }
+  return true;
+}
+
+static int min_run_length(int n) {
+  int r = 0;
+  while (n >= SORT_MIN_MERGE) {
+    r |= n & 1;
+    n >>= 1;
   }
+  return n + r;
+}
+
+// merges the adjacent sorted ranges [lo, mid) and [mid, hi).
+static bool merge_runs(b_sorter *sorter, int lo, int mid, int hi) {
+  bool less;
+
+  // nothing to do when the runs are already in order.
+  if (!sort_less(sorter, sorter->keys[mid], sorter->keys[mid - 1], &less))
+    return false;
+  if (!less) return true;
+
+  int left_length = mid - lo;
+  memcpy(sorter->tmp_values, &sorter->values[lo],
+         sizeof(b_value) * left_length);
+  if (has_keys(sorter)) {
+    memcpy(sorter->tmp_keys, &sorter->keys[lo], sizeof(b_value) * left_length);
+  }
+  b_value *tmp_keys = has_keys(sorter) ? sorter->tmp_keys : sorter->tmp_values;
+
+  int i = 0, j = mid, k = lo;
+  bool ok = true;
+  while (i < left_length && j < hi) {
+    if (!sort_less(sorter, sorter->keys[j], tmp_keys[i], &less)) {
+      ok = false;
+      break;
+    }
+    if (less) {
+      sorter->values[k] = sorter->values[j];
+      if (has_keys(sorter)) sorter->keys[k] = sorter->keys[j];
+      j++;
+    } else {
+      sorter->values[k] = sorter->tmp_values[i];
+      if (has_keys(sorter)) sorter->keys[k] = sorter->tmp_keys[i];
+      i++;
+    }
+    k++;
+  }
+
+  // whatever is left of the left run goes back in place even when a
+  // comparison failed so that no value is lost.
+  memcpy(&sorter->values[k], &sorter->tmp_values[i],
+         sizeof(b_value) * (left_length - i));
+  if (has_keys(sorter)) {
+    memcpy(&sorter->keys[k], &sorter->tmp_keys[i],
+           sizeof(b_value) * (left_length - i));
+  }
+  return ok;
+}
+
+static bool merge_at(b_sorter *sorter, int i) {
+  int base = sorter->run_base[i];
+  int length = sorter->run_length[i] + sorter->run_length[i + 1];
+  int mid = sorter->run_base[i + 1];
+
+  sorter->run_length[i] = length;
+  if (i == sorter->run_count - 3) {
+    sorter->run_base[i + 1] = sorter->run_base[i + 2];
+    sorter->run_length[i + 1] = sorter->run_length[i + 2];
+  }
+  sorter->run_count--;
+
+  return merge_runs(sorter, base, mid, base + length);
+}
+
+// keeps the pending run lengths decreasing faster than the fibonacci
+// sequence so that merges stay balanced.
+static bool merge_collapse(b_sorter *sorter) {
+  int *length = sorter->run_length;
+  while (sorter->run_count > 1) {
+    int n = sorter->run_count - 2;
+    if ((n > 0 && length[n - 1] <= length[n] + length[n + 1]) ||
+        (n > 1 && length[n - 2] <= length[n - 1] + length[n])) {
+      if (length[n - 1] < length[n + 1]) n--;
+    } else if (length[n] > length[n + 1]) {
+      break;
+    }
+    if (!merge_at(sorter, n)) return false;
+  }
+  return true;
+}
+
+static bool merge_force_collapse(b_sorter *sorter) {
+  int *length = sorter->run_length;
+  while (sorter->run_count > 1) {
+    int n = sorter->run_count - 2;
+    if (n > 0 && length[n - 1] < length[n + 1]) n--;
+    if (!merge_at(sorter, n)) return false;
+  }
+  return true;
+}
+
+static bool all_values_of(b_value *values, int count, bool is_number) {
+  for (int i = 0; i < count; i++) {
+    if (is_number ? !IS_NUMBER(values[i]) : !IS_STRING(values[i]))
+      return false;
+  }
+  return true;
 }
 
 /**
- * sorts values in an array using the bubble-sort algorithm
+ * sorts values in an array using a stable merge sort (TimSort without
+ * galloping). when keys is not NULL, the values are ordered by the
+ * key at the same index. when compare is NULL, Blade's default ordering
+ * is used with a fast path for arrays of only numbers or only strings.
+ *
+ * returns false if the comparator failed.
  */
-void sort_values(b_value *values, int count) {
-  int i;
-  for (i = 0; i < count; i++) {
-    int j;
-    for (j = 0; j < count; j++) {
-      if (values_equal(values[j], find_max_value(values[i], values[j]))) {
-        b_value temp = values[i];
-        values[i] = values[j];
-        values[j] = temp;
-
-        if (IS_LIST(values[i]))
-          sort_values(AS_LIST(values[i])->items.values,
-                      AS_LIST(values[i])->items.count);
-
-        if (IS_LIST(values[j]))
-          sort_values(AS_LIST(values[j])->items.values,
-                      AS_LIST(values[j])->items.count);
-      }
+bool sort_values(b_vm *vm, b_value *values, b_value *keys, int count,
+                 b_value_comparator compare, void *context, bool reverse) {
+  if (count < 2) return true;
+
+  b_sorter sorter;
+  sorter.values = values;
+  sorter.keys = keys == NULL ? values : keys;
+  sorter.compare = compare;
+  sorter.context = context;
+  sorter.reverse = reverse;
+  sorter.run_count = 0;
+
+  if (compare == NULL) {
+    if (all_values_of(sorter.keys, count, true)) {
+      sorter.compare = compare_numbers;
+    } else if (all_values_of(sorter.keys, count, false)) {
+      sorter.compare = compare_string_values;
+    } else {
+      sorter.compare = compare_any;
     }
   }
-}
\ No newline at end of file
+
+  // the merge buffer is owned by a list so that values moved into it
+  // stay visible to the gc while a comparator runs.
+  int tmp_count = keys == NULL ? count : count * 2;
+  b_obj_list *tmp = new_list(vm);
+  b_value *slot = vm->stack_top;
+  push(vm, OBJ_VAL(tmp));
+  tmp->items.values = ALLOCATE(b_value, tmp_count);
+  for (int i = 0; i < tmp_count; i++) {
+    tmp->items.values[i] = NIL_VAL;
+  }
+  tmp->items.capacity = tmp->items.count = tmp_count;
+  sorter.tmp_values = tmp->items.values;
+  sorter.tmp_keys = tmp->items.values + (keys == NULL ? 0 : count);
+
+  int min_run = min_run_length(count);
+  int lo = 0, remaining = count;
+  bool ok = true;
+
+  while (remaining > 0) {
+    int length;
+    if (!(ok = count_run(&sorter, lo, count, &length))) break;
+
+    if (length < min_run) {
+      int forced = remaining < min_run ? remaining : min_run;
+      if (!(ok = binary_insertion_sort(&sorter, lo, lo + forced,
+                                       lo + length)))
+        break;
+      length = forced;
+    }
+
+    sorter.run_base[sorter.run_count] = lo;
+    sorter.run_length[sorter.run_count] = length;
+    sorter.run_count++;
+    if (!(ok = merge_collapse(&sorter))) break;
+
+    lo += length;
+    remaining -= length;
+  }
+
+  if (ok) ok = merge_force_collapse(&sorter);
+
+  if (ok) {
+    pop(vm);
+  } else {
+    // the failed comparator left its exception on top of the buffer. keep
+    // it there for the caller to raise.
+    b_value exception = peek(vm, 0);
+    vm->stack_top = slot;
+    push(vm, exception);
+  }
+  return ok;
+}
+
+#undef SORT_MIN_MERGE
+#undef SORT_MAX_RUNS
@@ -145,11 +145,24 @@ void init_byte_arr(b_byte_arr *array, int length);
 void free_byte_arr(b_vm *vm, b_byte_arr *array);
 
 // hash
+void seed_hash(void);
+
 uint32_t hash_string(const char *key, int length);
 
 uint32_t hash_value(b_value value);
 
-void sort_values(b_value *values, int count);
+/**
+ * compares a and b storing a negative number, zero or a positive
+ * number in result when a sorts before, with or after b.
+ * returns false if the comparison could not be completed.
+ */
+typedef bool (*b_value_comparator)(void *context, b_value a, b_value b,
+                                   int *result);
+
+int compare_values(b_value a, b_value b);
+
+bool sort_values(b_vm *vm, b_value *values, b_value *keys, int count,
+                 b_value_comparator compare, void *context, bool reverse);
 
 #define STRING_VAL(val) OBJ_VAL(copy_string(vm, val, (int)strlen(val)))
 #define STRING_L_VAL(val, l) OBJ_VAL(copy_string(vm, val, l))
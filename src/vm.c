@@ -5,12 +5,18 @@
 #include "memory.h"
 #include "module.h"
 #include "native.h"
+#include "number.h"
 #include "object.h"
 
 #include "bytes.h"
+#include "blade_array.h"
+#include "blade_deque.h"
+#include "blade_heap.h"
 #include "blade_dict.h"
 #include "blade_file.h"
 #include "blade_list.h"
+#include "blade_regex.h"
+#include "blade_set.h"
 #include "blade_string.h"
 #include "util.h"
 
@@ -79,28 +85,57 @@ static b_value get_stack_trace(b_vm *vm){
   return OBJ_VAL(copy_string(vm, "", 0));
 }
 
+static void close_up_values(b_vm *vm, const b_value *last) {
+  while (vm->open_up_values != NULL && vm->open_up_values->location >= last) {
+    b_obj_up_value *up_value = vm->open_up_values;
+    up_value->closed = *up_value->location;
+    up_value->location = &up_value->closed;
+    vm->open_up_values = up_value->next;
+  }
+}
+
+// drops whatever the try block of the handler left on the stack along with
+// the handlers nested in it and puts the exception back on top.
+static void restore_handler(b_vm *vm, b_call_frame *frame, int handler,
+                            b_value exception) {
+  frame->handlers_count = handler + 1;
+  close_up_values(vm, frame->handlers[handler].stack_top);
+  vm->stack_top = frame->handlers[handler].stack_top;
+  push(vm, exception);
+}
+
 bool propagate_exception(b_vm *vm) {
   b_obj_instance *exception = AS_INSTANCE(peek(vm, 0));
 
-  while (vm->frame_count > 0) {
+  // handlers below a running native cannot be resumed from inside it.
+  while (vm->frame_count > vm->native_call_base) {
     b_call_frame *frame = &vm->frames[vm->frame_count - 1];
     for(int i = frame->handlers_count; i > 0; i--) {
       b_exception_frame handler = frame->handlers[i - 1];
       b_obj_func *function = get_frame_function(frame);
 
       if (handler.address != 0 && is_instance_of(exception->klass, handler.klass->name->chars)) {
+        restore_handler(vm, frame, i - 1, OBJ_VAL(exception));
         frame->ip = &function->blob.code[handler.address];
         return true;
       } else if (handler.finally_address != 0) {
+        restore_handler(vm, frame, i - 1, OBJ_VAL(exception));
         push(vm, TRUE_VAL); // continue propagating once the finally block completes
         frame->ip = &function->blob.code[handler.finally_address];
         return true;
       }
     }
 
+    close_up_values(vm, frame->slots);
     vm->frame_count--;
   }
 
+  // leave the exception on the stack for the native that is running so that
+  // it can be raised again once the native returns to its caller.
+  if (vm->native_call_base > 0) {
+    return false;
+  }
+
   fflush(stdout); // flush out anything on stdout first
 
   b_value message, trace;
@@ -127,6 +162,7 @@ bool push_exception_handler(b_vm *vm, b_obj_class *type, int address, int finall
   frame->handlers[frame->handlers_count].address = address;
   frame->handlers[frame->handlers_count].finally_address = finally_address;
   frame->handlers[frame->handlers_count].klass = type;
+  frame->handlers[frame->handlers_count].stack_top = vm->stack_top;
   frame->handlers_count++;
   return true;
 }
@@ -287,6 +323,12 @@ static void init_builtin_functions(b_vm *vm) {
   DEFINE_NATIVE(to_number);
   DEFINE_NATIVE(to_string);
   DEFINE_NATIVE(typeof);
+  DEFINE_NATIVE(Float64Array);
+  DEFINE_NATIVE(Int32Array);
+  DEFINE_NATIVE(UInt8Array);
+  DEFINE_NATIVE(Set);
+  DEFINE_NATIVE(Deque);
+  DEFINE_NATIVE(Heap);
 }
 
 static void init_builtin_methods(b_vm *vm) {
@@ -295,6 +337,10 @@ static void init_builtin_methods(b_vm *vm) {
 #define DEFINE_DICT_METHOD(name) DEFINE_METHOD(dict, name)
 #define DEFINE_FILE_METHOD(name) DEFINE_METHOD(file, name)
 #define DEFINE_BYTES_METHOD(name) DEFINE_METHOD(bytes, name)
+#define DEFINE_ARRAY_METHOD(name) DEFINE_METHOD(array, name)
+#define DEFINE_SET_METHOD(name) DEFINE_METHOD(set, name)
+#define DEFINE_DEQUE_METHOD(name) DEFINE_METHOD(deque, name)
+#define DEFINE_HEAP_METHOD(name) DEFINE_METHOD(heap, name)
 
   // string methods
   DEFINE_STRING_METHOD(length);
@@ -352,6 +398,12 @@ static void init_builtin_methods(b_vm *vm) {
   DEFINE_LIST_METHOD(unique);
   DEFINE_LIST_METHOD(zip);
   DEFINE_LIST_METHOD(to_dict);
+  DEFINE_LIST_METHOD(each);
+  DEFINE_LIST_METHOD(map);
+  DEFINE_LIST_METHOD(filter);
+  DEFINE_LIST_METHOD(reduce);
+  DEFINE_LIST_METHOD(any);
+  DEFINE_LIST_METHOD(all);
   define_native_method(vm, &vm->methods_list, "@iter", native_method_list__iter__);
   define_native_method(vm, &vm->methods_list, "@itern", native_method_list__itern__);
 
@@ -373,6 +425,12 @@ static void init_builtin_methods(b_vm *vm) {
   DEFINE_DICT_METHOD(find_key);
   DEFINE_DICT_METHOD(to_list);
   DEFINE_DICT_METHOD(has_attr);
+  DEFINE_DICT_METHOD(each);
+  DEFINE_DICT_METHOD(map);
+  DEFINE_DICT_METHOD(filter);
+  DEFINE_DICT_METHOD(reduce);
+  DEFINE_DICT_METHOD(any);
+  DEFINE_DICT_METHOD(all);
   define_native_method(vm, &vm->methods_dict, "@iter", native_method_dict__iter__);
   define_native_method(vm, &vm->methods_dict, "@itern", native_method_dict__itern__);
 
@@ -382,6 +440,7 @@ static void init_builtin_methods(b_vm *vm) {
   DEFINE_FILE_METHOD(open);
   DEFINE_FILE_METHOD(read);
   DEFINE_FILE_METHOD(write);
+  DEFINE_FILE_METHOD(write_all);
   DEFINE_FILE_METHOD(number);
   DEFINE_FILE_METHOD(is_tty);
   DEFINE_FILE_METHOD(is_open);
@@ -401,6 +460,12 @@ static void init_builtin_methods(b_vm *vm) {
   DEFINE_FILE_METHOD(tell);
   DEFINE_FILE_METHOD(mode);
   DEFINE_FILE_METHOD(name);
+  DEFINE_FILE_METHOD(read_line);
+  DEFINE_FILE_METHOD(lines);
+  DEFINE_FILE_METHOD(read_chunk);
+  DEFINE_FILE_METHOD(mmap);
+  define_native_method(vm, &vm->methods_file, "@iter", native_method_file__iter__);
+  define_native_method(vm, &vm->methods_file, "@itern", native_method_file__itern__);
 
   // bytes
   DEFINE_BYTES_METHOD(length);
@@ -421,18 +486,80 @@ static void init_builtin_methods(b_vm *vm) {
   DEFINE_BYTES_METHOD(is_space);
   DEFINE_BYTES_METHOD(to_list);
   DEFINE_BYTES_METHOD(to_string);
+  DEFINE_BYTES_METHOD(index_of);
   define_native_method(vm, &vm->methods_bytes, "@iter", native_method_bytes__iter__);
   define_native_method(vm, &vm->methods_bytes, "@itern", native_method_bytes__itern__);
 
+  // typed arrays
+  DEFINE_ARRAY_METHOD(length);
+  DEFINE_ARRAY_METHOD(sum);
+  DEFINE_ARRAY_METHOD(min);
+  DEFINE_ARRAY_METHOD(max);
+  DEFINE_ARRAY_METHOD(dot);
+  DEFINE_ARRAY_METHOD(scale);
+  DEFINE_ARRAY_METHOD(add);
+  DEFINE_ARRAY_METHOD(map);
+  DEFINE_ARRAY_METHOD(fill);
+  DEFINE_ARRAY_METHOD(clone);
+  DEFINE_ARRAY_METHOD(to_list);
+  define_native_method(vm, &vm->methods_array, "@iter", native_method_array__iter__);
+  define_native_method(vm, &vm->methods_array, "@itern", native_method_array__itern__);
+
+  // sets
+  DEFINE_SET_METHOD(length);
+  DEFINE_SET_METHOD(add);
+  DEFINE_SET_METHOD(extend);
+  DEFINE_SET_METHOD(remove);
+  DEFINE_SET_METHOD(contains);
+  DEFINE_SET_METHOD(clear);
+  DEFINE_SET_METHOD(clone);
+  DEFINE_SET_METHOD(union);
+  DEFINE_SET_METHOD(intersection);
+  DEFINE_SET_METHOD(difference);
+  DEFINE_SET_METHOD(is_subset);
+  DEFINE_SET_METHOD(to_list);
+  define_native_method(vm, &vm->methods_set, "@iter", native_method_set__iter__);
+  define_native_method(vm, &vm->methods_set, "@itern", native_method_set__itern__);
+
+  // deques
+  DEFINE_DEQUE_METHOD(length);
+  DEFINE_DEQUE_METHOD(push);
+  DEFINE_DEQUE_METHOD(push_front);
+  DEFINE_DEQUE_METHOD(pop);
+  DEFINE_DEQUE_METHOD(pop_front);
+  DEFINE_DEQUE_METHOD(first);
+  DEFINE_DEQUE_METHOD(last);
+  DEFINE_DEQUE_METHOD(extend);
+  DEFINE_DEQUE_METHOD(clear);
+  DEFINE_DEQUE_METHOD(clone);
+  DEFINE_DEQUE_METHOD(to_list);
+  define_native_method(vm, &vm->methods_deque, "@iter", native_method_deque__iter__);
+  define_native_method(vm, &vm->methods_deque, "@itern", native_method_deque__itern__);
+
+  // heaps
+  DEFINE_HEAP_METHOD(length);
+  DEFINE_HEAP_METHOD(push);
+  DEFINE_HEAP_METHOD(pop);
+  DEFINE_HEAP_METHOD(peek);
+  DEFINE_HEAP_METHOD(push_pop);
+  DEFINE_HEAP_METHOD(clear);
+  DEFINE_HEAP_METHOD(nsmallest);
+  DEFINE_HEAP_METHOD(nlargest);
+
 #undef DEFINE_STRING_METHOD
 #undef DEFINE_LIST_METHOD
 #undef DEFINE_DICT_METHOD
 #undef DEFINE_FILE_METHOD
 #undef DEFINE_BYTES_METHOD
+#undef DEFINE_ARRAY_METHOD
+#undef DEFINE_SET_METHOD
+#undef DEFINE_DEQUE_METHOD
+#undef DEFINE_HEAP_METHOD
 }
 
 void init_vm(b_vm *vm) {
 
+  seed_hash();
   reset_stack(vm);
   vm->compiler = NULL;
   vm->objects = NULL;
@@ -444,11 +571,16 @@ void init_vm(b_vm *vm) {
   vm->mark_value = true;
   vm->should_debug_stack = false;
   vm->should_print_bytecode = false;
+  vm->native_call_base = 0;
+  vm->regex_cache = NULL;
 
   vm->gray_count = 0;
   vm->gray_capacity = 0;
   vm->gray_stack = NULL;
 
+  vm->snapshot_file = NULL;
+  vm->snapshot_from = NULL;
+
   init_table(&vm->modules);
   init_table(&vm->strings);
   init_table(&vm->globals);
@@ -459,6 +591,10 @@ void init_vm(b_vm *vm) {
   init_table(&vm->methods_dict);
   init_table(&vm->methods_file);
   init_table(&vm->methods_bytes);
+  init_table(&vm->methods_array);
+  init_table(&vm->methods_set);
+  init_table(&vm->methods_deque);
+  init_table(&vm->methods_heap);
 
   init_builtin_functions(vm);
   init_builtin_methods(vm);
@@ -480,6 +616,12 @@ void free_vm(b_vm *vm) {
   free_table(vm, &vm->methods_dict);
   free_table(vm, &vm->methods_file);
   free_table(vm, &vm->methods_bytes);
+  free_table(vm, &vm->methods_array);
+  free_table(vm, &vm->methods_set);
+  free_table(vm, &vm->methods_deque);
+  free_table(vm, &vm->methods_heap);
+
+  free_regex_cache(vm);
 }
 
 void add_module(b_vm *vm, b_obj_module *module) {
@@ -535,6 +677,7 @@ static bool call(b_vm *vm, b_obj *callee, b_obj_func *function, int arg_count) {
   b_call_frame *frame = &vm->frames[vm->frame_count++];
   frame->function = callee;
   frame->ip = function->blob.code;
+  frame->handlers_count = 0;
 
   frame->slots = vm->stack_top - arg_count - 1;
   return true;
@@ -548,20 +691,40 @@ static inline bool call_function(b_vm *vm, b_obj_func *function, int arg_count)
   return call(vm, (b_obj *)function, function, arg_count);
 }
 
+// raises the exception on top of the stack from the frame that called the
+// native whose result slot is at slot.
+static bool raise_native_exception(b_vm *vm, b_value *slot) {
+  b_value exception = peek(vm, 0);
+  vm->gc_protected = 0;
+  vm->stack_top = slot;
+  if (!IS_INSTANCE(exception) ||
+      !is_instance_of(AS_INSTANCE(exception)->klass,
+                      vm->exception_class->name->chars)) {
+    return false;
+  }
+  push(vm, exception);
+  return propagate_exception(vm);
+}
+
 static inline bool call_native_method(b_vm *vm, b_obj_native *native, int arg_count) {
-  if(native->function(vm, arg_count, vm->stack_top - arg_count)){
+  b_value *slot = vm->stack_top - arg_count - 1;
+
+  // exceptions raised by the native are propagated when it returns.
+  int native_call_base = vm->native_call_base;
+  vm->native_call_base = vm->frame_count;
+  bool ok = native->function(vm, arg_count, slot + 1);
+  vm->native_call_base = native_call_base;
+
+  if(ok){
     CLEAR_GC();
     vm->stack_top -= arg_count;
     return true;
-  } else {
+  } else if(AS_BOOL(*slot)) {
+    // overridden
     CLEAR_GC();
-    bool overridden = AS_BOOL(vm->stack_top[-arg_count - 1]);
-    if(!overridden) {
-      vm->stack_top -= arg_count + 1;
-    }
-    return overridden;
+    return true;
   }
-  return true;
+  return raise_native_exception(vm, slot);
 }
 
 static bool call_value(b_vm *vm, b_value callee, int arg_count) {
@@ -740,6 +903,31 @@ static bool invoke(b_vm *vm, b_obj_string *name, int arg_count) {
         }
         return throw_exception(vm, "Bytes has no method %s()", name->chars);
       }
+      case OBJ_ARRAY: {
+        if(table_get(&vm->methods_array, OBJ_VAL(name), &value)) {
+          return call_native_method(vm, AS_NATIVE(value), arg_count);
+        }
+        return throw_exception(vm, "%s has no method %s()",
+                               object_type(AS_OBJ(receiver)), name->chars);
+      }
+      case OBJ_SET: {
+        if(table_get(&vm->methods_set, OBJ_VAL(name), &value)) {
+          return call_native_method(vm, AS_NATIVE(value), arg_count);
+        }
+        return throw_exception(vm, "Set has no method %s()", name->chars);
+      }
+      case OBJ_DEQUE: {
+        if(table_get(&vm->methods_deque, OBJ_VAL(name), &value)) {
+          return call_native_method(vm, AS_NATIVE(value), arg_count);
+        }
+        return throw_exception(vm, "Deque has no method %s()", name->chars);
+      }
+      case OBJ_HEAP: {
+        if(table_get(&vm->methods_heap, OBJ_VAL(name), &value)) {
+          return call_native_method(vm, AS_NATIVE(value), arg_count);
+        }
+        return throw_exception(vm, "Heap has no method %s()", name->chars);
+      }
       default: {
         return throw_exception(vm, "cannot call method %s on object of type %s",
                                name->chars, value_type(receiver));
@@ -788,15 +976,6 @@ static b_obj_up_value *capture_up_value(b_vm *vm, b_value *local) {
   return created_up_value;
 }
 
-static void close_up_values(b_vm *vm, const b_value *last) {
-  while (vm->open_up_values != NULL && vm->open_up_values->location >= last) {
-    b_obj_up_value *up_value = vm->open_up_values;
-    up_value->closed = *up_value->location;
-    up_value->location = &up_value->closed;
-    vm->open_up_values = up_value->next;
-  }
-}
-
 static void define_method(b_vm *vm, b_obj_string *name) {
   b_value method = peek(vm, 0);
   b_obj_class *klass = AS_CLASS(peek(vm, 1));
@@ -840,7 +1019,19 @@ bool is_false(b_value value) {
 
   // Non-empty dicts are true, empty dicts are false.
   if (IS_DICT(value))
-    return AS_DICT(value)->names.count == 0;
+    return DICT_LENGTH(AS_DICT(value)) == 0;
+
+  // Non-empty sets are true, empty sets are false.
+  if (IS_SET(value))
+    return AS_SET(value)->items.count == 0;
+
+  // Non-empty deques are true, empty deques are false.
+  if (IS_DEQUE(value))
+    return AS_DEQUE(value)->count == 0;
+
+  // Non-empty heaps are true, empty heaps are false.
+  if (IS_HEAP(value))
+    return AS_HEAP(value)->values.count == 0;
 
   // All classes are true
   // All closures are true
@@ -863,45 +1054,78 @@ bool is_instance_of(b_obj_class *klass1, char *klass2_name) {
 }
 
 void dict_add_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value value) {
-  write_value_arr(vm, &dict->names, key);
-  table_set(vm, &dict->items, key, value);
+  dict_set_entry(vm, dict, key, value);
 }
 
 bool dict_get_entry(b_obj_dict *dict, b_value key, b_value *value) {
-  /* // this will be easier to search than the entire tables
-  // if the key doesn't exist.
-  if (dict->names.count < (int)sizeof(uint8_t)) {
-    int i;
-    bool found = false;
-    for (i = 0; i < dict->names.count; i++) {
-      if (values_equal(dict->names.values[i], key)) {
-        found = true;
-        break;
-      }
-    }
+  b_value index;
+  if (!table_get(&dict->indices, key, &index))
+    return false;
 
-    if (!found)
-      return false;
-  } */
-  return table_get(&dict->items, key, value);
+  *value = dict->values.values[(int) AS_NUMBER(index)];
+  return true;
 }
 
 bool dict_set_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value value) {
-#if defined(USE_NAN_BOXING) && USE_NAN_BOXING
-  bool found = false;
+  b_value index;
+  if (table_get(&dict->indices, key, &index)) {
+    dict->values.values[(int) AS_NUMBER(index)] = value;
+    return false;
+  }
+
+  // add key if it doesn't exist.
+  table_set(vm, &dict->indices, key, NUMBER_VAL(dict->names.count));
+  write_value_arr(vm, &dict->names, key);
+  write_value_arr(vm, &dict->values, value);
+  return true;
+}
+
+// moves all live entries to the front of the dense arrays.
+static void compact_dict(b_vm *vm, b_obj_dict *dict) {
+  int count = 0;
   for (int i = 0; i < dict->names.count; i++) {
-    if (values_equal(dict->names.values[i], key))
-      found = true;
+    b_value key = dict->names.values[i];
+    if (IS_EMPTY(key))
+      continue;
+
+    if (i != count) {
+      dict->names.values[count] = key;
+      dict->values.values[count] = dict->values.values[i];
+      table_set(vm, &dict->indices, key, NUMBER_VAL(count));
+    }
+    count++;
   }
-  if (!found)
-    write_value_arr(vm, &dict->names, key); // add key if it doesn't exist.
-#else
-  b_value temp_value;
-  if (!table_get(&dict->items, key, &temp_value)) {
-    write_value_arr(vm, &dict->names, key); // add key if it doesn't exist.
+
+  dict->names.count = count;
+  dict->values.count = count;
+}
+
+bool dict_remove_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value *value) {
+  b_value index;
+  if (!table_get(&dict->indices, key, &index))
+    return false;
+
+  int i = (int) AS_NUMBER(index);
+  *value = dict->values.values[i];
+  table_delete(&dict->indices, key);
+
+  dict->names.values[i] = EMPTY_VAL;
+  dict->values.values[i] = NIL_VAL;
+
+  // removing from the end needs no tombstone
+  while (dict->names.count > 0 &&
+         IS_EMPTY(dict->names.values[dict->names.count - 1])) {
+    dict->names.count--;
+    dict->values.count--;
   }
-#endif
-  return table_set(vm, &dict->items, key, value);
+
+  // compact once more than half of the entries are removed ones
+  if (dict->names.count > 8 &&
+      dict->names.count > DICT_LENGTH(dict) * 2) {
+    compact_dict(vm, dict);
+  }
+
+  return true;
 }
 
 static b_obj_string *multiply_string(b_vm *vm, b_obj_string *str, double number) {
@@ -937,6 +1161,13 @@ static b_obj_list *add_list(b_vm *vm, b_obj_list *a, b_obj_list *b) {
 }
 
 static b_obj_bytes *add_bytes(b_vm *vm, b_obj_bytes *a, b_obj_bytes *b) {
+  // adding empty bytes leaves the other side unchanged so we can share it.
+  if (a->bytes.count == 0 && b->bytes.count > 0) {
+    return new_bytes_view(vm, b, 0, b->bytes.count);
+  } else if (b->bytes.count == 0 && a->bytes.count > 0) {
+    return new_bytes_view(vm, a, 0, a->bytes.count);
+  }
+
   b_obj_bytes *bytes = new_bytes(vm, a->bytes.count + b->bytes.count);
 
   memcpy(bytes->bytes.bytes, a->bytes.bytes, a->bytes.count);
@@ -993,19 +1224,22 @@ static bool string_get_index(b_vm *vm, b_obj_string *string, bool will_assign) {
     int index = AS_NUMBER(lower);
     int real_index = index;
     if (index < 0)
-      index = string->utf8_length + index;
+      index = string_utf8_length(string) + index;
+
+    if (index < string_utf8_length(string) && index >= 0) {
 
-    if (index < string->utf8_length && index >= 0) {
+      int start = string_utf8_offset(vm, string, index);
+      int end = string_utf8_offset(vm, string, index + 1);
 
-      int start = index, end = index + 1;
-      utf8slice(string->chars, &start, &end);
+      // copy before popping so that the gc cannot claim the string.
+      b_value result = STRING_L_VAL(string->chars + start, end - start);
 
       if (!will_assign) {
         // we can safely get rid of the index from the stack
         pop_n(vm, 2); // +1 for the string itself
       }
 
-      push(vm, STRING_L_VAL(string->chars + start, (int)(end - start)));
+      push(vm, result);
       return true;
     } else {
       pop_n(vm,  !will_assign? 1 : 2);
@@ -1017,33 +1251,39 @@ static bool string_get_index(b_vm *vm, b_obj_string *string, bool will_assign) {
       return throw_exception(vm, "string are numerically indexed");
     }
 
+    int length = string_utf8_length(string);
     int lower_index = AS_NUMBER(lower);
-    int upper_index = IS_NIL(upper) ? string->utf8_length : AS_NUMBER(upper);
-
-    if (lower_index < 0 ||
-        (upper_index < 0 && ((string->utf8_length + upper_index) < 0))) {
-      // always return an empty string...
-      if (!will_assign) {
-        pop_n(vm, 3); // +1 for the string itself
-      }
-      push(vm, STRING_L_VAL("", 0));
-      return true;
-    }
+    int upper_index = IS_NIL(upper) ? length : AS_NUMBER(upper);
 
     if (upper_index < 0)
-      upper_index = string->utf8_length + upper_index;
+      upper_index = length + upper_index;
 
-    if (upper_index > string->utf8_length)
-      upper_index = string->utf8_length;
+    if (upper_index > length)
+      upper_index = length;
 
-    int start = lower_index, end = upper_index;
-    utf8slice(string->chars, &start, &end);
+    b_value result;
+    if (lower_index < 0 || upper_index < 0 || lower_index >= upper_index) {
+      // always return an empty string...
+      result = STRING_L_VAL("", 0);
+    } else {
+      int start = string_utf8_offset(vm, string, lower_index);
+      int end = string_utf8_offset(vm, string, upper_index);
+
+      if (start == 0 && end == string->length) {
+        result = OBJ_VAL(string);
+      } else if (end == string->length &&
+                 end - start >= MIN_STRING_VIEW_LENGTH) {
+        result = OBJ_VAL(new_string_view(vm, string, start));
+      } else {
+        result = STRING_L_VAL(string->chars + start, end - start);
+      }
+    }
 
     if (!will_assign) {
       pop_n(vm, 3); // +1 for the string itself
     }
 
-    push(vm, STRING_L_VAL(string->chars + start, (int)(end - start)));
+    push(vm, result);
     return true;
   }
 }
@@ -1103,15 +1343,118 @@ static bool bytes_get_index(b_vm *vm, b_obj_bytes *bytes, bool will_assign) {
     if (upper_index > bytes->bytes.count)
       upper_index = bytes->bytes.count;
 
+    int length = upper_index - lower_index;
+    b_obj_bytes *slice;
+    if (length < MIN_BYTES_VIEW_LENGTH) {
+      slice = copy_bytes(vm, bytes->bytes.bytes + lower_index, length < 0 ? 0 : length);
+    } else {
+      slice = new_bytes_view(vm, bytes, lower_index, length);
+    }
+
     if (!will_assign) {
       pop_n(vm, 3); // +1 for the list itself
     }
-    push(vm, OBJ_VAL(copy_bytes(vm, bytes->bytes.bytes + lower_index,
-                                upper_index - lower_index)));
+    push(vm, OBJ_VAL(slice));
     return true;
   }
 }
 
+static bool array_get_index(b_vm *vm, b_obj_array *array, bool will_assign) {
+  b_value upper = peek(vm, 0);
+  b_value lower = peek(vm, 1);
+
+  if (IS_EMPTY(upper)) {
+    if (!IS_NUMBER(lower)) {
+      pop_n(vm, 2);
+      return throw_exception(vm, "arrays are numerically indexed");
+    }
+
+    if (!will_assign) {
+      pop(vm); // discard upper... we won't need it so gc can free it.
+    }
+    int index = AS_NUMBER(lower);
+    int real_index = index;
+    if (index < 0)
+      index = array->length + index;
+
+    if (index < array->length && index >= 0) {
+      if (!will_assign) {
+        // we can safely get rid of the index from the stack
+        pop_n(vm, 2); // +1 for the array itself
+      }
+
+      push(vm, NUMBER_VAL(array_get(array, index)));
+      return true;
+    } else {
+      pop_n(vm,  !will_assign? 1 : 2);
+      return throw_exception(vm, "array index %d out of range", real_index);
+    }
+  } else {
+    if (!IS_NUMBER(lower) || !(IS_NUMBER(upper) || IS_NIL(upper))) {
+      pop_n(vm, 2);
+      return throw_exception(vm, "arrays are numerically indexed");
+    }
+
+    int lower_index = AS_NUMBER(lower);
+    int upper_index = IS_NIL(upper) ? array->length : AS_NUMBER(upper);
+
+    if (upper_index < 0)
+      upper_index = array->length + upper_index;
+
+    if (upper_index > array->length)
+      upper_index = array->length;
+
+    if (lower_index < 0 || upper_index < lower_index) {
+      lower_index = upper_index = 0;
+    }
+
+    size_t size = ARRAY_ELEMENT_SIZE(array->type);
+    b_obj_array *slice = new_array(vm, array->type, upper_index - lower_index);
+    memcpy(slice->data, (char *)array->data + lower_index * size,
+           (upper_index - lower_index) * size);
+
+    if (!will_assign) {
+      pop_n(vm, 3); // +1 for the array itself
+    }
+    push(vm, OBJ_VAL(slice));
+    return true;
+  }
+}
+
+static bool deque_get_index(b_vm *vm, b_obj_deque *deque, bool will_assign) {
+  b_value upper = peek(vm, 0);
+  b_value lower = peek(vm, 1);
+
+  if (!IS_EMPTY(upper)) {
+    pop_n(vm, 2);
+    return throw_exception(vm, "deques cannot be sliced");
+  } else if (!IS_NUMBER(lower)) {
+    pop_n(vm, 2);
+    return throw_exception(vm, "deques are numerically indexed");
+  }
+
+  if (!will_assign) {
+    pop(vm); // discard upper... we won't need it so gc can free it.
+  }
+  int index = AS_NUMBER(lower);
+  int real_index = index;
+  if (index < 0)
+    index = deque->count + index;
+
+  if (index < deque->count && index >= 0) {
+    if (!will_assign) {
+      // we can safely get rid of the index from the stack
+      pop_n(vm, 2); // +1 for the deque itself
+    }
+
+    push(vm, DEQUE_AT(deque, index));
+    return true;
+  }
+
+  pop_n(vm, !will_assign ? 1 : 2);
+  return throw_exception(vm, "deque index %d out of range", real_index);
+}
+
 static bool list_get_index(b_vm *vm, b_obj_list *list, bool will_assign) {
   b_value upper = peek(vm, 0);
   b_value lower = peek(vm, 1);
@@ -1228,6 +1571,7 @@ static bool bytes_set_index(b_vm *vm, b_obj_bytes *bytes, b_value index, b_value
   int position = _position < 0 ? bytes->bytes.count + _position : _position;
 
   if (position < bytes->bytes.count && position > -(bytes->bytes.count)) {
+    make_bytes_writable(vm, bytes, bytes->bytes.count);
     bytes->bytes.bytes[position] = (unsigned char)byte;
     pop_n(vm, 4); // pop the value, nil, index and bytes out
 
@@ -1241,6 +1585,55 @@ static bool bytes_set_index(b_vm *vm, b_obj_bytes *bytes, b_value index, b_value
   return throw_exception(vm, "bytes index %d out of range", _position);
 }
 
+static bool array_set_index(b_vm *vm, b_obj_array *array, b_value index, b_value value) {
+  if (!IS_NUMBER(index)) {
+    pop_n(vm, 4); // pop the value, nil, index and array out
+    return throw_exception(vm, "arrays are numerically indexed");
+  } else if (!IS_NUMBER(value)) {
+    pop_n(vm, 4); // pop the value, nil, index and array out
+    return throw_exception(vm, "arrays can only hold numbers, %s given", value_type(value));
+  }
+
+  int _position = AS_NUMBER(index);
+  int position = _position < 0 ? array->length + _position : _position;
+
+  if (position < array->length && position >= 0) {
+    array_set(array, position, AS_NUMBER(value));
+    pop_n(vm, 4); // pop the value, nil, index and array out
+
+    // leave the value on the stack for consumption
+    // e.g. variable = array[index] = 10
+    push(vm, value);
+    return true;
+  }
+
+  pop_n(vm, 4); // pop the value, nil, index and array out
+  return throw_exception(vm, "array index %d out of range", _position);
+}
+
+static bool deque_set_index(b_vm *vm, b_obj_deque *deque, b_value index, b_value value) {
+  if (!IS_NUMBER(index)) {
+    pop_n(vm, 4); // pop the value, nil, index and deque out
+    return throw_exception(vm, "deques are numerically indexed");
+  }
+
+  int _position = AS_NUMBER(index);
+  int position = _position < 0 ? deque->count + _position : _position;
+
+  if (position < deque->count && position >= 0) {
+    DEQUE_AT(deque, position) = value;
+    pop_n(vm, 4); // pop the value, nil, index and deque out
+
+    // leave the value on the stack for consumption
+    // e.g. variable = deque[index] = 10
+    push(vm, value);
+    return true;
+  }
+
+  pop_n(vm, 4); // pop the value, nil, index and deque out
+  return throw_exception(vm, "deque index %d out of range", _position);
+}
+
 static bool concatenate(b_vm *vm) {
   b_value _b = peek(vm, 0);
   b_value _a = peek(vm, 1);
@@ -1253,8 +1646,8 @@ static bool concatenate(b_vm *vm) {
   } else if (IS_NUMBER(_a)) {
     double a = AS_NUMBER(_a);
 
-    char num_str[27]; // + 1 for null terminator
-    int num_length = sprintf(num_str, NUMBER_FORMAT, a);
+    char num_str[NUMBER_STRING_MAX];
+    int num_length = format_number(num_str, a);
 
     b_obj_string *b = AS_STRING(_b);
 
@@ -1265,7 +1658,8 @@ static bool concatenate(b_vm *vm) {
     chars[length] = '\0';
 
     b_obj_string *result = take_string(vm, chars, length);
-    result->utf8_length = num_length + b->utf8_length;
+    if (b->utf8_length >= 0)
+      result->utf8_length = num_length + b->utf8_length;
 
     pop_n(vm, 2);
     push(vm, OBJ_VAL(result));
@@ -1273,8 +1667,8 @@ static bool concatenate(b_vm *vm) {
     b_obj_string *a = AS_STRING(_a);
     double b = AS_NUMBER(_b);
 
-    char num_str[27]; // + 1 for null terminator
-    int num_length = sprintf(num_str, NUMBER_FORMAT, b);
+    char num_str[NUMBER_STRING_MAX];
+    int num_length = format_number(num_str, b);
 
     int length = num_length + a->length;
     char *chars = ALLOCATE(char, (size_t)length + 1);
@@ -1283,7 +1677,8 @@ static bool concatenate(b_vm *vm) {
     chars[length] = '\0';
 
     b_obj_string *result = take_string(vm, chars, length);
-    result->utf8_length = num_length + a->utf8_length;
+    if (a->utf8_length >= 0)
+      result->utf8_length = num_length + a->utf8_length;
 
     pop_n(vm, 2);
     push(vm, OBJ_VAL(result));
@@ -1298,7 +1693,8 @@ static bool concatenate(b_vm *vm) {
     chars[length] = '\0';
 
     b_obj_string *result = take_string(vm, chars, length);
-    result->utf8_length = a->utf8_length + b->utf8_length;
+    if (a->utf8_length >= 0 && b->utf8_length >= 0)
+      result->utf8_length = a->utf8_length + b->utf8_length;
 
     pop_n(vm, 2);
     push(vm, OBJ_VAL(result));
@@ -1314,7 +1710,7 @@ static int floor_div(double a, double b) {
   return d - ((d * b == a) & ((a < 0) ^ (b < 0)));
 }
 
-b_ptr_result run(b_vm *vm) {
+static b_ptr_result run(b_vm *vm, int exit_frame) {
   b_call_frame *frame = &vm->frames[vm->frame_count - 1];
 
 #define READ_BYTE() (*frame->ip++)
@@ -1376,7 +1772,7 @@ b_ptr_result run(b_vm *vm) {
     // but whose try body raises an exception)
     // can cause us to go into an invalid mode where frame count == 0
     // to fix this, we need to exit with an appropriate mode here.
-    if(vm->frame_count == 0) {
+    if(vm->frame_count <= exit_frame) {
       return PTR_RUNTIME_ERR;
     }
 
@@ -1563,12 +1959,18 @@ b_ptr_result run(b_vm *vm) {
         print_value(peek(vm, 0));
       }
       pop(vm);
-      printf("\n"); // @TODO: remove when library function print is ready
+      putchar('\n'); // @TODO: remove when library function print is ready
       break;
     }
 
     case OP_STRINGIFY: {
-      if (!IS_STRING(peek(vm, 0))) {
+      if (IS_NUMBER(peek(vm, 0))) {
+        char chars[NUMBER_STRING_MAX];
+        int length = format_number(chars, AS_NUMBER(peek(vm, 0)));
+        b_obj_string *string = copy_string(vm, chars, length);
+        pop(vm);
+        push(vm, OBJ_VAL(string));
+      } else if (!IS_STRING(peek(vm, 0))) {
         char *value = value_to_string(vm, pop(vm));
         if((int)strlen(value) != 0) {
           push(vm, OBJ_VAL(take_string(vm, value, (int) strlen(value))));
@@ -1745,7 +2147,7 @@ b_ptr_result run(b_vm *vm) {
             break;
           }
           case OBJ_DICT: {
-            if (table_get(&AS_DICT(peek(vm, 0))->items, OBJ_VAL(name), &value) ||
+            if (dict_get_entry(AS_DICT(peek(vm, 0)), OBJ_VAL(name), &value) ||
                 table_get(&vm->methods_dict, OBJ_VAL(name), &value)) {
               pop(vm); // pop the dictionary...
               push(vm, value);
@@ -1765,6 +2167,47 @@ b_ptr_result run(b_vm *vm) {
             runtime_error("class Bytes has no named property '%s'", name->chars);
             break;
           }
+          case OBJ_ARRAY: {
+            if (table_get(&vm->methods_array, OBJ_VAL(name), &value)) {
+              pop(vm); // pop the array...
+              push(vm, value);
+              break;
+            }
+
+            runtime_error("class %s has no named property '%s'",
+                          object_type(AS_OBJ(peek(vm, 0))), name->chars);
+            break;
+          }
+          case OBJ_SET: {
+            if (table_get(&vm->methods_set, OBJ_VAL(name), &value)) {
+              pop(vm); // pop the set...
+              push(vm, value);
+              break;
+            }
+
+            runtime_error("class Set has no named property '%s'", name->chars);
+            break;
+          }
+          case OBJ_DEQUE: {
+            if (table_get(&vm->methods_deque, OBJ_VAL(name), &value)) {
+              pop(vm); // pop the deque...
+              push(vm, value);
+              break;
+            }
+
+            runtime_error("class Deque has no named property '%s'", name->chars);
+            break;
+          }
+          case OBJ_HEAP: {
+            if (table_get(&vm->methods_heap, OBJ_VAL(name), &value)) {
+              pop(vm); // pop the heap...
+              push(vm, value);
+              break;
+            }
+
+            runtime_error("class Heap has no named property '%s'", name->chars);
+            break;
+          }
           case OBJ_FILE: {
             if (table_get(&vm->methods_file, OBJ_VAL(name), &value)) {
               pop(vm); // pop the list...
@@ -2059,6 +2502,18 @@ b_ptr_result run(b_vm *vm) {
             }
             break;
           }
+          case OBJ_ARRAY: {
+            if (!array_get_index(vm, AS_ARRAY(peek(vm, 2)), will_assign == (uint8_t)1)) {
+              EXIT_VM();
+            }
+            break;
+          }
+          case OBJ_DEQUE: {
+            if (!deque_get_index(vm, AS_DEQUE(peek(vm, 2)), will_assign == (uint8_t)1)) {
+              EXIT_VM();
+            }
+            break;
+          }
           default: {
             is_gotten = false;
             break;
@@ -2136,6 +2591,18 @@ b_ptr_result run(b_vm *vm) {
             }
             break;
           }
+          case OBJ_ARRAY: {
+            if (!array_set_index(vm, AS_ARRAY(peek(vm, 3)), index, value)) {
+              EXIT_VM();
+            }
+            break;
+          }
+          case OBJ_DEQUE: {
+            if (!deque_set_index(vm, AS_DEQUE(peek(vm, 3)), index, value)) {
+              EXIT_VM();
+            }
+            break;
+          }
           default: {
             is_set = false;
             break;
@@ -2194,6 +2661,10 @@ b_ptr_result run(b_vm *vm) {
       vm->stack_top = frame->slots;
       push(vm, result);
 
+      if (vm->frame_count == exit_frame) {
+        return PTR_OK;
+      }
+
       frame = &vm->frames[vm->frame_count - 1];
       break;
     }
@@ -2246,9 +2717,9 @@ b_ptr_result run(b_vm *vm) {
       b_value expression = pop(vm);
       if (is_false(expression)) {
         if (!IS_NIL(message)) {
-          throw_exception(vm, "AssertionError: %s", value_to_string(vm, message));
+          runtime_error("AssertionError: %s", value_to_string(vm, message));
         } else {
-          throw_exception(vm, "AssertionError");
+          runtime_error("AssertionError");
         }
       }
       break;
@@ -2273,11 +2744,13 @@ b_ptr_result run(b_vm *vm) {
     }
 
     case OP_TRY: {
-      b_obj_string *type = READ_STRING();
+      // try blocks without a catch have no type constant.
+      uint16_t type_index = READ_SHORT();
       uint16_t address = READ_SHORT();
       uint16_t finally_address = READ_SHORT();
 
       if(address != 0) {
+        b_obj_string *type = AS_STRING(get_frame_function(frame)->blob.constants.values[type_index]);
         b_value value;
         if(!table_get(&vm->globals, OBJ_VAL(type), &value) || !IS_CLASS(value)) {
           runtime_error("object of type '%s' is not an exception", type->chars);
@@ -2297,7 +2770,7 @@ b_ptr_result run(b_vm *vm) {
 
     case OP_PUBLISH_TRY: {
       frame->handlers_count--;
-      if(!propagate_exception(vm)) {
+      if(propagate_exception(vm)) {
         frame = &vm->frames[vm->frame_count - 1];
         break;
       }
@@ -2367,7 +2840,64 @@ b_ptr_result interpret(b_vm *vm, b_obj_module *module, const char *source) {
   push(vm, OBJ_VAL(function));
   call_function(vm, function, 0);
 
-  b_ptr_result result = run(vm);
+  b_ptr_result result = run(vm, 0);
 
   return result;
-}
\ No newline at end of file
+}
+
+int function_arity(b_value function) {
+  if (IS_CLOSURE(function)) {
+    return AS_CLOSURE(function)->function->arity;
+  } else if (IS_FUNCTION(function)) {
+    return AS_FUNCTION(function)->arity;
+  } else if (IS_BOUND(function)) {
+    b_obj *method = AS_BOUND(function)->method;
+    if (method->type == OBJ_CLOSURE) {
+      return ((b_obj_closure *) method)->function->arity;
+    } else if (method->type == OBJ_FUNCTION) {
+      return ((b_obj_func *) method)->arity;
+    }
+  }
+  return -1;
+}
+
+bool call_blade_value(b_vm *vm, b_value callee, int arg_count, b_value *args,
+                      b_value *result) {
+  int frame_count = vm->frame_count;
+  int native_call_base = vm->native_call_base;
+  vm->native_call_base = frame_count;
+
+  // objects the caller protected stay on the stack below the call but
+  // must not be released by natives called from inside it.
+  int gc_protected = vm->gc_protected;
+  vm->gc_protected = 0;
+
+  b_value *slot = vm->stack_top;
+  push(vm, callee);
+  for (int i = 0; i < arg_count; i++) {
+    push(vm, args[i]);
+  }
+
+  bool ok = call_value(vm, callee, arg_count);
+
+  // natives and classes without an initializer complete immediately.
+  if (ok && vm->frame_count > frame_count) {
+    ok = run(vm, frame_count) == PTR_OK;
+  }
+
+  vm->native_call_base = native_call_base;
+  vm->gc_protected = gc_protected;
+  if (ok) {
+    *result = pop(vm);
+    return true;
+  }
+
+  // drop whatever the failed call left on the stack but keep the exception
+  // on top of it for the native to return to the vm.
+  b_value exception = peek(vm, 0);
+  vm->frame_count = frame_count;
+  close_up_values(vm, slot);
+  vm->stack_top = slot;
+  push(vm, exception);
+  return false;
+}
@@ -2,6 +2,7 @@
 #define BLADE_VM_H
 
 typedef struct s_compiler b_compiler;
+typedef struct s_regex_cache b_regex_cache;
 
 #include "blob.h"
 #include "compiler.h"
@@ -20,6 +21,7 @@ typedef struct {
   uint16_t address;
   uint16_t finally_address;
   b_obj_class *klass;
+  b_value *stack_top;
 } b_exception_frame;
 
 typedef struct {
@@ -52,6 +54,10 @@ struct s_vm {
   size_t bytes_allocated;
   size_t next_gc;
 
+  // heap snapshots
+  FILE *snapshot_file;
+  b_obj *snapshot_from;
+
   // objects tracker
   b_table modules;
   b_table strings;
@@ -64,6 +70,10 @@ struct s_vm {
   b_table methods_dict;
   b_table methods_file;
   b_table methods_bytes;
+  b_table methods_array;
+  b_table methods_set;
+  b_table methods_deque;
+  b_table methods_heap;
 
   // boolean flags
   bool is_repl;
@@ -71,6 +81,13 @@ struct s_vm {
   // for switching through the command line args...
   bool should_debug_stack;
   bool should_print_bytecode;
+
+  // the frame count when the running native was called. exceptions raised
+  // while it runs do not unwind the frames at or below it.
+  int native_call_base;
+
+  // compiled regular expressions, created on first use.
+  b_regex_cache *regex_cache;
 };
 
 void init_vm(b_vm *vm);
@@ -89,21 +106,49 @@ bool is_false(b_value value);
 void dict_add_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value value);
 bool dict_get_entry(b_obj_dict *dict, b_value key, b_value *value);
 bool dict_set_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value value);
+bool dict_remove_entry(b_vm *vm, b_obj_dict *dict, b_value key, b_value *value);
 
 void define_native_method(b_vm *vm, b_table *table, const char *name,
                           b_native_fn function);
 bool is_instance_of(b_obj_class *klass1, char *klass2_name);
 
+/**
+ * calls a Blade function, closure, bound method, class or native from
+ * native code and runs it to completion, storing its return value in result.
+ *
+ * the call runs in a nested dispatch loop on the current vm. exception
+ * handlers inside the call work as usual but those of the functions below
+ * the native are not resumed from inside it. instead, when the call raises
+ * an exception that it does not handle, its frames are discarded, the
+ * exception is left on top of the stack and false is returned. the native
+ * must then stop and return false with args[-1] set to false so that the
+ * exception is raised again from the caller of the native. objects protected
+ * with GC() before the call remain protected.
+ */
+bool call_blade_value(b_vm *vm, b_value callee, int arg_count, b_value *args,
+                      b_value *result);
+
+/**
+ * returns the number of parameters a function, closure or bound method
+ * declares or -1 when it is unknown e.g. for natives
+ */
+int function_arity(b_value function);
+
 bool throw_exception(b_vm *vm, const char *format, ...); 
 void _runtime_error(b_vm *vm, const char *format, ...);
 b_obj_instance *create_exception(b_vm *vm, b_obj_string *message);
 
 #define EXIT_VM() return PTR_RUNTIME_ERR
 
+// the handler may belong to a calling function, so run() continues from the
+// frame that is current after the exception has been propagated.
 #define runtime_error(...)                                                     \
-  if(!throw_exception(vm, ##__VA_ARGS__)){                                     \
-    EXIT_VM(); \
-  }
+  do {                                                                         \
+    if(!throw_exception(vm, ##__VA_ARGS__)){                                   \
+      EXIT_VM();                                                               \
+    }                                                                          \
+    frame = &vm->frames[vm->frame_count - 1];                                  \
+  } while (0)
 
 
 static inline b_obj *gc_protect(b_vm *vm, b_obj *object) {
@@ -178,4 +178,37 @@ char *basename(char *path) {
   return name;
 }
 
+ssize_t getline(char **line, size_t *capacity, FILE *stream) {
+  if (*line == NULL || *capacity == 0) {
+    *capacity = 128;
+    *line = (char *)realloc(*line, *capacity);
+    if (*line == NULL) {
+      return -1;
+    }
+  }
+
+  size_t length = 0;
+  int c;
+  while ((c = fgetc(stream)) != EOF) {
+    if (length + 1 >= *capacity) {
+      char *grown = (char *)realloc(*line, *capacity * 2);
+      if (grown == NULL) {
+        return -1;
+      }
+      *line = grown;
+      *capacity *= 2;
+    }
+    (*line)[length++] = (char)c;
+    if (c == '\n') {
+      break;
+    }
+  }
+
+  if (length == 0) {
+    return -1;
+  }
+  (*line)[length] = '\0';
+  return (ssize_t)length;
+}
+
 #endif
\ No newline at end of file
@@ -15,8 +15,11 @@
 #include <windows.h>
 //--
 #include <winbase.h>
+#include <stdio.h>
 #include <time.h>
 
+#include "blade_unistd.h"
+
 /*
 //struct timeval
 //{
@@ -74,6 +77,7 @@ const char *GetWindowsVersionString();
 int uname(struct utsname *sys);
 char *dirname(char *path);
 char *basename(char *path);
+ssize_t getline(char **line, size_t *capacity, FILE *stream);
 
 //#define errno h_errno
 
@@ -0,0 +1,15 @@
+var a = Float64Array([1, 2.5, 3, -4])
+a[0] = 10
+a.scale(2).add(Float64Array([1, 1, 1, 1]))
+echo a
+echo 'sum: ${a.sum()}, min: ${a.min()}, max: ${a.max()}, dot: ${a.dot(a.map('/', a[0]))}'
+
+var b = Int32Array([3.9, -2.5])
+var u = UInt8Array([255, 256, 3])
+echo '${b} ${u} ${u.sum()}'
+
+var w = Int32Array(3)
+w[0] = 1.0e+300
+w[1] = 2 ** 32 + 5
+w[2] = -(2 ** 31) - 1
+echo '${w} ${UInt8Array([-1, 1.0e+20, 300.7])}'
@@ -12,4 +12,14 @@ c[3] = 76
 c[4] = 79
 
 echo c
-echo c.to_string()
\ No newline at end of file
+echo c.to_string()
+
+var data = []
+for i in 0..200 data.append(i)
+var frame = bytes(data)
+var payload = frame[4, 200]
+payload[0] = 99
+frame[5] = 77
+var copy = frame.clone()
+copy.append(1)
+echo 'views: ${payload[0]} ${frame[4]} ${payload[1]} ${frame[5]} ${copy.length()} ${frame.length()}'
@@ -0,0 +1,37 @@
+var d = Deque([3, 4])
+d.push(5)
+d.push_front(2)
+d.push_front(1)
+echo d
+echo d.length()
+echo d[0]
+echo d[-1]
+d[1] = 20
+d[1] += 2
+echo d.to_list()
+echo d.pop()
+echo d.pop_front()
+echo d.first()
+echo d.last()
+
+var total = 0
+for x in d {
+  total += x
+}
+echo total
+
+# keep the ring wrapped around while it grows.
+var q = Deque()
+var sum = 0
+for i in 0..1000 {
+  q.push(i)
+  if i % 3 == 0 sum += q.pop_front()
+}
+echo q.length()
+echo sum
+echo q.first()
+
+d.clear()
+echo d.pop()
+echo typeof(d)
+if !d echo 'empty'
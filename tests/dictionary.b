@@ -13,4 +13,37 @@ echo dict['age'] = 30
 
 dict['children'] += 1
 
-echo dict
\ No newline at end of file
+echo dict
+
+# grow past several groups, remove and re-add keys
+var numbers = {}
+var i = 0
+while i < 1000 {
+  numbers[i] = i * 2
+  i++
+}
+i = 0
+while i < 1000 {
+  if i % 2 == 0 numbers.remove(i)
+  i++
+}
+numbers[10] = 'back'
+echo 'numbers: ${numbers.length()} ${numbers[999]} ${numbers[10]} ${numbers.contains(4)}'
+
+var order = {a: 1, b: 2, c: 3, d: 4}
+order.remove('b')
+order['e'] = 5
+order['b'] = 6
+var seen = []
+for key, value in order {
+  seen.append('${key}=${value}')
+}
+echo 'order: ' + ','.join(seen)
+
+var stock = {apple: 3, pear: 0, fig: 7}
+var doubled = stock.map(|count| { return count * 2 })
+var available = stock.filter(|count, name| { return count > 0 })
+var total = stock.reduce(|sum, count| { return sum + count }, 0)
+var any_empty = stock.any(|count| { return count == 0 })
+var all_stocked = stock.all(|count| { return count > 0 })
+echo 'higher order: ${doubled} ${available.keys()} ${total} ${any_empty} ${all_stocked}'
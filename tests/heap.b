@@ -0,0 +1,26 @@
+var h = Heap([5, 3, 8, 1, 9, 2])
+echo h.peek()
+h.push(0)
+echo h.pop()
+echo h.pop()
+echo h.push_pop(7)
+echo h.push_pop(-1)
+echo h.length()
+echo h.nsmallest(3)
+echo h.nlargest(2)
+echo h.length()
+
+var jobs = Heap()
+jobs.push('write', 3)
+jobs.push('read', 1)
+jobs.push('sync', 2)
+var order = []
+while jobs order.append(jobs.pop())
+echo order
+
+var longest = Heap(['fig', 'banana', 'kiwi'], |a, b| { return b.length() - a.length() })
+echo longest.pop()
+echo longest.nsmallest(5)
+echo typeof(longest)
+echo Heap().pop()
+echo to_string(Heap([3, 1, 2]))
@@ -0,0 +1,20 @@
+var path = 'lines-test.txt'
+var w = file(path, 'w')
+w.write('first\nsecond\n\nfourth')
+w.close()
+
+var f = file(path)
+echo f.read_line()
+echo f.read_chunk(3)
+echo f.lines()
+echo f.read_line()
+
+for number, line in file(path) {
+  echo '${number}: ${line}'
+}
+
+var g = file(path, 'rb')
+echo g.read_line()
+echo g.read()
+
+file(path).delete()
@@ -28,4 +28,50 @@ var list2 = [
 ]
 
 echo list2[0][2]++
-echo list2
\ No newline at end of file
+echo list2
+
+var people = [['Ada', 36], ['Bob', 25], ['Cy', 36], ['Di', 25]]
+people.sort(|p| { return p[1] }, true)
+var names = []
+for p in people names.append(p[0])
+
+var numbers = [5, -2, 9, 1, 1]
+numbers.sort()
+var words = ['pear', 'fig', 'apple']
+words.sort(|a, b| { return a.length() - b.length() })
+echo 'sorted: ${names} ${numbers} ${words}'
+
+var queue = [1, 2, 3, 4, 5, 6]
+var head = queue.shift()
+var taken = queue.shift(2)
+var rest = queue.shift(10)
+echo 'shift: ${head} ${taken} ${rest} ${queue.length()}'
+
+var numbers = [1, 2, 3, 4, 5]
+var doubled = numbers.map(|x| { return x * 2 })
+var odd_places = numbers.filter(|x, i| { return i % 2 == 0 })
+var total = numbers.reduce(|sum, x| { return sum + x }, 10)
+var has_big = numbers.any(|x| { return x > 4 })
+var all_big = numbers.all(|x| { return x > 4 })
+var raised = nil
+try {
+  numbers.each(|x| {
+    if x == 3 die Exception('stopped at ${x}')
+  })
+} catch Exception e {
+  raised = e.message
+}
+echo 'higher order: ${doubled} ${odd_places} ${total} ${has_big} ${all_big} ${raised}'
+
+# comparators that fail leave the list as it was and can be retried.
+var failures = 0
+var order = [3, 1, 2]
+for i in 0..1000 {
+  try {
+    order.sort(|a, b| { return 'nope' })
+  } catch Exception e {
+    failures++
+  }
+}
+order.sort(|a, b| { return a - b })
+echo 'failed sorts: ${failures} ${order}'
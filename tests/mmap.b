@@ -0,0 +1,20 @@
+var path = 'mmap-test.txt'
+var w = file(path, 'w')
+w.write('hello mapped world')
+w.close()
+
+var data = file(path).mmap()
+echo data.length()
+echo data[6,12].to_string()
+echo data.index_of('world')
+echo data.index_of(bytes([111]), 5)
+echo data.index_of('missing')
+
+var copy = data[0,5]
+copy[0] = 72
+echo copy.to_string()
+echo file(path).read()
+file(path, 'w').truncate()
+echo file(path).mmap().length()
+
+file(path).delete()
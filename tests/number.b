@@ -0,0 +1,16 @@
+echo 0.1 + 0.2
+echo 1 / 3
+echo 2 ** 53
+echo 10 ** 21
+echo 0.0001
+echo 0.00001
+echo -0.5 * 0
+var half = 0.5
+echo 'half: ${half} ' + 10 ** -7 + ' ' + 42
+echo to_number(' 12.5e1') + to_number('0x10')
+echo '3.25'.to_number() * 2
+echo to_string(123456789.125)
+echo Float64Array([0.1, 2])
+echo 5.299064834871378e+16
+echo -371906.9040728533
+echo 7.036870839547745e+177
@@ -0,0 +1,33 @@
+import profiler
+
+class Point {
+  var x = 1
+}
+
+var points = []
+var i = 0
+while i < 100 {
+  points.append(Point())
+  i++
+}
+
+profiler.summary(5)
+
+# empty tables own no control bytes, so freeing and growing them must not
+# take any off the allocated bytes.
+class Empty {}
+i = 0
+while i < 20000 {
+  var p = Point()
+  p.y = i
+  Empty()
+  var d = {}
+  Set([1]).clear()
+  i++
+}
+
+var path = 'heap-test.txt'
+profiler.snapshot(path)
+var allocated = to_number(file(path).read().split('\n')[1].split(' ')[-1])
+file(path).delete()
+echo 'allocated: ${allocated > 0 and allocated < 100000000}'
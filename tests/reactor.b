@@ -0,0 +1,78 @@
+import reactor
+
+var r = reactor.Reactor()
+var order = []
+r.set_timeout(|| { order.append('b') }, 30)
+r.set_timeout(|| { order.append('a') }, 10)
+var cancelled = r.set_timeout(|| { order.append('never') }, 20)
+r.cancel(cancelled)
+
+var ticks = 0
+var interval
+interval = r.set_interval(|| {
+  ticks += 1
+  order.append('tick')
+  if ticks == 3 r.cancel(interval)
+}, 12)
+r.run()
+echo order
+
+echo r.poll(0)
+try {
+  r.watch('stdin', reactor.READ, |s, e| {})
+} catch Exception e {
+  echo e.message
+}
+r.close()
+
+# a loopback echo server and client driven by run_once().
+import socket
+
+def bind_loopback(server) {
+  var port = rand(40000, 60000)
+  for i in 0..50 {
+    try {
+      server.bind('127.0.0.1', port + i)
+      return port + i
+    } catch Exception e {}
+  }
+  die Exception('no free loopback port')
+}
+
+var loop = reactor.Reactor()
+var server = socket.Socket()
+var port = bind_loopback(server)
+server.listen()
+
+var peers = []
+loop.listen(server, |client| {
+  peers.append(client.host)
+  var buffer = bytes(64)
+  loop.watch(client, reactor.READ, |sock, events| {
+    var count = sock.receive_into(buffer)
+    if count > 0 sock.send(buffer[0, count])
+    loop.unwatch(sock)
+    sock.close()
+  })
+})
+
+var reply
+var client = socket.Socket()
+client.connect('127.0.0.1', port)
+client.send('ping')
+loop.watch(client, reactor.READ, |sock, events| {
+  reply = sock.receive_bytes(64).to_string()
+  loop.unwatch(sock)
+  sock.close()
+})
+
+var rounds = 0
+while reply == nil and rounds < 50 {
+  loop.run_once(100)
+  rounds++
+}
+loop.unwatch(server)
+server.close()
+echo 'loopback: ${reply} from ${peers}'
+echo loop.poll(0)
+loop.close()
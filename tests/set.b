@@ -0,0 +1,38 @@
+var a = Set([1, 2, 3, 2, 1, 'a', 'a'])
+echo a.length()
+echo a.contains(2)
+echo a.contains('b')
+echo a.add('b')
+echo a.add('b')
+echo a.remove(1)
+echo a.remove(1)
+
+var b = Set([2, 3, 4, 5])
+var u = a.union(b)
+echo u.length()
+var i = a.intersection(b)
+echo i.length()
+echo i.contains(2) and i.contains(3)
+var d = a.difference(b)
+echo d.length()
+echo d.contains('a') and d.contains('b')
+echo i.is_subset(a)
+echo a.is_subset(i)
+
+var total = 0
+for x in b {
+  total += x
+}
+echo total
+
+var seen = Set()
+var unique = 0
+for n in [5, 3, 5, 9, 3, 5] {
+  if seen.add(n) unique++
+}
+echo unique
+echo Set([7, 7])
+seen.clear()
+echo seen.length()
+echo typeof(seen)
+if !seen echo 'empty'
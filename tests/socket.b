@@ -0,0 +1,76 @@
+import socket
+import reactor
+
+def bind_loopback(server) {
+  var port = rand(40000, 60000)
+  for i in 0..50 {
+    try {
+      server.bind('127.0.0.1', port + i)
+      return port + i
+    } catch Exception e {}
+  }
+  die Exception('no free loopback port')
+}
+
+var loop = reactor.Reactor()
+var server = socket.Socket()
+var port = bind_loopback(server)
+server.listen()
+
+var peer
+loop.listen(server, |client| { peer = client })
+
+var client = socket.Socket()
+client.connect('127.0.0.1', port)
+var rounds = 0
+while peer == nil and rounds < 50 {
+  loop.run_once(100)
+  rounds++
+}
+
+var path = 'sendfile-test.txt'
+var w = file(path, 'w')
+w.write('hello, sendfile world')
+w.close()
+
+var f = file(path)
+var all = peer.send_file(f)
+var buffer = bytes(all)
+echo 'sent ${all}, received ${client.receive_exactly(buffer)}: ${buffer.to_string()}'
+
+var part = peer.send_file(f, 6, 8)
+buffer = bytes(part)
+echo 'sent ${part}, received ${client.receive_exactly(buffer)}: ${buffer.to_string()}'
+echo f.read()
+
+# two sends arrive as one exact read at an offset.
+peer.send('abc')
+peer.send('defg')
+buffer = bytes(9)
+echo client.receive_exactly(buffer, 2, 7)
+echo buffer[2, 9].to_string()
+
+try {
+  client.receive_into(bytes(4), 2, 3)
+} catch Exception e {
+  echo e.message
+}
+
+# receiving into mapped bytes copies them and leaves the file alone.
+var data = f.mmap()
+var view = data[0, 5]
+peer.send('HELLO')
+client.receive_exactly(view)
+echo view.to_string()
+peer.send('J')
+client.receive_exactly(data, 0, 1)
+echo data[0, 5].to_string()
+echo file(path).read()
+file(path).delete()
+
+peer.close()
+echo client.receive_bytes(16)
+client.close()
+loop.unwatch(server)
+server.close()
+loop.close()
@@ -0,0 +1,10 @@
+import io
+
+# stdin is given 'a\nbcd\nef\ngh\nij\nkl' by the test.
+echo io.readline()
+echo io.getc()
+echo io.stdin.read()
+echo io.readline()
+echo io.stdin.read_chunk(2)
+echo io.stdin.read_line()
+echo io.readlines()
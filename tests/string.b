@@ -6,4 +6,41 @@ var message = '"I am great"'
 
 echo 'Simon says ${message}'
 
-echo '${message} at ${5 * 5}, This is ${"john's ${'last'.upper()} ${20}"} cent'
\ No newline at end of file
+echo '${message} at ${5 * 5}, This is ${"john's ${'last'.upper()} ${20}"} cent'
+
+# long strings are not interned but must still compare by content
+var long_a = '', long_b = ''
+var i = 0
+while i < 50 {
+  long_a += 'ab'
+  long_b += 'ab'
+  i++
+}
+var cache = {}
+cache[long_a] = 'long key found'
+echo '${long_a == long_b} ${long_b.length()} ${cache[long_b]}'
+
+# indexing and slicing non-ascii strings, including suffix views
+var text = ''
+i = 0
+while i < 100 {
+  text += 'aé€'
+  i++
+}
+var tail = text[150,]
+var middle = text[148,151]
+var first = text[0] + text[1] + text[2]
+var same = tail == text[150,300]
+var upper_first = tail.upper()[0]
+var word = '  quiet  '
+var loud = word.upper().trim()
+echo '${word.length()} ${loud} ${text.length()} ${first} ${text[-2]} ${middle} ${tail.length()} ${same} ${upper_first} ${text[151].length()}'
+
+# compiled patterns are cached, so repeated matches must stay independent
+var requests = ['GET /a', 'POST /bc']
+var verbs = []
+for request in requests {
+  var groups = request.match('/(?<verb>[A-Z]+) (?<path>\S+)/')[0]
+  verbs.append(groups[-1]['verb'] + groups[-1]['path'])
+}
+echo 'regex: ${verbs} ${"a1b22".matches("/\d+/")} ${"a1b22".replace("/\d+/", "#")}'
@@ -0,0 +1,8 @@
+import io
+
+# removed keys of the attributes are not validated. stdout is not a terminal
+# when tests run so setting its attributes fails quietly.
+var attrs = {removed: 1, 0: 0}
+attrs.remove('removed')
+io.TTY(io.stdout).set_attr(io.TTY.TCSANOW, attrs)
+echo 'attributes checked'
@@ -0,0 +1,27 @@
+var path = 'write-test.txt'
+
+var f = file(path, 'w', 8)
+for i in 0..5 {
+  f.write('${i}')
+}
+f.write_all([' and ', 'a batch', ' larger than the buffer'])
+f.write_all([])
+f.flush()
+echo file(path).read()
+
+f.write_all(['!'])
+f.close()
+echo file(path).read()
+
+var b = file(path, 'wb')
+b.write_all([bytes([104, 105]), bytes([33])])
+b.close()
+echo file(path).read()
+
+try {
+  file(path, 'w').write_all(['ok', 1])
+} catch Exception e {
+  echo e.message
+}
+
+file(path).delete()